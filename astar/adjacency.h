@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace astar
+{
+    // CSR(compressed sparse row) 형식의 인접 리스트.
+    // row의 간선은 [offsets[row], offsets[row + 1]) 구간에 연속으로 놓인다.
+    struct CsrAdjacency
+    {
+        // edges[i]는 i번째 간선이 Build에 넘긴 원래 간선 목록의 몇 번째였는지를 가리킨다.
+        void Build(size_t rowCount, const std::vector<uint32_t>& sources, const std::vector<uint32_t>& destinations)
+        {
+            const size_t edgeCount = sources.size();
+            offsets.assign(rowCount + 1, 0);
+            for (auto src : sources)
+            {
+                offsets[static_cast<size_t>(src) + 1] += 1;
+            }
+
+            for (size_t i = 0; i < rowCount; ++i)
+            {
+                offsets[i + 1] += offsets[i];
+            }
+
+            targets.resize(edgeCount);
+            edges.resize(edgeCount);
+            weights.assign(edgeCount, 0.f);
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < edgeCount; ++i)
+            {
+                uint32_t pos = cursor[sources[i]]++;
+                targets[pos] = destinations[i];
+                edges[pos] = static_cast<uint32_t>(i);
+            }
+        }
+
+        void Clear()
+        {
+            offsets.assign(1, 0);
+            targets.clear();
+            edges.clear();
+            weights.clear();
+        }
+
+        size_t RowCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+        size_t EdgeCount() const { return targets.size(); }
+
+        uint32_t Begin(uint32_t row) const { return offsets[row]; }
+
+        uint32_t End(uint32_t row) const { return offsets[static_cast<size_t>(row) + 1]; }
+
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> edges;
+        std::vector<float> weights;
+    };
+}
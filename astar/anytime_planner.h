@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "adjacency.h"
+#include "open_list.h"
+#include "search_state.h"
+
+namespace astar
+{
+    // ARA*(Anytime Repairing A*).
+    // 휴리스틱에 가중치 w를 곱해서 빨리 경로를 찾고, w를 줄여 가며 이전 탐색의 g 값을 그대로 써서 경로를 고친다.
+    // 찾은 경로의 비용은 최단 경로 비용의 GetBound()배 이하이다. 휴리스틱은 consistent해야 이 보장이 성립한다.
+    // Improve는 deadline이 지나면 열린 목록을 그대로 두고 멈추므로 다음 호출에서 이어서 탐색한다.
+    class AnytimePlanner
+    {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        AnytimePlanner()
+            : m_graph{ nullptr }
+            , m_fromIndex{ npos }
+            , m_toIndex{ npos }
+            , m_weight{ 1.f }
+            , m_weightStep{ 0.5f }
+            , m_bound{ std::numeric_limits<float>::infinity() }
+            , m_cost{ std::numeric_limits<float>::infinity() }
+            , m_iteration{ 0 }
+            , m_expandedCount{ 0 }
+            , m_searching{ false }
+        {
+
+        }
+
+        bool IsActive() const { return m_fromIndex != npos; }
+
+        // 가중치가 1까지 내려가서 최단 경로를 찾았거나 경로가 없다고 확인했다.
+        bool IsFinished() const { return IsActive() && !m_searching; }
+
+        uint32_t GetFromIndex() const { return m_fromIndex; }
+
+        uint32_t GetToIndex() const { return m_toIndex; }
+
+        float GetWeight() const { return m_weight; }
+
+        // ExtractPath가 돌려주는 경로의 비용 / 최단 경로 비용의 상한. 아직 경로가 없으면 무한대이다.
+        float GetBound() const { return m_bound; }
+
+        float GetCost() const { return m_cost; }
+
+        // Reset 이후 꺼낸 노드 수의 합
+        size_t GetExpandedCount() const { return m_expandedCount; }
+
+        void Deactivate()
+        {
+            m_fromIndex = npos;
+            m_toIndex = npos;
+            m_searching = false;
+            m_openList.Clear();
+            m_incons.clear();
+        }
+
+        // weightStep만큼 가중치를 줄이다가 1에 닿으면 멈춘다.
+        template<typename TFuncH>
+        void Reset(const CsrAdjacency& graph, uint32_t fromIndex, uint32_t toIndex, float initialWeight, float weightStep, TFuncH&& funcH)
+        {
+            const size_t rowCount = graph.RowCount();
+            m_graph = &graph;
+            m_fromIndex = fromIndex;
+            m_toIndex = toIndex;
+            m_weight = std::max(initialWeight, 1.f);
+            m_weightStep = std::max(weightStep, 0.f);
+            m_bound = std::numeric_limits<float>::infinity();
+            m_cost = std::numeric_limits<float>::infinity();
+            m_expandedCount = 0;
+            m_searching = true;
+            m_slots.BeginQuery(rowCount);
+            if (m_closed.size() < rowCount)
+            {
+                m_closed.resize(rowCount, 0);
+                m_inconsistent.resize(rowCount, 0);
+            }
+
+            NextIteration();
+            m_incons.clear();
+            m_openList.Clear();
+            m_openList.Reserve(rowCount);
+            SearchSlot& from = m_slots.Touch(fromIndex, funcH);
+            from.g = 0.f;
+            m_openList.Push(fromIndex, Key(from));
+            m_slots.Touch(toIndex, funcH);
+        }
+
+        // deadline까지 탐색한다. 가중치 하나로 하는 반복이 끝나서 경로와 새 보장 배율이 나오면 true를 돌려준다.
+        // 반복 하나마다 돌아오므로 계속 줄이려면 IsFinished가 될 때까지 다시 부른다.
+        template<typename TFuncH>
+        bool Improve(TFuncH&& funcH, std::chrono::steady_clock::time_point deadline)
+        {
+            constexpr uint32_t deadlineCheckInterval = 256;
+            if (!m_searching)
+                return false;
+
+            uint32_t count = 0;
+            while (!m_openList.Empty() && m_openList.TopKey() < GoalKey())
+            {
+                if (++count == deadlineCheckInterval)
+                {
+                    count = 0;
+                    if (std::chrono::steady_clock::now() >= deadline)
+                        return false;
+                }
+
+                const uint32_t selIndex = m_openList.Pop();
+                m_expandedCount += 1;
+                m_closed[selIndex] = m_iteration;
+                const float selG = m_slots[selIndex].g;
+                const uint32_t end = m_graph->End(selIndex);
+                for (uint32_t i = m_graph->Begin(selIndex); i != end; ++i)
+                {
+                    const uint32_t nodeIndex = m_graph->targets[i];
+                    SearchSlot& node = m_slots.Touch(nodeIndex, funcH);
+                    const float g = selG + m_graph->weights[i];
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    if (m_closed[nodeIndex] != m_iteration)
+                    {
+                        m_openList.Push(nodeIndex, Key(node));
+                    }
+                    else if (m_inconsistent[nodeIndex] != m_iteration)
+                    {
+                        // 이번 반복에서는 다시 열지 않고 다음 반복으로 미룬다.
+                        m_inconsistent[nodeIndex] = m_iteration;
+                        m_incons.push_back(nodeIndex);
+                    }
+                }
+            }
+
+            if (m_slots[m_toIndex].g != std::numeric_limits<float>::max())
+            {
+                UpdatePath();
+            }
+
+            FinishIteration();
+            return m_cost != std::numeric_limits<float>::infinity();
+        }
+
+        // 지금까지 찾은 가장 짧은 경로. 출발점부터 순서대로 담는다.
+        bool ExtractPath(std::vector<uint32_t>* result) const
+        {
+            result->clear();
+            if (!IsActive() || m_cost == std::numeric_limits<float>::infinity())
+                return false;
+
+            result->assign(m_path.begin(), m_path.end());
+            return true;
+        }
+
+    private:
+        float Key(const SearchSlot& slot) const
+        {
+            return slot.g + m_weight * slot.h;
+        }
+
+        float GoalKey() const
+        {
+            const SearchSlot& goal = m_slots[m_toIndex];
+            return goal.g == std::numeric_limits<float>::max() ? std::numeric_limits<float>::infinity() : Key(goal);
+        }
+
+        // prev를 따라간 경로의 실제 비용은 g(도착점) 이하이지만 반복마다 줄어든다는 보장은 없다.
+        // 그래서 경로를 따로 보관하고 더 짧을 때만 바꾼다.
+        void UpdatePath()
+        {
+            m_scratchPath.clear();
+            float cost = 0.f;
+            for (uint32_t it = m_toIndex; it != SearchSlotTable::npos; it = m_slots[it].prev)
+            {
+                const uint32_t prev = m_slots[it].prev;
+                if (prev != SearchSlotTable::npos)
+                {
+                    float weight = std::numeric_limits<float>::infinity();
+                    const uint32_t end = m_graph->End(prev);
+                    for (uint32_t i = m_graph->Begin(prev); i != end; ++i)
+                    {
+                        if (m_graph->targets[i] == it)
+                        {
+                            weight = std::min(weight, m_graph->weights[i]);
+                        }
+                    }
+
+                    cost += weight;
+                }
+
+                m_scratchPath.push_back(it);
+            }
+
+            if (cost < m_cost)
+            {
+                m_cost = cost;
+                m_path.assign(m_scratchPath.rbegin(), m_scratchPath.rend());
+            }
+        }
+
+        void NextIteration()
+        {
+            m_iteration += 1;
+            if (m_iteration == 0)
+            {
+                std::fill(m_closed.begin(), m_closed.end(), 0);
+                std::fill(m_inconsistent.begin(), m_inconsistent.end(), 0);
+                m_iteration = 1;
+            }
+        }
+
+        // 열린 목록과 INCONS의 min(g + h)로 보장 배율을 구하고, 가중치를 줄여 다음 반복을 준비한다.
+        void FinishIteration()
+        {
+            m_pending.clear();
+            while (!m_openList.Empty())
+            {
+                m_pending.push_back(m_openList.Pop());
+            }
+
+            m_pending.insert(m_pending.end(), m_incons.begin(), m_incons.end());
+            m_incons.clear();
+            if (m_cost == std::numeric_limits<float>::infinity())
+            {
+                // 가중치와 상관없이 도착점에 닿을 수 없다.
+                m_searching = false;
+                return;
+            }
+
+            float lowerBound = std::numeric_limits<float>::infinity();
+            for (auto it : m_pending)
+            {
+                lowerBound = std::min(lowerBound, m_slots[it].g + m_slots[it].h);
+            }
+
+            m_bound = m_weight <= 1.f || lowerBound >= m_cost ? 1.f : std::min(m_weight, m_cost / lowerBound);
+            if (m_bound <= 1.f || m_weightStep <= 0.f)
+            {
+                m_searching = false;
+                return;
+            }
+
+            m_weight = std::max(1.f, m_weight - m_weightStep);
+            NextIteration();
+            for (auto it : m_pending)
+            {
+                m_openList.Push(it, Key(m_slots[it]));
+            }
+        }
+
+        const CsrAdjacency* m_graph;
+        uint32_t m_fromIndex;
+        uint32_t m_toIndex;
+        float m_weight;
+        float m_weightStep;
+        float m_bound;
+        float m_cost;
+        SearchSlotTable m_slots;
+        QuadHeapOpenList m_openList;
+        // 노드를 닫은 반복 번호, INCONS에 넣은 반복 번호
+        std::vector<uint32_t> m_closed;
+        std::vector<uint32_t> m_inconsistent;
+        std::vector<uint32_t> m_incons;
+        std::vector<uint32_t> m_pending;
+        std::vector<uint32_t> m_path;
+        std::vector<uint32_t> m_scratchPath;
+        uint32_t m_iteration;
+        size_t m_expandedCount;
+        bool m_searching;
+    };
+}
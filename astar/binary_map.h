@@ -0,0 +1,499 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include "open_list.h"
+#include "search_state.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace astar
+{
+    // 바이너리 지도 파일의 헤더. 파일은 little-endian이고 각 구간은 8바이트 단위로 정렬된다.
+    // 구간 순서: 노드 ID(uint64, 오름차순), x(float), y(float), 간선 CSR offsets(uint32, nodeCount + 1), targets(uint32)
+    // CSR의 행과 targets 값은 노드 ID 배열의 인덱스이다.
+    struct BinaryMapHeader
+    {
+        static constexpr uint32_t magicValue = 0x424D5341; // "ASMB"
+        static constexpr uint32_t currentVersion = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nodeCount;
+        uint32_t linkCount;
+        uint64_t nodeIdOffset;
+        uint64_t xOffset;
+        uint64_t yOffset;
+        uint64_t linkOffsetOffset;
+        uint64_t linkTargetOffset;
+        uint64_t fileSize;
+        // 헤더 뒤의 모든 바이트에 대한 FNV-1a 64
+        uint64_t checksum;
+    };
+
+    static_assert(sizeof(BinaryMapHeader) == 72, "BinaryMapHeader layout must not change");
+
+    enum class BinaryMapError
+    {
+        None,
+        OpenFailed,
+        TooSmall,
+        BadMagic,
+        UnsupportedVersion,
+        BadLayout,
+        ChecksumMismatch,
+        WriteFailed,
+    };
+
+    inline uint64_t BinaryMapChecksum(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= data[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    // 파일에 쓸 지도 데이터. XML에서 읽거나 편집 중인 그래프에서 모을 때 쓴다.
+    struct BinaryMapData
+    {
+        // 노드를 ID 순으로 정렬하고 (from, to) NodeId 쌍으로 CSR을 만든다.
+        // 없는 노드를 가리키는 간선이 있으면 false. 중복 간선은 하나만 남긴다.
+        bool BuildLinks(const std::vector<std::pair<uint64_t, uint64_t>>& links)
+        {
+            std::vector<uint32_t> order(nodeIds.size());
+            for (uint32_t i = 0; i < order.size(); ++i)
+            {
+                order[i] = i;
+            }
+
+            std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) { return nodeIds[lhs] < nodeIds[rhs]; });
+            std::vector<uint64_t> sortedIds(order.size());
+            std::vector<float> sortedX(order.size());
+            std::vector<float> sortedY(order.size());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                sortedIds[i] = nodeIds[order[i]];
+                sortedX[i] = x[order[i]];
+                sortedY[i] = y[order[i]];
+            }
+
+            nodeIds.swap(sortedIds);
+            x.swap(sortedX);
+            y.swap(sortedY);
+            if (std::adjacent_find(nodeIds.begin(), nodeIds.end()) != nodeIds.end())
+                return false;
+
+            std::vector<std::pair<uint32_t, uint32_t>> rows;
+            rows.reserve(links.size());
+            for (auto& it : links)
+            {
+                auto from = std::lower_bound(nodeIds.begin(), nodeIds.end(), it.first);
+                auto to = std::lower_bound(nodeIds.begin(), nodeIds.end(), it.second);
+                if (from == nodeIds.end() || *from != it.first || to == nodeIds.end() || *to != it.second)
+                    return false;
+
+                rows.emplace_back(static_cast<uint32_t>(from - nodeIds.begin()), static_cast<uint32_t>(to - nodeIds.begin()));
+            }
+
+            std::sort(rows.begin(), rows.end());
+            rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+            linkOffsets.assign(nodeIds.size() + 1, 0);
+            linkTargets.resize(rows.size());
+            for (size_t i = 0; i < rows.size(); ++i)
+            {
+                linkOffsets[static_cast<size_t>(rows[i].first) + 1] += 1;
+                linkTargets[i] = rows[i].second;
+            }
+
+            for (size_t i = 0; i < nodeIds.size(); ++i)
+            {
+                linkOffsets[i + 1] += linkOffsets[i];
+            }
+
+            return true;
+        }
+
+        std::vector<uint64_t> nodeIds;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<uint32_t> linkOffsets;
+        std::vector<uint32_t> linkTargets;
+    };
+
+    inline BinaryMapError WriteBinaryMap(const std::filesystem::path& path, const BinaryMapData& data)
+    {
+        const size_t nodeCount = data.nodeIds.size();
+        const size_t linkCount = data.linkTargets.size();
+        if (data.x.size() != nodeCount || data.y.size() != nodeCount || data.linkOffsets.size() != nodeCount + 1)
+            return BinaryMapError::BadLayout;
+
+        auto align = [](uint64_t offset) { return (offset + 7) & ~static_cast<uint64_t>(7); };
+        BinaryMapHeader header{};
+        header.magic = BinaryMapHeader::magicValue;
+        header.version = BinaryMapHeader::currentVersion;
+        header.nodeCount = static_cast<uint32_t>(nodeCount);
+        header.linkCount = static_cast<uint32_t>(linkCount);
+        header.nodeIdOffset = align(sizeof(BinaryMapHeader));
+        header.xOffset = align(header.nodeIdOffset + nodeCount * sizeof(uint64_t));
+        header.yOffset = align(header.xOffset + nodeCount * sizeof(float));
+        header.linkOffsetOffset = align(header.yOffset + nodeCount * sizeof(float));
+        header.linkTargetOffset = align(header.linkOffsetOffset + (nodeCount + 1) * sizeof(uint32_t));
+        header.fileSize = align(header.linkTargetOffset + linkCount * sizeof(uint32_t));
+
+        std::vector<uint8_t> buffer(header.fileSize, 0);
+        auto copy = [&buffer](uint64_t offset, const void* src, size_t size)
+        {
+            if (size != 0)
+            {
+                std::memcpy(buffer.data() + offset, src, size);
+            }
+        };
+
+        copy(header.nodeIdOffset, data.nodeIds.data(), nodeCount * sizeof(uint64_t));
+        copy(header.xOffset, data.x.data(), nodeCount * sizeof(float));
+        copy(header.yOffset, data.y.data(), nodeCount * sizeof(float));
+        copy(header.linkOffsetOffset, data.linkOffsets.data(), (nodeCount + 1) * sizeof(uint32_t));
+        copy(header.linkTargetOffset, data.linkTargets.data(), linkCount * sizeof(uint32_t));
+        header.checksum = BinaryMapChecksum(buffer.data() + sizeof(BinaryMapHeader), buffer.size() - sizeof(BinaryMapHeader));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+
+#if defined(_WIN32)
+        FILE* file = _wfopen(path.c_str(), L"wb");
+#else
+        FILE* file = std::fopen(path.c_str(), "wb");
+#endif
+        if (file == nullptr)
+            return BinaryMapError::WriteFailed;
+
+        const bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        if (std::fclose(file) != 0 || !written)
+            return BinaryMapError::WriteFailed;
+
+        return BinaryMapError::None;
+    }
+
+    // 읽기 전용 메모리 맵 파일
+    class MappedFile
+    {
+    public:
+        MappedFile()
+            : m_data{ nullptr }
+            , m_size{ 0 }
+#if defined(_WIN32)
+            , m_file{ INVALID_HANDLE_VALUE }
+            , m_mapping{ nullptr }
+#endif
+        {
+
+        }
+
+        ~MappedFile()
+        {
+            Close();
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::filesystem::path& path)
+        {
+            Close();
+#if defined(_WIN32)
+            m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+            {
+                Close();
+                return false;
+            }
+
+            m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping == nullptr)
+            {
+                Close();
+                return false;
+            }
+
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data == nullptr)
+            {
+                Close();
+                return false;
+            }
+
+            m_size = static_cast<size_t>(size.QuadPart);
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+                return false;
+
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = static_cast<size_t>(st.st_size);
+#endif
+            return true;
+        }
+
+        void Close()
+        {
+#if defined(_WIN32)
+            if (m_data != nullptr)
+            {
+                UnmapViewOfFile(m_data);
+            }
+
+            if (m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+                m_mapping = nullptr;
+            }
+
+            if (m_file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(m_file);
+                m_file = INVALID_HANDLE_VALUE;
+            }
+#else
+            if (m_data != nullptr)
+            {
+                ::munmap(const_cast<uint8_t*>(m_data), m_size);
+            }
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        const uint8_t* Data() const { return m_data; }
+
+        size_t Size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+#if defined(_WIN32)
+        HANDLE m_file;
+        HANDLE m_mapping;
+#endif
+    };
+
+    // 바이너리 지도를 복사하지 않고 읽는다. 배열 포인터는 파일(또는 Attach한 버퍼) 안을 가리킨다.
+    // Open/Attach에서 구간 경계와 CSR 인덱스 범위를 검사하므로 그 뒤로는 인덱스를 믿고 써도 된다.
+    class BinaryMapView
+    {
+    public:
+        BinaryMapView()
+            : m_header{}
+            , m_data{ nullptr }
+        {
+
+        }
+
+        BinaryMapError Open(const std::filesystem::path& path, bool verifyChecksum = true)
+        {
+            if (!m_file.Open(path))
+                return BinaryMapError::OpenFailed;
+
+            const BinaryMapError error = Attach(m_file.Data(), m_file.Size(), verifyChecksum);
+            if (error != BinaryMapError::None)
+            {
+                m_file.Close();
+            }
+
+            return error;
+        }
+
+        // data는 8바이트 정렬이어야 하고 뷰를 쓰는 동안 살아 있어야 한다.
+        BinaryMapError Attach(const void* data, size_t size, bool verifyChecksum = true)
+        {
+            m_data = nullptr;
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            if (size < sizeof(BinaryMapHeader))
+                return BinaryMapError::TooSmall;
+
+            BinaryMapHeader header;
+            std::memcpy(&header, bytes, sizeof(header));
+            if (header.magic != BinaryMapHeader::magicValue)
+                return BinaryMapError::BadMagic;
+
+            if (header.version != BinaryMapHeader::currentVersion)
+                return BinaryMapError::UnsupportedVersion;
+
+            const uint64_t nodeCount = header.nodeCount;
+            const uint64_t linkCount = header.linkCount;
+            auto fits = [&header](uint64_t offset, uint64_t length)
+            {
+                return offset % 8 == 0 && offset >= sizeof(BinaryMapHeader) && offset <= header.fileSize && length <= header.fileSize - offset;
+            };
+
+            if (header.fileSize != size
+                || !fits(header.nodeIdOffset, nodeCount * sizeof(uint64_t))
+                || !fits(header.xOffset, nodeCount * sizeof(float))
+                || !fits(header.yOffset, nodeCount * sizeof(float))
+                || !fits(header.linkOffsetOffset, (nodeCount + 1) * sizeof(uint32_t))
+                || !fits(header.linkTargetOffset, linkCount * sizeof(uint32_t)))
+                return BinaryMapError::BadLayout;
+
+            if (verifyChecksum && BinaryMapChecksum(bytes + sizeof(BinaryMapHeader), size - sizeof(BinaryMapHeader)) != header.checksum)
+                return BinaryMapError::ChecksumMismatch;
+
+            const uint64_t* nodeIds = reinterpret_cast<const uint64_t*>(bytes + header.nodeIdOffset);
+            const uint32_t* offsets = reinterpret_cast<const uint32_t*>(bytes + header.linkOffsetOffset);
+            const uint32_t* targets = reinterpret_cast<const uint32_t*>(bytes + header.linkTargetOffset);
+            if (offsets[0] != 0 || offsets[nodeCount] != linkCount)
+                return BinaryMapError::BadLayout;
+
+            for (uint64_t i = 0; i < nodeCount; ++i)
+            {
+                if (offsets[i] > offsets[i + 1] || (i != 0 && nodeIds[i - 1] >= nodeIds[i]))
+                    return BinaryMapError::BadLayout;
+            }
+
+            for (uint64_t i = 0; i < linkCount; ++i)
+            {
+                if (targets[i] >= nodeCount)
+                    return BinaryMapError::BadLayout;
+            }
+
+            m_header = header;
+            m_data = bytes;
+            return BinaryMapError::None;
+        }
+
+        bool IsOpen() const { return m_data != nullptr; }
+
+        uint32_t GetNodeCount() const { return m_header.nodeCount; }
+
+        uint32_t GetLinkCount() const { return m_header.linkCount; }
+
+        const uint64_t* NodeIds() const { return Section<uint64_t>(m_header.nodeIdOffset); }
+
+        const float* X() const { return Section<float>(m_header.xOffset); }
+
+        const float* Y() const { return Section<float>(m_header.yOffset); }
+
+        const uint32_t* LinkOffsets() const { return Section<uint32_t>(m_header.linkOffsetOffset); }
+
+        const uint32_t* LinkTargets() const { return Section<uint32_t>(m_header.linkTargetOffset); }
+
+        // 노드 ID가 정렬되어 있으므로 이분 탐색한다. 없으면 npos
+        uint32_t FindNodeIndex(uint64_t nodeId) const
+        {
+            const uint64_t* first = NodeIds();
+            const uint64_t* last = first + m_header.nodeCount;
+            const uint64_t* it = std::lower_bound(first, last, nodeId);
+            if (it == last || *it != nodeId)
+                return SearchSlotTable::npos;
+
+            return static_cast<uint32_t>(it - first);
+        }
+
+        // 파일의 CSR과 좌표를 그대로 쓰는 A*. 간선 비용과 휴리스틱은 좌표 사이의 거리이다.
+        template<typename TOpenList>
+        bool Navigate(size_t fromNodeId, size_t toNodeId, std::vector<size_t>* result, PathQueryContext<TOpenList>& context) const
+        {
+            result->clear();
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == SearchSlotTable::npos || toIndex == SearchSlotTable::npos)
+                return false;
+
+            const float* xs = X();
+            const float* ys = Y();
+            const uint32_t* offsets = LinkOffsets();
+            const uint32_t* targets = LinkTargets();
+            const uint64_t* nodeIds = NodeIds();
+            auto distance = [xs, ys](uint32_t lhs, uint32_t rhs)
+            {
+                const float dx = xs[lhs] - xs[rhs];
+                const float dy = ys[lhs] - ys[rhs];
+                return std::sqrt(dx * dx + dy * dy);
+            };
+
+            auto funcH = [&distance, toIndex](uint32_t index) { return distance(index, toIndex); };
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            slots.BeginQuery(m_header.nodeCount);
+            openList.Clear();
+            openList.Reserve(m_header.nodeCount);
+            SearchSlot& from = slots.Touch(fromIndex, funcH);
+            from.g = 0.f;
+            openList.Push(fromIndex, from.h);
+            while (true)
+            {
+                if (openList.Empty())
+                    return false;
+
+                const uint32_t selIndex = openList.Pop();
+                if (selIndex == toIndex)
+                    break;
+
+                const float selG = slots[selIndex].g;
+                for (uint32_t i = offsets[selIndex]; i != offsets[selIndex + 1]; ++i)
+                {
+                    const uint32_t target = targets[i];
+                    SearchSlot& node = slots.Touch(target, funcH);
+                    const float g = selG + distance(selIndex, target);
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    openList.Push(target, g + node.h);
+                }
+            }
+
+            for (uint32_t it = toIndex; it != SearchSlotTable::npos; it = slots[it].prev)
+            {
+                result->push_back(static_cast<size_t>(nodeIds[it]));
+            }
+
+            std::reverse(result->begin(), result->end());
+            return true;
+        }
+
+    private:
+        template<typename T>
+        const T* Section(uint64_t offset) const
+        {
+            return reinterpret_cast<const T*>(m_data + offset);
+        }
+
+        MappedFile m_file;
+        BinaryMapHeader m_header;
+        const uint8_t* m_data;
+    };
+}
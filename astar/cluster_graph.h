@@ -0,0 +1,673 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "path_query_service.h"
+#include "search_state.h"
+#include "thread_pool.h"
+
+namespace astar
+{
+    // HPA*(Hierarchical Path-Finding A*)의 추상 그래프.
+    // 노드를 좌표로 clusterSize 격자 칸(군집)에 나누고, 군집 경계를 넘는 간선의 양 끝을 출입구로 삼는다.
+    // 군집마다 출입구 사이의 최단 거리를 군집 안에서만 구해 두고, 질의는 출입구로 이뤄진 작은 그래프를 먼저 탐색한 뒤
+    // 군집 안의 구간을 실제 경로로 풀어낸다.
+    // 경계 간선을 모두 남기면 평면 A*와 같은 비용의 경로를 찾고, maxTransitionsPerPair로 줄이면 더 빠르지만 경로가 길어질 수 있다.
+    class ClusterGraph
+    {
+    public:
+        using NodeId = size_t;
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        struct Options
+        {
+            // 군집 한 변의 길이(좌표 단위)
+            float clusterSize;
+            // 맞닿은 두 군집 사이에 남길 경계 간선(양방향 한 쌍을 하나로 센다) 수. 0이면 모두 남긴다.
+            uint32_t maxTransitionsPerPair;
+        };
+
+        struct Statistics
+        {
+            double buildSeconds;
+            size_t clusterCount;
+            size_t entranceCount;
+            // 출입구 사이 거리표에서 이어진 칸 수
+            size_t intraEdgeCount;
+            size_t transitionCount;
+            // 마지막 Build에서 거리표를 다시 계산한 군집과 그대로 쓴 군집
+            size_t rebuiltClusterCount;
+            size_t reusedClusterCount;
+        };
+
+        ClusterGraph()
+            : m_options{ 1.f, 0 }
+            , m_statistics{}
+        {
+
+        }
+
+        bool IsBuilt() const { return m_snapshot != nullptr; }
+
+        const Options& GetOptions() const { return m_options; }
+
+        const Statistics& GetStatistics() const { return m_statistics; }
+
+        const GraphSnapshot* GetSnapshot() const { return m_snapshot.get(); }
+
+        void Clear()
+        {
+            m_snapshot.reset();
+            m_reverseLinkIndex.Clear();
+            m_clusterOf.clear();
+            m_clusters.clear();
+            m_clusterByKey = NodeIdMap<uint32_t, uint64_t>{};
+            m_abstractNodes.clear();
+            m_transitions.Clear();
+            m_statistics = Statistics{};
+        }
+
+        // snapshot으로 다시 만든다. 옵션이 같으면 구성원, 내부 간선 비용, 출입구가 모두 그대로인 군집은
+        // 이전 거리표를 재사용하므로 그래프를 조금 고친 뒤에는 고친 곳의 군집만 Dijkstra를 다시 돈다.
+        // 군집 나누기, 역방향 인덱스, 경계 간선 정렬은 재사용하지 않고 매번 O(N+E)로 다시 한다.
+        void Build(std::shared_ptr<const GraphSnapshot> snapshot, const Options& options, ThreadPool* pool = nullptr)
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            if (options.clusterSize != m_options.clusterSize || options.maxTransitionsPerPair != m_options.maxTransitionsPerPair)
+            {
+                Clear();
+            }
+
+            m_options = options;
+            m_snapshot = std::move(snapshot);
+            const GraphSnapshot& graph = *m_snapshot;
+            const uint32_t nodeCount = static_cast<uint32_t>(graph.indexToNodeId.size());
+            BuildReverseLinkIndex();
+
+            std::vector<Cluster> oldClusters;
+            oldClusters.swap(m_clusters);
+            NodeIdMap<uint32_t, uint64_t> oldClusterByKey;
+            std::swap(oldClusterByKey, m_clusterByKey);
+
+            // 칸 번호로 군집을 나누고 구성원과 내부 간선으로 지문을 만든다.
+            m_clusterOf.assign(nodeCount, npos);
+            for (uint32_t index = 0; index < nodeCount; ++index)
+            {
+                const int32_t cellX = static_cast<int32_t>(std::floor(graph.x[index] / m_options.clusterSize));
+                const int32_t cellY = static_cast<int32_t>(std::floor(graph.y[index] / m_options.clusterSize));
+                const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) | static_cast<uint32_t>(cellY);
+                auto inserted = m_clusterByKey.insert(key, static_cast<uint32_t>(m_clusters.size()));
+                if (inserted.second)
+                {
+                    m_clusters.push_back(Cluster{ key, cellX, cellY, 0, {}, {}, 0 });
+                }
+
+                m_clusterOf[index] = inserted.first->value;
+            }
+
+            for (uint32_t index = 0; index < nodeCount; ++index)
+            {
+                Cluster& cluster = m_clusters[m_clusterOf[index]];
+                const uint64_t nodeHash = Mix(graph.indexToNodeId[index]);
+                cluster.fingerprint += nodeHash;
+                const uint32_t end = graph.linkIndex.End(index);
+                for (uint32_t i = graph.linkIndex.Begin(index); i != end; ++i)
+                {
+                    const uint32_t target = graph.linkIndex.targets[i];
+                    if (m_clusterOf[target] != m_clusterOf[index])
+                        continue;
+
+                    cluster.fingerprint += Mix(Mix(nodeHash + graph.indexToNodeId[target]) + FloatBits(graph.linkIndex.weights[i]));
+                }
+            }
+
+            SelectTransitions();
+
+            // 출입구 목록까지 같으면 이전 거리표를 옮겨 오고, 아니면 다시 계산할 목록에 넣는다.
+            std::vector<uint32_t> dirtyClusters;
+            m_statistics = Statistics{};
+            for (uint32_t c = 0; c < m_clusters.size(); ++c)
+            {
+                Cluster& cluster = m_clusters[c];
+                for (auto it : cluster.entrances)
+                {
+                    cluster.fingerprint = Mix(cluster.fingerprint + graph.indexToNodeId[it]);
+                }
+
+                const uint32_t* old = oldClusterByKey.get(cluster.key);
+                if (old != nullptr && oldClusters[*old].fingerprint == cluster.fingerprint)
+                {
+                    cluster.distances.swap(oldClusters[*old].distances);
+                    m_statistics.reusedClusterCount += 1;
+                }
+                else
+                {
+                    dirtyClusters.push_back(c);
+                }
+            }
+
+            if (pool != nullptr && pool->GetWorkerCount() > 1 && dirtyClusters.size() > 1)
+            {
+                std::vector<LocalSearch> searches(pool->GetWorkerCount());
+                pool->ParallelFor(dirtyClusters.size(), [&](unsigned workerIndex, size_t i)
+                    {
+                        ComputeDistances(dirtyClusters[i], searches[workerIndex]);
+                    });
+            }
+            else
+            {
+                LocalSearch search;
+                for (auto c : dirtyClusters)
+                {
+                    ComputeDistances(c, search);
+                }
+            }
+
+            m_statistics.rebuiltClusterCount = dirtyClusters.size();
+            m_statistics.clusterCount = m_clusters.size();
+            m_statistics.entranceCount = m_abstractNodes.size();
+            m_statistics.transitionCount = m_transitions.EdgeCount();
+            for (auto& cluster : m_clusters)
+            {
+                for (auto it : cluster.distances)
+                {
+                    m_statistics.intraEdgeCount += it != std::numeric_limits<float>::max() ? 1 : 0;
+                }
+
+                m_statistics.intraEdgeCount -= cluster.entrances.size();
+            }
+
+            m_statistics.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        // 추상 그래프를 context.slots/openList로, 군집 안의 탐색을 context.backwardSlots/backwardOpenList로 한다.
+        // 출발/도착 군집의 출입구까지 거리는 context.neighborH/neighborCost에 잠시 담는다.
+        template<typename TOpenList, typename TTrace>
+        bool Query(NodeId fromNodeId, NodeId toNodeId, PathQueryContext<TOpenList, TTrace>& context, std::vector<NodeId>* result, float* cost = nullptr) const
+        {
+            result->clear();
+            if (!IsBuilt())
+                return false;
+
+            const GraphSnapshot& graph = *m_snapshot;
+            const uint32_t fromIndex = graph.FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = graph.FindNodeIndex(toNodeId);
+            if (fromIndex == GraphSnapshot::invalidIndex || toIndex == GraphSnapshot::invalidIndex)
+                return false;
+
+            if (fromIndex == toIndex)
+            {
+                result->push_back(fromNodeId);
+                return true;
+            }
+
+            auto& trace = context.trace;
+            trace.BeginQuery(fromIndex, toIndex);
+            const Cluster& fromCluster = m_clusters[m_clusterOf[fromIndex]];
+            const Cluster& toCluster = m_clusters[m_clusterOf[toIndex]];
+            auto& sourceCost = context.neighborH;
+            auto& targetCost = context.neighborCost;
+            auto& localSlots = context.backwardSlots;
+            auto& localOpenList = context.backwardOpenList;
+            float directCost = std::numeric_limits<float>::max();
+            SearchCluster(graph.linkIndex, m_clusterOf[fromIndex], fromIndex, npos, localSlots, localOpenList);
+            sourceCost.resize(fromCluster.entrances.size());
+            for (size_t i = 0; i < fromCluster.entrances.size(); ++i)
+            {
+                sourceCost[i] = CostOf(localSlots, fromCluster.entrances[i]);
+            }
+
+            if (&fromCluster == &toCluster)
+            {
+                directCost = CostOf(localSlots, toIndex);
+            }
+
+            SearchCluster(m_reverseLinkIndex, m_clusterOf[toIndex], toIndex, npos, localSlots, localOpenList);
+            targetCost.resize(toCluster.entrances.size());
+            for (size_t i = 0; i < toCluster.entrances.size(); ++i)
+            {
+                targetCost[i] = CostOf(localSlots, toCluster.entrances[i]);
+            }
+
+            // 출입구 번호 뒤에 출발점과 도착점을 붙인다.
+            const uint32_t abstractCount = static_cast<uint32_t>(m_abstractNodes.size());
+            const uint32_t source = abstractCount;
+            const uint32_t target = abstractCount + 1;
+            auto funcH = [&](uint32_t node)
+            {
+                if (node == target)
+                    return 0.f;
+
+                return graph.Distance(node == source ? fromIndex : m_abstractNodes[node].index, toIndex);
+            };
+
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            slots.BeginQuery(abstractCount + 2);
+            openList.Clear();
+            openList.Reserve(abstractCount + 2);
+            SearchSlot& start = slots.Touch(source, funcH);
+            start.g = 0.f;
+            openList.Push(source, start.h);
+            auto relax = [&](uint32_t selNode, float selG, uint32_t node, float weight)
+            {
+                if (weight == std::numeric_limits<float>::max())
+                    return;
+
+                SearchSlot& slot = slots.Touch(node, funcH);
+                const float g = selG + weight;
+                if (slot.g <= g)
+                    return;
+
+                slot.g = g;
+                slot.prev = selNode;
+                openList.Push(node, g + slot.h);
+                trace.OnRelax(node < abstractCount ? m_abstractNodes[node].index : toIndex, openList.Size());
+            };
+
+            while (true)
+            {
+                if (openList.Empty())
+                    return trace.EndQuery(false);
+
+                const uint32_t selNode = openList.Pop();
+                if (selNode == target)
+                    break;
+
+                const float selG = slots[selNode].g;
+                if (selNode == source)
+                {
+                    trace.OnExpand(fromIndex);
+                    for (uint32_t i = 0; i < fromCluster.entrances.size(); ++i)
+                    {
+                        relax(selNode, selG, fromCluster.firstAbstractNode + i, sourceCost[i]);
+                    }
+
+                    relax(selNode, selG, target, directCost);
+                    continue;
+                }
+
+                const AbstractNode& node = m_abstractNodes[selNode];
+                const Cluster& cluster = m_clusters[node.cluster];
+                const uint32_t entranceCount = static_cast<uint32_t>(cluster.entrances.size());
+                trace.OnExpand(node.index);
+                for (uint32_t i = 0; i < entranceCount; ++i)
+                {
+                    if (i != node.local)
+                    {
+                        relax(selNode, selG, cluster.firstAbstractNode + i, cluster.distances[node.local * entranceCount + i]);
+                    }
+                }
+
+                const uint32_t end = m_transitions.End(selNode);
+                for (uint32_t i = m_transitions.Begin(selNode); i != end; ++i)
+                {
+                    relax(selNode, selG, m_transitions.targets[i], m_transitions.weights[i]);
+                }
+
+                if (&cluster == &toCluster)
+                {
+                    relax(selNode, selG, target, targetCost[node.local]);
+                }
+            }
+
+            if (cost != nullptr)
+            {
+                *cost = slots[target].g;
+            }
+
+            // 추상 경로를 거꾸로 모은 뒤 구간마다 실제 노드로 푼다.
+            auto& chain = context.neighbors;
+            chain.clear();
+            for (uint32_t it = target; it != SearchSlotTable::npos; it = slots[it].prev)
+            {
+                chain.push_back(it == source ? fromIndex : it == target ? toIndex : m_abstractNodes[it].index);
+            }
+
+            std::reverse(chain.begin(), chain.end());
+            result->push_back(fromNodeId);
+            for (size_t i = 1; i < chain.size(); ++i)
+            {
+                const uint32_t segmentFrom = chain[i - 1];
+                const uint32_t segmentTo = chain[i];
+                if (m_clusterOf[segmentFrom] != m_clusterOf[segmentTo])
+                {
+                    // 경계 간선은 그대로 잇는다.
+                    result->push_back(graph.indexToNodeId[segmentTo]);
+                    continue;
+                }
+
+                SearchCluster(graph.linkIndex, m_clusterOf[segmentFrom], segmentFrom, segmentTo, localSlots, localOpenList);
+                const size_t mark = result->size();
+                for (uint32_t it = segmentTo; it != segmentFrom; it = localSlots[it].prev)
+                {
+                    result->push_back(graph.indexToNodeId[it]);
+                }
+
+                std::reverse(result->begin() + mark, result->end());
+            }
+
+            return trace.EndQuery(true);
+        }
+
+    private:
+        struct Cluster
+        {
+            uint64_t key;
+            int32_t cellX;
+            int32_t cellY;
+            uint64_t fingerprint;
+            // NodeId 순으로 정렬한 출입구의 노드 인덱스
+            std::vector<uint32_t> entrances;
+            // entrances.size()² 크기. [i * n + j]는 i번째 출입구에서 j번째 출입구까지 군집 안에서만 간 거리
+            std::vector<float> distances;
+            uint32_t firstAbstractNode;
+        };
+
+        struct AbstractNode
+        {
+            uint32_t index;
+            uint32_t cluster;
+            uint32_t local;
+        };
+
+        struct Crossing
+        {
+            // 두 군집 번호를 작은 쪽부터 합친 값
+            uint64_t pair;
+            // 경계를 따라 잰 간선 중점의 위치
+            float along;
+            NodeId lowNodeId;
+            NodeId highNodeId;
+            uint32_t from;
+            uint32_t to;
+            float weight;
+        };
+
+        struct LocalSearch
+        {
+            SearchSlotTable slots;
+            QuadHeapOpenList openList;
+        };
+
+        static uint64_t Mix(uint64_t value)
+        {
+            value += 0x9e3779b97f4a7c15ull;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        static uint64_t FloatBits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        static float CostOf(const SearchSlotTable& slots, uint32_t index)
+        {
+            return slots.IsTouched(index) ? slots[index].g : std::numeric_limits<float>::max();
+        }
+
+        void BuildReverseLinkIndex()
+        {
+            const CsrAdjacency& linkIndex = m_snapshot->linkIndex;
+            const uint32_t nodeCount = static_cast<uint32_t>(linkIndex.RowCount());
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> destinations;
+            sources.reserve(linkIndex.EdgeCount());
+            destinations.reserve(linkIndex.EdgeCount());
+            for (uint32_t row = 0; row < nodeCount; ++row)
+            {
+                const uint32_t end = linkIndex.End(row);
+                for (uint32_t i = linkIndex.Begin(row); i != end; ++i)
+                {
+                    sources.push_back(linkIndex.targets[i]);
+                    destinations.push_back(row);
+                }
+            }
+
+            m_reverseLinkIndex.Build(nodeCount, sources, destinations);
+            for (size_t i = 0; i < m_reverseLinkIndex.EdgeCount(); ++i)
+            {
+                m_reverseLinkIndex.weights[i] = linkIndex.weights[m_reverseLinkIndex.edges[i]];
+            }
+        }
+
+        // 경계 간선을 군집 쌍별로 경계를 따라 정렬하고, 쌍마다 고르게 떨어진 maxTransitionsPerPair개만 남긴다.
+        // 양방향 간선은 한 쌍으로 묶어서 같이 남기거나 같이 버린다.
+        void SelectTransitions()
+        {
+            const GraphSnapshot& graph = *m_snapshot;
+            const uint32_t nodeCount = static_cast<uint32_t>(graph.indexToNodeId.size());
+            std::vector<Crossing> crossings;
+            for (uint32_t row = 0; row < nodeCount; ++row)
+            {
+                const uint32_t end = graph.linkIndex.End(row);
+                for (uint32_t i = graph.linkIndex.Begin(row); i != end; ++i)
+                {
+                    const uint32_t target = graph.linkIndex.targets[i];
+                    const uint32_t a = m_clusterOf[row];
+                    const uint32_t b = m_clusterOf[target];
+                    if (a == b)
+                        continue;
+
+                    const Cluster& low = m_clusters[std::min(a, b)];
+                    const Cluster& high = m_clusters[std::max(a, b)];
+                    const float midX = (graph.x[row] + graph.x[target]) * 0.5f;
+                    const float midY = (graph.y[row] + graph.y[target]) * 0.5f;
+                    float along = midX + midY;
+                    if (low.cellY == high.cellY)
+                    {
+                        along = midY;
+                    }
+                    else if (low.cellX == high.cellX)
+                    {
+                        along = midX;
+                    }
+
+                    const NodeId rowNodeId = graph.indexToNodeId[row];
+                    const NodeId targetNodeId = graph.indexToNodeId[target];
+                    crossings.push_back(Crossing{
+                        (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b),
+                        along,
+                        std::min(rowNodeId, targetNodeId),
+                        std::max(rowNodeId, targetNodeId),
+                        row,
+                        target,
+                        graph.linkIndex.weights[i] });
+                }
+            }
+
+            std::sort(crossings.begin(), crossings.end(), [](const Crossing& lhs, const Crossing& rhs)
+                {
+                    if (lhs.pair != rhs.pair)
+                        return lhs.pair < rhs.pair;
+
+                    if (lhs.along != rhs.along)
+                        return lhs.along < rhs.along;
+
+                    if (lhs.lowNodeId != rhs.lowNodeId)
+                        return lhs.lowNodeId < rhs.lowNodeId;
+
+                    return lhs.highNodeId < rhs.highNodeId;
+                });
+
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> destinations;
+            std::vector<float> weights;
+            const uint32_t limit = m_options.maxTransitionsPerPair;
+            for (size_t begin = 0; begin < crossings.size();)
+            {
+                size_t end = begin;
+                size_t pairCount = 0;
+                while (end < crossings.size() && crossings[end].pair == crossings[begin].pair)
+                {
+                    if (end == begin || !SameNodes(crossings[end], crossings[end - 1]))
+                    {
+                        pairCount += 1;
+                    }
+
+                    end += 1;
+                }
+
+                size_t rank = 0;
+                size_t nextPick = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (i != begin && !SameNodes(crossings[i], crossings[i - 1]))
+                    {
+                        rank += 1;
+                    }
+
+                    bool keep = limit == 0 || pairCount <= limit;
+                    if (!keep)
+                    {
+                        // limit개를 구간 [0, pairCount)에 고르게 흩는다.
+                        while (nextPick < limit && Pick(nextPick, limit, pairCount) < rank)
+                        {
+                            nextPick += 1;
+                        }
+
+                        keep = nextPick < limit && Pick(nextPick, limit, pairCount) == rank;
+                    }
+
+                    if (keep)
+                    {
+                        sources.push_back(crossings[i].from);
+                        destinations.push_back(crossings[i].to);
+                        weights.push_back(crossings[i].weight);
+                        m_clusters[m_clusterOf[crossings[i].from]].entrances.push_back(crossings[i].from);
+                        m_clusters[m_clusterOf[crossings[i].to]].entrances.push_back(crossings[i].to);
+                    }
+                }
+
+                begin = end;
+            }
+
+            // 출입구에 추상 노드 번호를 붙이고 경계 간선을 그 번호로 바꾼다.
+            std::vector<uint32_t> abstractOf(nodeCount, npos);
+            m_abstractNodes.clear();
+            for (uint32_t c = 0; c < m_clusters.size(); ++c)
+            {
+                Cluster& cluster = m_clusters[c];
+                std::sort(cluster.entrances.begin(), cluster.entrances.end(), [&graph](uint32_t lhs, uint32_t rhs)
+                    {
+                        return graph.indexToNodeId[lhs] < graph.indexToNodeId[rhs];
+                    });
+                cluster.entrances.erase(std::unique(cluster.entrances.begin(), cluster.entrances.end()), cluster.entrances.end());
+                cluster.firstAbstractNode = static_cast<uint32_t>(m_abstractNodes.size());
+                for (uint32_t i = 0; i < cluster.entrances.size(); ++i)
+                {
+                    abstractOf[cluster.entrances[i]] = static_cast<uint32_t>(m_abstractNodes.size());
+                    m_abstractNodes.push_back(AbstractNode{ cluster.entrances[i], c, i });
+                }
+            }
+
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                sources[i] = abstractOf[sources[i]];
+                destinations[i] = abstractOf[destinations[i]];
+            }
+
+            m_transitions.Build(m_abstractNodes.size(), sources, destinations);
+            for (size_t i = 0; i < m_transitions.EdgeCount(); ++i)
+            {
+                m_transitions.weights[i] = weights[m_transitions.edges[i]];
+            }
+        }
+
+        static bool SameNodes(const Crossing& lhs, const Crossing& rhs)
+        {
+            return lhs.lowNodeId == rhs.lowNodeId && lhs.highNodeId == rhs.highNodeId;
+        }
+
+        static size_t Pick(size_t k, size_t limit, size_t count)
+        {
+            if (limit == 1)
+                return count / 2;
+
+            return k * (count - 1) / (limit - 1);
+        }
+
+        void ComputeDistances(uint32_t c, LocalSearch& search)
+        {
+            Cluster& cluster = m_clusters[c];
+            const size_t entranceCount = cluster.entrances.size();
+            cluster.distances.assign(entranceCount * entranceCount, std::numeric_limits<float>::max());
+            for (size_t i = 0; i < entranceCount; ++i)
+            {
+                SearchCluster(m_snapshot->linkIndex, c, cluster.entrances[i], npos, search.slots, search.openList);
+                for (size_t j = 0; j < entranceCount; ++j)
+                {
+                    cluster.distances[i * entranceCount + j] = CostOf(search.slots, cluster.entrances[j]);
+                }
+            }
+        }
+
+        // cluster 안의 노드만 따라가는 탐색. goal이 npos면 닿는 곳을 모두 Dijkstra로 훑고, 아니면 goal까지 A*로 간다.
+        template<typename TOpenList>
+        void SearchCluster(const CsrAdjacency& linkIndex, uint32_t cluster, uint32_t start, uint32_t goal, SearchSlotTable& slots, TOpenList& openList) const
+        {
+            const GraphSnapshot& graph = *m_snapshot;
+            auto funcH = [&graph, goal](uint32_t index)
+            {
+                return goal == npos ? 0.f : graph.Distance(index, goal);
+            };
+
+            slots.BeginQuery(linkIndex.RowCount());
+            openList.Clear();
+            openList.Reserve(linkIndex.RowCount());
+            SearchSlot& from = slots.Touch(start, funcH);
+            from.g = 0.f;
+            openList.Push(start, from.h);
+            while (!openList.Empty())
+            {
+                const uint32_t selIndex = openList.Pop();
+                if (selIndex == goal)
+                    return;
+
+                const float selG = slots[selIndex].g;
+                const uint32_t end = linkIndex.End(selIndex);
+                for (uint32_t i = linkIndex.Begin(selIndex); i != end; ++i)
+                {
+                    const uint32_t nodeIndex = linkIndex.targets[i];
+                    if (m_clusterOf[nodeIndex] != cluster)
+                        continue;
+
+                    SearchSlot& node = slots.Touch(nodeIndex, funcH);
+                    const float g = selG + linkIndex.weights[i];
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    openList.Push(nodeIndex, g + node.h);
+                }
+            }
+        }
+
+        Options m_options;
+        Statistics m_statistics;
+        std::shared_ptr<const GraphSnapshot> m_snapshot;
+        CsrAdjacency m_reverseLinkIndex;
+        std::vector<uint32_t> m_clusterOf;
+        std::vector<Cluster> m_clusters;
+        NodeIdMap<uint32_t, uint64_t> m_clusterByKey;
+        // 출입구별 노드 인덱스와 군집. 번호는 군집 순서대로 이어져 있다.
+        std::vector<AbstractNode> m_abstractNodes;
+        // 추상 노드 번호 사이의 경계 간선
+        CsrAdjacency m_transitions;
+    };
+}
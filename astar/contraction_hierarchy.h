@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "adjacency.h"
+#include "open_list.h"
+#include "search_state.h"
+#include "thread_pool.h"
+
+namespace astar
+{
+    // Contraction Hierarchies 전처리와 질의.
+    // 노드를 중요도 순으로 하나씩 축약하면서 필요한 지름길 간선을 추가하고,
+    // 질의는 순위가 올라가는 간선만 따라가는 양방향 Dijkstra로 처리한다.
+    // 모든 인덱스는 GenericPathFinder의 노드 인덱스이다.
+    class ContractionHierarchy
+    {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        struct Statistics
+        {
+            double preprocessSeconds;
+            size_t originalEdgeCount;
+            size_t shortcutCount;
+        };
+
+        ContractionHierarchy()
+            : m_statistics{}
+            , m_built{ false }
+        {
+
+        }
+
+        bool IsBuilt() const { return m_built; }
+
+        const Statistics& GetStatistics() const { return m_statistics; }
+
+        void Clear()
+        {
+            m_rank.clear();
+            m_up.Clear();
+            m_down.Clear();
+            m_statistics = Statistics{};
+            m_built = false;
+        }
+
+        // pool이 있으면 초기 우선순위를 구하는 witness 탐색을 병렬로 돌린다.
+        void Build(const CsrAdjacency& linkIndex, ThreadPool* pool = nullptr)
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            const uint32_t nodeCount = static_cast<uint32_t>(linkIndex.RowCount());
+            BuildState state;
+            state.outEdges.assign(nodeCount, {});
+            state.inEdges.assign(nodeCount, {});
+            state.deletedNeighbors.assign(nodeCount, 0);
+            state.upEdges.assign(nodeCount, {});
+            state.downEdges.assign(nodeCount, {});
+            m_statistics = Statistics{};
+            m_statistics.originalEdgeCount = linkIndex.EdgeCount();
+            for (uint32_t row = 0; row < nodeCount; ++row)
+            {
+                const uint32_t end = linkIndex.End(row);
+                for (uint32_t i = linkIndex.Begin(row); i != end; ++i)
+                {
+                    const uint32_t target = linkIndex.targets[i];
+                    if (target == row)
+                        continue;
+
+                    AddEdge(&state.outEdges[row], Edge{ target, linkIndex.weights[i], npos });
+                    AddEdge(&state.inEdges[target], Edge{ row, linkIndex.weights[i], npos });
+                }
+            }
+
+            std::vector<float> priority(nodeCount);
+            std::vector<Shortcut> shortcuts;
+            if (pool != nullptr && pool->GetWorkerCount() > 1)
+            {
+                std::vector<WitnessSearch> witness(pool->GetWorkerCount());
+                pool->ParallelFor(nodeCount, [&](unsigned workerIndex, size_t node)
+                    {
+                        priority[node] = ComputePriority(state, static_cast<uint32_t>(node), witness[workerIndex], nullptr);
+                    }, 64);
+            }
+            else
+            {
+                for (uint32_t node = 0; node < nodeCount; ++node)
+                {
+                    priority[node] = ComputePriority(state, node, state.witness, nullptr);
+                }
+            }
+
+            TQuadHeap<float> queue;
+            queue.Reserve(nodeCount);
+            for (uint32_t node = 0; node < nodeCount; ++node)
+            {
+                queue.Push(node, priority[node]);
+            }
+
+            m_rank.assign(nodeCount, npos);
+            uint32_t order = 0;
+            while (!queue.Empty())
+            {
+                // 우선순위를 다시 계산해서 여전히 가장 작을 때만 축약한다(lazy update).
+                const uint32_t node = queue.Pop();
+                shortcuts.clear();
+                float newPriority = ComputePriority(state, node, state.witness, &shortcuts);
+                if (!queue.Empty() && newPriority > queue.TopKey())
+                {
+                    queue.Push(node, newPriority);
+                    continue;
+                }
+
+                Contract(&state, node, shortcuts);
+                m_rank[node] = order++;
+            }
+
+            m_up.Build(state.upEdges);
+            m_down.Build(state.downEdges);
+            m_built = true;
+            m_statistics.preprocessSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        // fromIndex에서 toIndex까지의 최단 경로를 지름길을 풀어서 노드 인덱스 순서대로 emit에 넘긴다.
+        template<typename TOpenList, typename TTrace, typename TEmit>
+        bool Query(uint32_t fromIndex, uint32_t toIndex, PathQueryContext<TOpenList, TTrace>& context, TEmit&& emit, float* cost = nullptr) const
+        {
+            if (!m_built || fromIndex >= m_rank.size() || toIndex >= m_rank.size())
+                return false;
+
+            auto zero = [](uint32_t) { return 0.f; };
+            auto& forwardSlots = context.slots;
+            auto& forwardOpenList = context.openList;
+            auto& backwardSlots = context.backwardSlots;
+            auto& backwardOpenList = context.backwardOpenList;
+            auto& trace = context.trace;
+            const size_t nodeCount = m_rank.size();
+            trace.BeginQuery(fromIndex, toIndex);
+            forwardSlots.BeginQuery(nodeCount);
+            backwardSlots.BeginQuery(nodeCount);
+            forwardOpenList.Clear();
+            forwardOpenList.Reserve(nodeCount);
+            backwardOpenList.Clear();
+            backwardOpenList.Reserve(nodeCount);
+
+            forwardSlots.Touch(fromIndex, zero).g = 0.f;
+            forwardOpenList.Push(fromIndex, 0.f);
+            backwardSlots.Touch(toIndex, zero).g = 0.f;
+            backwardOpenList.Push(toIndex, 0.f);
+
+            float bestCost = std::numeric_limits<float>::max();
+            uint32_t meetIndex = npos;
+            bool forward = false;
+            while (true)
+            {
+                const bool forwardDone = forwardOpenList.Empty() || forwardOpenList.TopKey() >= bestCost;
+                const bool backwardDone = backwardOpenList.Empty() || backwardOpenList.TopKey() >= bestCost;
+                if (forwardDone && backwardDone)
+                    break;
+
+                forward = backwardDone || (!forwardDone && !forward);
+                const UpwardGraph& graph = forward ? m_up : m_down;
+                const UpwardGraph& stallGraph = forward ? m_down : m_up;
+                SearchSlotTable& slots = forward ? forwardSlots : backwardSlots;
+                SearchSlotTable& otherSlots = forward ? backwardSlots : forwardSlots;
+                const uint32_t selIndex = forward ? forwardOpenList.Pop() : backwardOpenList.Pop();
+                trace.OnExpand(selIndex);
+                const float selG = slots[selIndex].g;
+                if (otherSlots.IsTouched(selIndex) && selG + otherSlots[selIndex].g < bestCost)
+                {
+                    bestCost = selG + otherSlots[selIndex].g;
+                    meetIndex = selIndex;
+                }
+
+                if (IsStalled(stallGraph, slots, selIndex, selG))
+                    continue;
+
+                const uint32_t end = graph.offsets[selIndex + 1];
+                for (uint32_t i = graph.offsets[selIndex]; i != end; ++i)
+                {
+                    const Edge& edge = graph.edges[i];
+                    SearchSlot& node = slots.Touch(edge.target, zero);
+                    const float g = selG + edge.weight;
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    if (forward)
+                    {
+                        forwardOpenList.Push(edge.target, g);
+                    }
+                    else
+                    {
+                        backwardOpenList.Push(edge.target, g);
+                    }
+
+                    trace.OnRelax(edge.target, forwardOpenList.Size() + backwardOpenList.Size());
+                }
+            }
+
+            if (meetIndex == npos)
+                return trace.EndQuery(false);
+
+            if (cost != nullptr)
+            {
+                *cost = bestCost;
+            }
+
+            // 계층 그래프 위의 경로를 먼저 모은 뒤 간선마다 지름길을 푼다.
+            auto& chain = context.neighbors;
+            chain.clear();
+            for (uint32_t it = meetIndex; it != npos; it = forwardSlots[it].prev)
+            {
+                chain.push_back(it);
+            }
+
+            std::reverse(chain.begin(), chain.end());
+            for (uint32_t it = backwardSlots[meetIndex].prev; it != npos; it = backwardSlots[it].prev)
+            {
+                chain.push_back(it);
+            }
+
+            emit(chain.front());
+            for (size_t i = 1; i < chain.size(); ++i)
+            {
+                Unpack(chain[i - 1], chain[i], emit);
+            }
+
+            return trace.EndQuery(true);
+        }
+
+    private:
+        struct Edge
+        {
+            uint32_t target;
+            float weight;
+            // 지름길이면 축약된 가운데 노드, 원래 간선이면 npos
+            uint32_t middle;
+        };
+
+        struct Shortcut
+        {
+            uint32_t from;
+            uint32_t to;
+            float weight;
+        };
+
+        struct WitnessSearch
+        {
+            SearchSlotTable slots;
+            QuadHeapOpenList openList;
+        };
+
+        struct UpwardGraph
+        {
+            void Build(const std::vector<std::vector<Edge>>& edgeList)
+            {
+                offsets.assign(1, 0);
+                edges.clear();
+                for (auto& it : edgeList)
+                {
+                    edges.insert(edges.end(), it.begin(), it.end());
+                    offsets.push_back(static_cast<uint32_t>(edges.size()));
+                }
+            }
+
+            void Clear()
+            {
+                offsets.clear();
+                edges.clear();
+            }
+
+            std::vector<uint32_t> offsets;
+            std::vector<Edge> edges;
+        };
+
+        struct BuildState
+        {
+            // 아직 축약되지 않은 노드 사이의 간선
+            std::vector<std::vector<Edge>> outEdges;
+            std::vector<std::vector<Edge>> inEdges;
+            std::vector<uint32_t> deletedNeighbors;
+            // 축약이 끝난 노드에서 순위가 더 높은 노드로 가는 간선(upEdges)과
+            // 순위가 더 높은 노드에서 들어오는 간선(downEdges, target은 출발 노드)
+            std::vector<std::vector<Edge>> upEdges;
+            std::vector<std::vector<Edge>> downEdges;
+            WitnessSearch witness;
+        };
+
+        // witness 탐색에서 확정할 최대 노드 수. 넘으면 지름길을 보수적으로 추가한다.
+        static constexpr uint32_t witnessSettleLimit = 500;
+
+        // 같은 대상으로 가는 간선이 있으면 더 짧은 쪽만 남긴다. 새 간선이면 true.
+        static bool AddEdge(std::vector<Edge>* edgeList, const Edge& edge)
+        {
+            for (auto& it : *edgeList)
+            {
+                if (it.target != edge.target)
+                    continue;
+
+                if (edge.weight < it.weight)
+                {
+                    it = edge;
+                }
+
+                return false;
+            }
+
+            edgeList->push_back(edge);
+            return true;
+        }
+
+        static bool IsTarget(const std::vector<Edge>& edgeList, uint32_t target, uint32_t except)
+        {
+            if (target == except)
+                return false;
+
+            for (auto& it : edgeList)
+            {
+                if (it.target == target)
+                    return true;
+            }
+
+            return false;
+        }
+
+        static void RemoveEdge(std::vector<Edge>* edgeList, uint32_t target)
+        {
+            auto it = std::find_if(edgeList->begin(), edgeList->end(), [target](const Edge& edge) { return edge.target == target; });
+            if (it != edgeList->end())
+            {
+                *it = edgeList->back();
+                edgeList->pop_back();
+            }
+        }
+
+        // 우선순위 = 2 * edge difference + 삭제된 이웃 수.
+        // edge difference는 node를 축약할 때 필요한 지름길 수에서 없어지는 간선 수를 뺀 값이다.
+        static float ComputePriority(const BuildState& state, uint32_t node, WitnessSearch& witness, std::vector<Shortcut>* shortcuts)
+        {
+            const auto& inEdges = state.inEdges[node];
+            const auto& outEdges = state.outEdges[node];
+            int added = 0;
+            auto zero = [](uint32_t) { return 0.f; };
+            for (auto& in : inEdges)
+            {
+                float maxCost = 0.f;
+                uint32_t targetCount = 0;
+                for (auto& out : outEdges)
+                {
+                    if (out.target != in.target)
+                    {
+                        maxCost = std::max(maxCost, in.weight + out.weight);
+                        targetCount += 1;
+                    }
+                }
+
+                if (targetCount == 0)
+                    continue;
+
+                // node를 거치지 않는 in.target -> out.target 경로를 maxCost 이내에서 찾는다.
+                witness.slots.BeginQuery(state.outEdges.size());
+                witness.openList.Clear();
+                witness.slots.Touch(in.target, zero).g = 0.f;
+                witness.openList.Push(in.target, 0.f);
+                uint32_t settled = 0;
+                while (!witness.openList.Empty() && settled < witnessSettleLimit && targetCount != 0)
+                {
+                    const uint32_t selIndex = witness.openList.Pop();
+                    const float selG = witness.slots[selIndex].g;
+                    if (selG > maxCost)
+                        break;
+
+                    settled += 1;
+                    // 나가는 간선의 대상이 모두 확정되면 더 볼 필요가 없다.
+                    if (IsTarget(outEdges, selIndex, in.target))
+                    {
+                        targetCount -= 1;
+                    }
+
+                    for (auto& edge : state.outEdges[selIndex])
+                    {
+                        if (edge.target == node)
+                            continue;
+
+                        SearchSlot& slot = witness.slots.Touch(edge.target, zero);
+                        const float g = selG + edge.weight;
+                        if (slot.g <= g)
+                            continue;
+
+                        slot.g = g;
+                        witness.openList.Push(edge.target, g);
+                    }
+                }
+
+                for (auto& out : outEdges)
+                {
+                    if (out.target == in.target)
+                        continue;
+
+                    const float via = in.weight + out.weight;
+                    if (witness.slots.IsTouched(out.target) && witness.slots[out.target].g <= via)
+                        continue;
+
+                    added += 1;
+                    if (shortcuts != nullptr)
+                    {
+                        shortcuts->push_back(Shortcut{ in.target, out.target, via });
+                    }
+                }
+            }
+
+            const int removed = static_cast<int>(inEdges.size() + outEdges.size());
+            return static_cast<float>(2 * (added - removed)) + static_cast<float>(state.deletedNeighbors[node]);
+        }
+
+        void Contract(BuildState* state, uint32_t node, const std::vector<Shortcut>& shortcuts)
+        {
+            auto& outEdges = state->outEdges[node];
+            auto& inEdges = state->inEdges[node];
+            for (auto& it : outEdges)
+            {
+                state->upEdges[node].push_back(it);
+                RemoveEdge(&state->inEdges[it.target], node);
+                state->deletedNeighbors[it.target] += 1;
+            }
+
+            for (auto& it : inEdges)
+            {
+                state->downEdges[node].push_back(it);
+                RemoveEdge(&state->outEdges[it.target], node);
+                state->deletedNeighbors[it.target] += 1;
+            }
+
+            for (auto& it : shortcuts)
+            {
+                if (AddEdge(&state->outEdges[it.from], Edge{ it.to, it.weight, node }))
+                {
+                    m_statistics.shortcutCount += 1;
+                }
+
+                AddEdge(&state->inEdges[it.to], Edge{ it.from, it.weight, node });
+            }
+
+            std::vector<Edge>{}.swap(outEdges);
+            std::vector<Edge>{}.swap(inEdges);
+        }
+
+        // 순위가 더 높은 이웃을 거쳐 더 짧게 올 수 있으면 이 노드에서는 더 뻗어 나갈 필요가 없다(stall-on-demand).
+        static bool IsStalled(const UpwardGraph& stallGraph, const SearchSlotTable& slots, uint32_t index, float g)
+        {
+            const uint32_t end = stallGraph.offsets[index + 1];
+            for (uint32_t i = stallGraph.offsets[index]; i != end; ++i)
+            {
+                const Edge& edge = stallGraph.edges[i];
+                if (slots.IsTouched(edge.target) && slots[edge.target].g + edge.weight < g)
+                    return true;
+            }
+
+            return false;
+        }
+
+        const Edge* FindEdge(uint32_t from, uint32_t to) const
+        {
+            const UpwardGraph& graph = m_rank[from] < m_rank[to] ? m_up : m_down;
+            const uint32_t owner = m_rank[from] < m_rank[to] ? from : to;
+            const uint32_t target = m_rank[from] < m_rank[to] ? to : from;
+            const Edge* ret = nullptr;
+            for (uint32_t i = graph.offsets[owner]; i != graph.offsets[owner + 1]; ++i)
+            {
+                const Edge& edge = graph.edges[i];
+                if (edge.target == target && (ret == nullptr || edge.weight < ret->weight))
+                {
+                    ret = &edge;
+                }
+            }
+
+            return ret;
+        }
+
+        // from -> to 간선을 원래 간선들로 풀어서 from 다음 노드부터 to까지 emit한다.
+        template<typename TEmit>
+        void Unpack(uint32_t from, uint32_t to, TEmit& emit) const
+        {
+            const Edge* edge = FindEdge(from, to);
+            if (edge == nullptr || edge->middle == npos)
+            {
+                emit(to);
+                return;
+            }
+
+            Unpack(from, edge->middle, emit);
+            Unpack(edge->middle, to, emit);
+        }
+
+        std::vector<uint32_t> m_rank;
+        UpwardGraph m_up;
+        UpwardGraph m_down;
+        Statistics m_statistics;
+        bool m_built;
+    };
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASTAR_COORDINATE_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASTAR_COORDINATE_SSE 1
+#endif
+
+namespace astar
+{
+    enum class SimdLevel
+    {
+        Scalar,
+        Sse,
+        // /arch:AVX2(-mavx2)로 빌드했을 때만 쓸 수 있다.
+        Avx2,
+    };
+
+    // 노드 좌표를 x 배열과 y 배열로 나눠 저장한다(SoA).
+    // 여러 노드의 휴리스틱 값이나 여러 간선의 길이를 한 번에 SIMD로 계산한다.
+    // 빌드에 SSE/AVX2가 없으면 같은 결과를 스칼라 루프로 계산한다.
+    // 모든 경로가 뺄셈, 곱셈, 덧셈, 제곱근을 같은 순서로 한 번씩 반올림하므로 결과가 비트 단위로 같다.
+    // 단 컴파일러가 스칼라 경로의 곱셈과 덧셈을 FMA로 합치면 1 ulp까지 달라질 수 있어서
+    // GCC/Clang은 -ffp-contract=off로 빌드한다(CMakeLists.txt). MSVC는 /fp:contract를 주지 않으면 합치지 않는다.
+    class CoordinateStore
+    {
+    public:
+        CoordinateStore()
+            : m_simdLevel{ BestSimdLevel() }
+        {
+
+        }
+
+        static bool IsSupported(SimdLevel level)
+        {
+            switch (level)
+            {
+            case SimdLevel::Scalar:
+                return true;
+#if defined(ASTAR_COORDINATE_SSE)
+            case SimdLevel::Sse:
+                return true;
+#endif
+#if defined(ASTAR_COORDINATE_AVX2)
+            case SimdLevel::Avx2:
+                return true;
+#endif
+            default:
+                return false;
+            }
+        }
+
+        static SimdLevel BestSimdLevel()
+        {
+            if (IsSupported(SimdLevel::Avx2))
+                return SimdLevel::Avx2;
+
+            if (IsSupported(SimdLevel::Sse))
+                return SimdLevel::Sse;
+
+            return SimdLevel::Scalar;
+        }
+
+        // 스칼라 경로와 비교할 때 쓴다. 빌드에 없는 경로를 고르면 false를 돌려주고 바꾸지 않는다.
+        bool SetSimdLevel(SimdLevel level)
+        {
+            if (!IsSupported(level))
+                return false;
+
+            m_simdLevel = level;
+            return true;
+        }
+
+        SimdLevel GetSimdLevel() const { return m_simdLevel; }
+
+        size_t Size() const { return m_x.size(); }
+
+        void Resize(size_t count)
+        {
+            m_x.resize(count, 0.f);
+            m_y.resize(count, 0.f);
+        }
+
+        void Clear()
+        {
+            m_x.clear();
+            m_y.clear();
+        }
+
+        void Set(uint32_t index, float x, float y)
+        {
+            m_x[index] = x;
+            m_y[index] = y;
+        }
+
+        float GetX(uint32_t index) const { return m_x[index]; }
+
+        float GetY(uint32_t index) const { return m_y[index]; }
+
+        float Distance(uint32_t index, float x, float y) const
+        {
+            const float dx = m_x[index] - x;
+            const float dy = m_y[index] - y;
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        float Distance(uint32_t index1, uint32_t index2) const
+        {
+            return Distance(index1, m_x[index2], m_y[index2]);
+        }
+
+        // [first, first + count) 노드에서 (x, y)까지의 거리
+        void Distances(uint32_t first, size_t count, float x, float y, float* result) const
+        {
+            const float* xs = m_x.data() + first;
+            const float* ys = m_y.data() + first;
+            size_t i = 0;
+#if defined(ASTAR_COORDINATE_AVX2)
+            if (m_simdLevel == SimdLevel::Avx2)
+            {
+                const __m256 targetX = _mm256_set1_ps(x);
+                const __m256 targetY = _mm256_set1_ps(y);
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), targetX);
+                    const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), targetY);
+                    _mm256_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+#if defined(ASTAR_COORDINATE_SSE)
+            if (m_simdLevel != SimdLevel::Scalar)
+            {
+                const __m128 targetX = _mm_set1_ps(x);
+                const __m128 targetY = _mm_set1_ps(y);
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), targetX);
+                    const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), targetY);
+                    _mm_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                result[i] = Distance(first + static_cast<uint32_t>(i), x, y);
+            }
+        }
+
+        // indices[i] 노드에서 (x, y)까지의 거리. 펼친 노드의 이웃들의 휴리스틱을 한 번에 구할 때 쓴다.
+        void Distances(const uint32_t* indices, size_t count, float x, float y, float* result) const
+        {
+            size_t i = 0;
+#if defined(ASTAR_COORDINATE_AVX2)
+            if (m_simdLevel == SimdLevel::Avx2)
+            {
+                const __m256 targetX = _mm256_set1_ps(x);
+                const __m256 targetY = _mm256_set1_ps(y);
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+                    const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(m_x.data(), index, 4), targetX);
+                    const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(m_y.data(), index, 4), targetY);
+                    _mm256_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+#if defined(ASTAR_COORDINATE_SSE)
+            if (m_simdLevel != SimdLevel::Scalar)
+            {
+                const __m128 targetX = _mm_set1_ps(x);
+                const __m128 targetY = _mm_set1_ps(y);
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128 dx = _mm_sub_ps(Gather(m_x.data(), indices + i), targetX);
+                    const __m128 dy = _mm_sub_ps(Gather(m_y.data(), indices + i), targetY);
+                    _mm_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                result[i] = Distance(indices[i], x, y);
+            }
+        }
+
+        // from[i] 노드와 to[i] 노드 사이의 거리. 간선 길이를 한 번에 다시 계산할 때 쓴다.
+        void Distances(const uint32_t* from, const uint32_t* to, size_t count, float* result) const
+        {
+            size_t i = 0;
+#if defined(ASTAR_COORDINATE_AVX2)
+            if (m_simdLevel == SimdLevel::Avx2)
+            {
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256i fromIndex = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+                    const __m256i toIndex = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + i));
+                    const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(m_x.data(), fromIndex, 4), _mm256_i32gather_ps(m_x.data(), toIndex, 4));
+                    const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(m_y.data(), fromIndex, 4), _mm256_i32gather_ps(m_y.data(), toIndex, 4));
+                    _mm256_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+#if defined(ASTAR_COORDINATE_SSE)
+            if (m_simdLevel != SimdLevel::Scalar)
+            {
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128 dx = _mm_sub_ps(Gather(m_x.data(), from + i), Gather(m_x.data(), to + i));
+                    const __m128 dy = _mm_sub_ps(Gather(m_y.data(), from + i), Gather(m_y.data(), to + i));
+                    _mm_storeu_ps(result + i, Length(dx, dy));
+                }
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                result[i] = Distance(from[i], to[i]);
+            }
+        }
+
+    private:
+#if defined(ASTAR_COORDINATE_AVX2)
+        static __m256 Length(__m256 dx, __m256 dy)
+        {
+            return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        }
+#endif
+
+#if defined(ASTAR_COORDINATE_SSE)
+        static __m128 Length(__m128 dx, __m128 dy)
+        {
+            return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        }
+
+        static __m128 Gather(const float* base, const uint32_t* indices)
+        {
+            return _mm_set_ps(base[indices[3]], base[indices[2]], base[indices[1]], base[indices[0]]);
+        }
+#endif
+
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        SimdLevel m_simdLevel;
+    };
+}
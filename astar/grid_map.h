@@ -0,0 +1,519 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "open_list.h"
+#include "search_state.h"
+
+namespace astar
+{
+    // 장애물 여부만 있는 균일 격자 지도. 한 행을 64비트 단위로 묶어서 칸마다 1비트만 쓴다.
+    // 이웃은 8방향이고 대각선 이동은 양옆 두 칸이 모두 비어 있을 때만 허용한다(모서리 통과 금지).
+    // NodeId는 y * width + x + 1 이다. 0은 GenericPathFinder처럼 없는 노드로 남겨 둔다.
+    class GridMap
+    {
+    public:
+        using NodeId = size_t;
+
+        GridMap(uint32_t width, uint32_t height)
+            : m_width{ width }
+            , m_height{ height }
+            , m_wordsPerRow{ (width + 63) / 64 }
+            , m_version{ 0 }
+        {
+            m_blocked.assign(static_cast<size_t>(m_wordsPerRow) * height, 0);
+        }
+
+        uint32_t GetWidth() const { return m_width; }
+
+        uint32_t GetHeight() const { return m_height; }
+
+        // 장애물이 바뀔 때마다 증가한다.
+        uint64_t GetVersion() const { return m_version; }
+
+        bool IsWalkable(int x, int y) const
+        {
+            if (x < 0 || y < 0 || static_cast<uint32_t>(x) >= m_width || static_cast<uint32_t>(y) >= m_height)
+                return false;
+
+            const uint64_t word = m_blocked[static_cast<size_t>(y) * m_wordsPerRow + (static_cast<uint32_t>(x) >> 6)];
+            return (word & (1ull << (x & 63))) == 0;
+        }
+
+        void SetBlocked(uint32_t x, uint32_t y, bool blocked)
+        {
+            uint64_t& word = m_blocked[static_cast<size_t>(y) * m_wordsPerRow + (x >> 6)];
+            const uint64_t bit = 1ull << (x & 63);
+            word = blocked ? (word | bit) : (word & ~bit);
+            m_version += 1;
+        }
+
+        NodeId ToNodeId(uint32_t x, uint32_t y) const
+        {
+            return static_cast<NodeId>(y) * m_width + x + 1;
+        }
+
+        bool FromNodeId(NodeId nodeId, uint32_t* x, uint32_t* y) const
+        {
+            if (nodeId == 0 || nodeId > static_cast<NodeId>(m_width) * m_height)
+                return false;
+
+            *x = static_cast<uint32_t>((nodeId - 1) % m_width);
+            *y = static_cast<uint32_t>((nodeId - 1) / m_width);
+            return true;
+        }
+
+        // 대각선 이동이면 양옆 두 칸도 비어 있어야 한다.
+        bool CanMove(int x, int y, int dx, int dy) const
+        {
+            if (!IsWalkable(x + dx, y + dy))
+                return false;
+
+            return dx == 0 || dy == 0 || (IsWalkable(x + dx, y) && IsWalkable(x, y + dy));
+        }
+
+        // 명시적 그래프로 옮길 때 쓴다. func(fromNodeId, toNodeId, cost)를 가능한 이동마다 부른다.
+        template<typename TFunc>
+        void ForEachMove(TFunc&& func) const
+        {
+            for (uint32_t y = 0; y < m_height; ++y)
+            {
+                for (uint32_t x = 0; x < m_width; ++x)
+                {
+                    if (!IsWalkable(x, y))
+                        continue;
+
+                    for (int dir = 0; dir < 8; ++dir)
+                    {
+                        const int dx = directionX[dir];
+                        const int dy = directionY[dir];
+                        if (CanMove(x, y, dx, dy))
+                        {
+                            func(ToNodeId(x, y), ToNodeId(x + dx, y + dy), (dir & 1) != 0 ? diagonalCost : 1.f);
+                        }
+                    }
+                }
+            }
+        }
+
+        size_t GetMemoryUsage() const
+        {
+            return m_blocked.size() * sizeof(uint64_t);
+        }
+
+        // 짝수는 직선, 홀수는 대각선 방향
+        static constexpr int directionX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        static constexpr int directionY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+        static constexpr float diagonalCost = 1.41421356f;
+
+    private:
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_wordsPerRow;
+        uint64_t m_version;
+        std::vector<uint64_t> m_blocked;
+    };
+
+    // GridMap 위의 Jump Point Search.
+    // BuildJumpTable을 부르면 방향마다 다음 점프 지점까지의 거리를 미리 계산해 두고(JPS+) 질의에서 그 표를 쓴다.
+    // 지도가 바뀌면 표는 무시되고 다시 만들 때까지 일반 JPS로 동작한다.
+    class JumpPointSearch
+    {
+    public:
+        using NodeId = GridMap::NodeId;
+
+        explicit JumpPointSearch(const GridMap& map)
+            : m_map{ map }
+            , m_jumpTableVersion{ 0 }
+            , m_expandedCount{ 0 }
+        {
+
+        }
+
+        // 마지막 질의에서 열린 목록에서 꺼낸 점프 지점 수
+        size_t GetExpandedCount() const { return m_expandedCount; }
+
+        bool HasJumpTable() const
+        {
+            return !m_jumpTable.empty() && m_jumpTableVersion == m_map.GetVersion();
+        }
+
+        void ClearJumpTable()
+        {
+            std::vector<int32_t>{}.swap(m_jumpTable);
+        }
+
+        size_t GetMemoryUsage() const
+        {
+            return m_jumpTable.capacity() * sizeof(int32_t);
+        }
+
+        // 칸마다 8방향의 거리를 저장한다. 양수 d는 d칸 앞에 점프 지점이 있다는 뜻이고
+        // 0 이하의 -k는 점프 지점 없이 k칸 가서 막힌다는 뜻이다.
+        void BuildJumpTable()
+        {
+            const int width = static_cast<int>(m_map.GetWidth());
+            const int height = static_cast<int>(m_map.GetHeight());
+            m_jumpTable.assign(static_cast<size_t>(width) * height * 8, 0);
+            // 다음 칸의 값을 먼저 계산하도록 방향의 반대쪽부터 훑는다. 대각선은 직선 값을 쓰므로 나중에 한다.
+            for (int dir : { 0, 2, 4, 6, 1, 3, 5, 7 })
+            {
+                const int dx = GridMap::directionX[dir];
+                const int dy = GridMap::directionY[dir];
+                for (int j = 0; j < height; ++j)
+                {
+                    const int y = dy > 0 ? height - 1 - j : j;
+                    for (int i = 0; i < width; ++i)
+                    {
+                        const int x = dx > 0 ? width - 1 - i : i;
+                        if (!m_map.IsWalkable(x, y) || !m_map.CanMove(x, y, dx, dy))
+                            continue;
+
+                        const int nextX = x + dx;
+                        const int nextY = y + dy;
+                        const int32_t next = JumpDistance(nextX, nextY, dir);
+                        bool isJumpPoint;
+                        if ((dir & 1) == 0)
+                        {
+                            isJumpPoint = HasForcedNeighbor(nextX, nextY, dx, dy);
+                        }
+                        else
+                        {
+                            isJumpPoint = JumpDistance(nextX, nextY, DirectionOf(dx, 0)) > 0 || JumpDistance(nextX, nextY, DirectionOf(0, dy)) > 0;
+                        }
+
+                        m_jumpTable[TableIndex(x, y, dir)] = isJumpPoint ? 1 : (next > 0 ? next + 1 : next - 1);
+                    }
+                }
+            }
+
+            m_jumpTableVersion = m_map.GetVersion();
+        }
+
+        bool Navigate(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result)
+        {
+            return Navigate(fromNodeId, toNodeId, result, m_context);
+        }
+
+        // 경로는 출발점부터 도착점까지 모든 칸을 담는다.
+        template<typename TOpenList>
+        bool Navigate(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TOpenList>& context)
+        {
+            result->clear();
+            m_expandedCount = 0;
+            uint32_t fromX, fromY, toX, toY;
+            if (!m_map.FromNodeId(fromNodeId, &fromX, &fromY) || !m_map.FromNodeId(toNodeId, &toX, &toY))
+                return false;
+
+            if (!m_map.IsWalkable(fromX, fromY) || !m_map.IsWalkable(toX, toY))
+                return false;
+
+            const int width = static_cast<int>(m_map.GetWidth());
+            const uint32_t fromIndex = static_cast<uint32_t>(fromNodeId - 1);
+            const uint32_t toIndex = static_cast<uint32_t>(toNodeId - 1);
+            const int goalX = static_cast<int>(toX);
+            const int goalY = static_cast<int>(toY);
+            const bool useTable = HasJumpTable();
+            auto funcH = [width, goalX, goalY](uint32_t index)
+            {
+                return Octile(static_cast<int>(index % width) - goalX, static_cast<int>(index / width) - goalY);
+            };
+
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            const size_t cellCount = static_cast<size_t>(width) * m_map.GetHeight();
+            slots.BeginQuery(cellCount);
+            openList.Clear();
+            openList.Reserve(cellCount);
+            SearchSlot& from = slots.Touch(fromIndex, funcH);
+            from.g = 0.f;
+            openList.Push(fromIndex, from.h);
+            while (true)
+            {
+                if (openList.Empty())
+                    return false;
+
+                const uint32_t selIndex = openList.Pop();
+                m_expandedCount += 1;
+                if (selIndex == toIndex)
+                    break;
+
+                const int x = static_cast<int>(selIndex % width);
+                const int y = static_cast<int>(selIndex / width);
+                const float selG = slots[selIndex].g;
+                int parentDx = 0;
+                int parentDy = 0;
+                if (slots[selIndex].prev != SearchSlotTable::npos)
+                {
+                    const uint32_t prev = slots[selIndex].prev;
+                    parentDx = Sign(x - static_cast<int>(prev % width));
+                    parentDy = Sign(y - static_cast<int>(prev / width));
+                }
+
+                const uint8_t directions = PrunedDirections(x, y, parentDx, parentDy);
+                for (int dir = 0; dir < 8; ++dir)
+                {
+                    if ((directions & (1u << dir)) == 0)
+                        continue;
+
+                    int jumpX;
+                    int jumpY;
+                    const bool found = useTable
+                        ? JumpByTable(x, y, dir, goalX, goalY, &jumpX, &jumpY)
+                        : Jump(x + GridMap::directionX[dir], y + GridMap::directionY[dir], GridMap::directionX[dir], GridMap::directionY[dir], goalX, goalY, &jumpX, &jumpY);
+                    if (!found)
+                        continue;
+
+                    const uint32_t jumpIndex = static_cast<uint32_t>(jumpY * width + jumpX);
+                    SearchSlot& node = slots.Touch(jumpIndex, funcH);
+                    const float g = selG + Octile(jumpX - x, jumpY - y);
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    openList.Push(jumpIndex, g + node.h);
+                }
+            }
+
+            // 점프 지점 사이는 직선 또는 대각선 한 방향이므로 칸 단위로 채운다.
+            auto& jumpPoints = context.neighbors;
+            jumpPoints.clear();
+            for (uint32_t it = toIndex; it != SearchSlotTable::npos; it = slots[it].prev)
+            {
+                jumpPoints.push_back(it);
+            }
+
+            std::reverse(jumpPoints.begin(), jumpPoints.end());
+            result->push_back(fromNodeId);
+            for (size_t i = 1; i < jumpPoints.size(); ++i)
+            {
+                int x = static_cast<int>(jumpPoints[i - 1] % width);
+                int y = static_cast<int>(jumpPoints[i - 1] / width);
+                const int endX = static_cast<int>(jumpPoints[i] % width);
+                const int endY = static_cast<int>(jumpPoints[i] / width);
+                const int dx = Sign(endX - x);
+                const int dy = Sign(endY - y);
+                while (x != endX || y != endY)
+                {
+                    x += dx;
+                    y += dy;
+                    result->push_back(m_map.ToNodeId(x, y));
+                }
+            }
+
+            return true;
+        }
+
+        static float Octile(int dx, int dy)
+        {
+            dx = std::abs(dx);
+            dy = std::abs(dy);
+            return static_cast<float>(std::max(dx, dy) - std::min(dx, dy)) + GridMap::diagonalCost * static_cast<float>(std::min(dx, dy));
+        }
+
+    private:
+        static int Sign(int value)
+        {
+            return (value > 0) - (value < 0);
+        }
+
+        static int DirectionOf(int dx, int dy)
+        {
+            static constexpr int directions[9] = { 5, 6, 7, 4, 0, 0, 3, 2, 1 };
+            return directions[(dy + 1) * 3 + dx + 1];
+        }
+
+        size_t TableIndex(int x, int y, int dir) const
+        {
+            return (static_cast<size_t>(y) * m_map.GetWidth() + x) * 8 + dir;
+        }
+
+        int32_t JumpDistance(int x, int y, int dir) const
+        {
+            if (!m_map.IsWalkable(x, y))
+                return 0;
+
+            return m_jumpTable[TableIndex(x, y, dir)];
+        }
+
+        // 직선으로 (dx, dy) 방향으로 들어온 칸에 강제 이웃이 있는지 확인한다.
+        bool HasForcedNeighbor(int x, int y, int dx, int dy) const
+        {
+            if (dx != 0)
+                return (m_map.IsWalkable(x, y - 1) && !m_map.IsWalkable(x - dx, y - 1))
+                    || (m_map.IsWalkable(x, y + 1) && !m_map.IsWalkable(x - dx, y + 1));
+
+            return (m_map.IsWalkable(x - 1, y) && !m_map.IsWalkable(x - 1, y - dy))
+                || (m_map.IsWalkable(x + 1, y) && !m_map.IsWalkable(x + 1, y - dy));
+        }
+
+        // 부모에서 들어온 방향을 보고 더 볼 필요가 있는 방향만 남긴다. 비트 i가 방향 i이다.
+        uint8_t PrunedDirections(int x, int y, int dx, int dy) const
+        {
+            uint8_t ret = 0;
+            auto add = [&ret](int dirX, int dirY) { ret |= static_cast<uint8_t>(1u << DirectionOf(dirX, dirY)); };
+            if (dx == 0 && dy == 0)
+            {
+                for (int dir = 0; dir < 8; ++dir)
+                {
+                    if (m_map.CanMove(x, y, GridMap::directionX[dir], GridMap::directionY[dir]))
+                    {
+                        ret |= static_cast<uint8_t>(1u << dir);
+                    }
+                }
+
+                return ret;
+            }
+
+            if (dx != 0 && dy != 0)
+            {
+                const bool vertical = m_map.IsWalkable(x, y + dy);
+                const bool horizontal = m_map.IsWalkable(x + dx, y);
+                if (vertical)
+                    add(0, dy);
+
+                if (horizontal)
+                    add(dx, 0);
+
+                if (vertical && horizontal)
+                    add(dx, dy);
+
+                return ret;
+            }
+
+            if (dx != 0)
+            {
+                const bool next = m_map.IsWalkable(x + dx, y);
+                const bool top = m_map.IsWalkable(x, y + 1);
+                const bool bottom = m_map.IsWalkable(x, y - 1);
+                if (next)
+                {
+                    add(dx, 0);
+                    if (top)
+                        add(dx, 1);
+
+                    if (bottom)
+                        add(dx, -1);
+                }
+
+                if (top)
+                    add(0, 1);
+
+                if (bottom)
+                    add(0, -1);
+
+                return ret;
+            }
+
+            const bool next = m_map.IsWalkable(x, y + dy);
+            const bool right = m_map.IsWalkable(x + 1, y);
+            const bool left = m_map.IsWalkable(x - 1, y);
+            if (next)
+            {
+                add(0, dy);
+                if (right)
+                    add(1, dy);
+
+                if (left)
+                    add(-1, dy);
+            }
+
+            if (right)
+                add(1, 0);
+
+            if (left)
+                add(-1, 0);
+
+            return ret;
+        }
+
+        // (x, y)부터 (dx, dy) 방향으로 가면서 점프 지점을 찾는다. 대각선이면 칸마다 두 직선 방향을 먼저 본다.
+        bool Jump(int x, int y, int dx, int dy, int goalX, int goalY, int* jumpX, int* jumpY) const
+        {
+            while (true)
+            {
+                if (!m_map.IsWalkable(x, y))
+                    return false;
+
+                bool isJumpPoint = x == goalX && y == goalY;
+                if (!isJumpPoint)
+                {
+                    if (dx != 0 && dy != 0)
+                    {
+                        int unusedX;
+                        int unusedY;
+                        isJumpPoint = Jump(x + dx, y, dx, 0, goalX, goalY, &unusedX, &unusedY)
+                            || Jump(x, y + dy, 0, dy, goalX, goalY, &unusedX, &unusedY);
+                    }
+                    else
+                    {
+                        isJumpPoint = HasForcedNeighbor(x, y, dx, dy);
+                    }
+                }
+
+                if (isJumpPoint)
+                {
+                    *jumpX = x;
+                    *jumpY = y;
+                    return true;
+                }
+
+                if (!m_map.CanMove(x, y, dx, dy))
+                    return false;
+
+                x += dx;
+                y += dy;
+            }
+        }
+
+        // JPS+: 미리 계산한 거리로 점프한다. 도착점이 가는 길 위에 있거나 대각선으로 가다가
+        // 도착점과 같은 행/열에 닿을 수 있으면 그 칸을 대신 돌려준다.
+        bool JumpByTable(int x, int y, int dir, int goalX, int goalY, int* jumpX, int* jumpY) const
+        {
+            const int dx = GridMap::directionX[dir];
+            const int dy = GridMap::directionY[dir];
+            const int32_t distance = m_jumpTable[TableIndex(x, y, dir)];
+            const int reach = std::abs(distance);
+            if ((dir & 1) == 0)
+            {
+                const int toGoal = dx != 0 ? (goalX - x) * dx : (goalY - y) * dy;
+                const bool onLine = dx != 0 ? goalY == y : goalX == x;
+                if (onLine && toGoal > 0 && toGoal <= reach)
+                {
+                    *jumpX = goalX;
+                    *jumpY = goalY;
+                    return true;
+                }
+            }
+            else
+            {
+                const int toGoalX = (goalX - x) * dx;
+                const int toGoalY = (goalY - y) * dy;
+                const int steps = std::min(toGoalX, toGoalY);
+                if (steps > 0 && steps <= reach)
+                {
+                    *jumpX = x + dx * steps;
+                    *jumpY = y + dy * steps;
+                    return true;
+                }
+            }
+
+            if (distance <= 0)
+                return false;
+
+            *jumpX = x + dx * distance;
+            *jumpY = y + dy * distance;
+            return true;
+        }
+
+        const GridMap& m_map;
+        PathQueryContext<> m_context;
+        std::vector<int32_t> m_jumpTable;
+        uint64_t m_jumpTableVersion;
+        size_t m_expandedCount;
+    };
+}
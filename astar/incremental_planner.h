@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "adjacency.h"
+#include "open_list.h"
+
+namespace astar
+{
+    // LPA*(Lifelong Planning A*) 기반 증분 경로 탐색.
+    // 출발점과 도착점이 그대로인 동안 g/rhs 상태를 유지하고, 간선 비용이 바뀌면
+    // 그 간선의 도착 노드만 다시 계산해서 영향을 받는 부분만 고친다.
+    // 휴리스틱은 consistent해야 하고 도착점이 움직이면(휴리스틱 전체가 바뀌면) Reset해야 한다.
+    class IncrementalPlanner
+    {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        IncrementalPlanner()
+            : m_forward{ nullptr }
+            , m_backward{ nullptr }
+            , m_fromIndex{ npos }
+            , m_toIndex{ npos }
+            , m_expandedCount{ 0 }
+            , m_visitGeneration{ 0 }
+        {
+
+        }
+
+        bool IsActive() const { return m_fromIndex != npos; }
+
+        uint32_t GetFromIndex() const { return m_fromIndex; }
+
+        uint32_t GetToIndex() const { return m_toIndex; }
+
+        // 마지막 ComputeShortestPath에서 꺼낸 노드 수
+        size_t GetExpandedCount() const { return m_expandedCount; }
+
+        void Deactivate()
+        {
+            m_fromIndex = npos;
+            m_toIndex = npos;
+            m_openList.Clear();
+        }
+
+        // backward는 forward의 간선 방향을 뒤집은 인덱스이다. 두 인덱스는 Deactivate/Reset 전까지 살아 있어야 한다.
+        template<typename TFuncH>
+        void Reset(const CsrAdjacency& forward, const CsrAdjacency& backward, uint32_t fromIndex, uint32_t toIndex, TFuncH&& funcH)
+        {
+            const size_t rowCount = forward.RowCount();
+            m_forward = &forward;
+            m_backward = &backward;
+            m_fromIndex = fromIndex;
+            m_toIndex = toIndex;
+            m_g.assign(rowCount, infinity);
+            m_rhs.assign(rowCount, infinity);
+            m_openList.Clear();
+            m_openList.Reserve(rowCount);
+            m_rhs[fromIndex] = 0.f;
+            m_openList.Push(fromIndex, CalculateKey(fromIndex, funcH));
+        }
+
+        // index로 들어오는 간선의 비용이 바뀌었을 때 부른다.
+        template<typename TFuncH>
+        void UpdateVertex(uint32_t index, TFuncH&& funcH)
+        {
+            if (index != m_fromIndex)
+            {
+                float rhs = infinity;
+                const uint32_t end = m_backward->End(index);
+                for (uint32_t i = m_backward->Begin(index); i != end; ++i)
+                {
+                    rhs = std::min(rhs, m_g[m_backward->targets[i]] + m_backward->weights[i]);
+                }
+
+                m_rhs[index] = rhs;
+            }
+
+            if (m_g[index] != m_rhs[index])
+            {
+                m_openList.Push(index, CalculateKey(index, funcH));
+            }
+            else if (m_openList.Contains(index))
+            {
+                m_openList.Remove(index);
+            }
+        }
+
+        template<typename TFuncH>
+        bool ComputeShortestPath(TFuncH&& funcH)
+        {
+            m_expandedCount = 0;
+            while (!m_openList.Empty()
+                && (m_openList.TopKey() < CalculateKey(m_toIndex, funcH) || m_rhs[m_toIndex] != m_g[m_toIndex]))
+            {
+                const uint32_t selIndex = m_openList.Pop();
+                m_expandedCount += 1;
+                if (m_g[selIndex] > m_rhs[selIndex])
+                {
+                    m_g[selIndex] = m_rhs[selIndex];
+                }
+                else
+                {
+                    m_g[selIndex] = infinity;
+                    UpdateVertex(selIndex, funcH);
+                }
+
+                const uint32_t end = m_forward->End(selIndex);
+                for (uint32_t i = m_forward->Begin(selIndex); i != end; ++i)
+                {
+                    UpdateVertex(m_forward->targets[i], funcH);
+                }
+            }
+
+            return m_g[m_toIndex] != infinity;
+        }
+
+        // 도착점에서 g + 비용이 가장 작은 선행 노드를 따라 거슬러 올라간다. 출발점부터 순서대로 담는다.
+        // LPA*는 간선 비용이 양수라고 가정한다. 비용이 0인 간선으로 묶인 노드들은 서로의 g를 받쳐 주어서
+        // 비용이 오른 뒤에도 고쳐지지 않을 수 있으므로, 따라간 경로의 비용이 g와 다르면 실패로 돌려준다.
+        // 그러면 Reset부터 다시 해야 한다.
+        bool ExtractPath(std::vector<uint32_t>* result)
+        {
+            result->clear();
+            if (!IsActive() || m_g[m_toIndex] == infinity)
+                return false;
+
+            m_visited.resize(m_g.size(), 0);
+            m_visitGeneration += 1;
+            if (m_visitGeneration == 0)
+            {
+                std::fill(m_visited.begin(), m_visited.end(), 0);
+                m_visitGeneration = 1;
+            }
+
+            uint32_t it = m_toIndex;
+            float pathCost = 0.f;
+            m_visited[it] = m_visitGeneration;
+            result->push_back(it);
+            while (it != m_fromIndex)
+            {
+                uint32_t prev = npos;
+                float best = infinity;
+                float bestG = infinity;
+                float bestWeight = 0.f;
+                const uint32_t end = m_backward->End(it);
+                for (uint32_t i = m_backward->Begin(it); i != end; ++i)
+                {
+                    if (m_visited[m_backward->targets[i]] == m_visitGeneration)
+                        continue;
+
+                    const float g = m_g[m_backward->targets[i]];
+                    const float cost = g + m_backward->weights[i];
+                    if (cost < best || (cost == best && g < bestG))
+                    {
+                        best = cost;
+                        bestG = g;
+                        bestWeight = m_backward->weights[i];
+                        prev = m_backward->targets[i];
+                    }
+                }
+
+                if (prev == npos)
+                {
+                    result->clear();
+                    return false;
+                }
+
+                it = prev;
+                pathCost += bestWeight;
+                m_visited[it] = m_visitGeneration;
+                result->push_back(it);
+            }
+
+            const float goalCost = m_g[m_toIndex];
+            if (pathCost > goalCost + (goalCost + 1.f) * 1e-4f)
+            {
+                result->clear();
+                return false;
+            }
+
+            std::reverse(result->begin(), result->end());
+            return true;
+        }
+
+    private:
+        struct Key
+        {
+            float first;
+            float second;
+
+            bool operator<(const Key& rhs) const
+            {
+                return first < rhs.first || (first == rhs.first && second < rhs.second);
+            }
+        };
+
+        static constexpr float infinity = std::numeric_limits<float>::infinity();
+
+        template<typename TFuncH>
+        Key CalculateKey(uint32_t index, TFuncH&& funcH) const
+        {
+            const float g = std::min(m_g[index], m_rhs[index]);
+            return Key{ g + funcH(index), g };
+        }
+
+        const CsrAdjacency* m_forward;
+        const CsrAdjacency* m_backward;
+        uint32_t m_fromIndex;
+        uint32_t m_toIndex;
+        std::vector<float> m_g;
+        std::vector<float> m_rhs;
+        TQuadHeap<Key> m_openList;
+        size_t m_expandedCount;
+        std::vector<uint32_t> m_visited;
+        uint32_t m_visitGeneration;
+    };
+}
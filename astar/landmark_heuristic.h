@@ -0,0 +1,360 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+#include "adjacency.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "search_state.h"
+#include "thread_pool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ASTAR_LANDMARK_SSE 1
+#endif
+
+namespace astar
+{
+    enum class LandmarkSelection
+    {
+        // 이미 고른 랜드마크들에서 가장 먼 노드를 고른다.
+        Farthest,
+        // 임의의 루트에서 만든 최단 경로 트리에서 현재 하한이 가장 나쁜 가지를 따라 내려간 잎을 고른다.
+        Avoid,
+    };
+
+    // ALT(A*, Landmarks, Triangle inequality) 휴리스틱의 거리표.
+    // 랜드마크 L에 대해 d(L, t) - d(L, v)와 d(v, L) - d(t, L)은 모두 d(v, t)의 하한이다.
+    // 거리는 노드 한 줄에 랜드마크 수만큼 붙여 놓아서(node-major) 한 노드의 값을 SIMD로 한 번에 읽는다.
+    // 만든 뒤에 그래프나 간선 비용이 바뀌면 하한이 깨질 수 있으므로 다시 만들어야 한다.
+    class LandmarkTable
+    {
+    public:
+        // 도달할 수 없는 거리. 유한한 거리끼리 빼도 넘치지 않을 만큼만 크게 잡는다.
+        static constexpr float unreachable = 1e30f;
+
+        LandmarkTable()
+            : m_stride{ 0 }
+        {
+
+        }
+
+        // indexToNodeId[row]가 0인 행은 해제된 노드로 보고 건너뛴다.
+        // backward는 forward의 간선 방향을 뒤집은 인덱스이고 둘 다 weights가 채워져 있어야 한다.
+        static std::shared_ptr<const LandmarkTable> Build(const CsrAdjacency& forward, const CsrAdjacency& backward, const std::vector<size_t>& indexToNodeId,
+            uint32_t landmarkCount, LandmarkSelection selection, ThreadPool* pool = nullptr)
+        {
+            auto table = std::make_shared<LandmarkTable>();
+            const uint32_t rowCount = static_cast<uint32_t>(forward.RowCount());
+            for (uint32_t row = 0; row < rowCount; ++row)
+            {
+                if (indexToNodeId[row] != 0)
+                {
+                    table->m_rows.insert(indexToNodeId[row], row);
+                }
+            }
+
+            landmarkCount = std::min<uint32_t>(landmarkCount, static_cast<uint32_t>(table->m_rows.size()));
+            if (landmarkCount == 0)
+                return table;
+
+            table->SelectLandmarks(forward, indexToNodeId, landmarkCount, selection);
+            table->m_stride = (landmarkCount + 3) & ~3u;
+            table->m_fromLandmark.assign(static_cast<size_t>(rowCount) * table->m_stride, 0.f);
+            table->m_toLandmark.assign(static_cast<size_t>(rowCount) * table->m_stride, 0.f);
+
+            // 랜드마크마다 정방향(d(L, v))과 역방향(d(v, L)) Dijkstra를 따로 돌린다.
+            const unsigned workerCount = pool != nullptr ? pool->GetWorkerCount() : 1;
+            std::vector<DijkstraState> states(workerCount);
+            auto task = [&](unsigned workerIndex, size_t taskIndex)
+            {
+                const uint32_t k = static_cast<uint32_t>(taskIndex / 2);
+                const bool isForward = taskIndex % 2 == 0;
+                DijkstraState& state = states[workerIndex];
+                Dijkstra(isForward ? forward : backward, table->m_landmarks[k], &state, nullptr);
+                float* column = (isForward ? table->m_fromLandmark.data() : table->m_toLandmark.data()) + k;
+                for (uint32_t row = 0; row < rowCount; ++row)
+                {
+                    column[static_cast<size_t>(row) * table->m_stride] = state.slots.IsTouched(row) ? state.slots[row].g : unreachable;
+                }
+            };
+
+            if (pool != nullptr)
+            {
+                pool->ParallelFor(static_cast<size_t>(landmarkCount) * 2, task);
+            }
+            else
+            {
+                for (size_t i = 0; i < static_cast<size_t>(landmarkCount) * 2; ++i)
+                {
+                    task(0, i);
+                }
+            }
+
+            return table;
+        }
+
+        uint32_t GetLandmarkCount() const { return static_cast<uint32_t>(m_landmarks.size()); }
+
+        // 랜드마크의 노드 인덱스
+        const std::vector<uint32_t>& GetLandmarks() const { return m_landmarks; }
+
+        // 표를 만들 때 없던 노드는 하한 0을 돌려준다.
+        float LowerBound(size_t nodeId, size_t goalNodeId) const
+        {
+            auto it = m_rows.find(nodeId);
+            auto goalIt = m_rows.find(goalNodeId);
+            if (it == m_rows.end() || goalIt == m_rows.end() || m_stride == 0)
+                return 0.f;
+
+            return LowerBoundByRow(it->value, goalIt->value);
+        }
+
+        float LowerBoundByRow(uint32_t row, uint32_t goalRow) const
+        {
+            const float* fromV = m_fromLandmark.data() + static_cast<size_t>(row) * m_stride;
+            const float* fromT = m_fromLandmark.data() + static_cast<size_t>(goalRow) * m_stride;
+            const float* toV = m_toLandmark.data() + static_cast<size_t>(row) * m_stride;
+            const float* toT = m_toLandmark.data() + static_cast<size_t>(goalRow) * m_stride;
+#if defined(ASTAR_LANDMARK_SSE)
+            __m128 best = _mm_setzero_ps();
+            for (uint32_t k = 0; k < m_stride; k += 4)
+            {
+                const __m128 forwardBound = _mm_sub_ps(_mm_loadu_ps(fromT + k), _mm_loadu_ps(fromV + k));
+                const __m128 backwardBound = _mm_sub_ps(_mm_loadu_ps(toV + k), _mm_loadu_ps(toT + k));
+                best = _mm_max_ps(best, _mm_max_ps(forwardBound, backwardBound));
+            }
+
+            best = _mm_max_ps(best, _mm_movehl_ps(best, best));
+            best = _mm_max_ss(best, _mm_shuffle_ps(best, best, 1));
+            return _mm_cvtss_f32(best);
+#else
+            float best = 0.f;
+            for (uint32_t k = 0; k < m_stride; ++k)
+            {
+                best = std::max(best, std::max(fromT[k] - fromV[k], toV[k] - toT[k]));
+            }
+
+            return best;
+#endif
+        }
+
+    private:
+        struct DijkstraState
+        {
+            SearchSlotTable slots;
+            QuadHeapOpenList openList;
+        };
+
+        // source에서 닿는 모든 노드까지의 거리를 state.slots에 남긴다. order가 있으면 확정된 순서를 담는다.
+        static void Dijkstra(const CsrAdjacency& graph, uint32_t source, DijkstraState* state, std::vector<uint32_t>* order)
+        {
+            auto zero = [](uint32_t) { return 0.f; };
+            const size_t rowCount = graph.RowCount();
+            state->slots.BeginQuery(rowCount);
+            state->openList.Clear();
+            state->openList.Reserve(rowCount);
+            state->slots.Touch(source, zero).g = 0.f;
+            state->openList.Push(source, 0.f);
+            if (order != nullptr)
+            {
+                order->clear();
+            }
+
+            while (!state->openList.Empty())
+            {
+                const uint32_t selIndex = state->openList.Pop();
+                const float selG = state->slots[selIndex].g;
+                if (order != nullptr)
+                {
+                    order->push_back(selIndex);
+                }
+
+                const uint32_t end = graph.End(selIndex);
+                for (uint32_t i = graph.Begin(selIndex); i != end; ++i)
+                {
+                    SearchSlot& node = state->slots.Touch(graph.targets[i], zero);
+                    const float g = selG + graph.weights[i];
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    state->openList.Push(graph.targets[i], g);
+                }
+            }
+        }
+
+        // 고를 때는 정방향 거리만 쓴다.
+        void SelectLandmarks(const CsrAdjacency& forward, const std::vector<size_t>& indexToNodeId, uint32_t landmarkCount, LandmarkSelection selection)
+        {
+            const uint32_t rowCount = static_cast<uint32_t>(forward.RowCount());
+            std::vector<uint32_t> validRows;
+            for (uint32_t row = 0; row < rowCount; ++row)
+            {
+                if (indexToNodeId[row] != 0)
+                {
+                    validRows.push_back(row);
+                }
+            }
+
+            // 같은 그래프에서는 항상 같은 랜드마크가 나오도록 시드를 고정한다.
+            std::mt19937 random{ landmarkCount };
+            DijkstraState state;
+            std::vector<uint32_t> order;
+            std::vector<float> distances;
+            std::vector<uint8_t> isLandmark(rowCount, 0);
+            auto distance = [&](uint32_t k, uint32_t row) { return distances[static_cast<size_t>(k) * rowCount + row]; };
+            auto addLandmark = [&](uint32_t row)
+            {
+                m_landmarks.push_back(row);
+                isLandmark[row] = 1;
+                Dijkstra(forward, row, &state, nullptr);
+                for (uint32_t i = 0; i < rowCount; ++i)
+                {
+                    distances.push_back(state.slots.IsTouched(i) ? state.slots[i].g : unreachable);
+                }
+            };
+
+            // 가장 먼 노드: 아직 어느 랜드마크에서도 닿지 않는 노드가 있으면 그쪽이 먼저 뽑힌다.
+            auto farthest = [&]()
+            {
+                uint32_t ret = validRows.front();
+                float retDistance = -1.f;
+                for (auto row : validRows)
+                {
+                    if (isLandmark[row] != 0)
+                        continue;
+
+                    float minDistance = unreachable;
+                    for (uint32_t k = 0; k < m_landmarks.size(); ++k)
+                    {
+                        minDistance = std::min(minDistance, distance(k, row));
+                    }
+
+                    if (minDistance > retDistance)
+                    {
+                        ret = row;
+                        retDistance = minDistance;
+                    }
+                }
+
+                return ret;
+            };
+
+            {
+                // 첫 랜드마크는 임의의 노드에서 가장 먼 노드
+                const uint32_t start = validRows[random() % validRows.size()];
+                Dijkstra(forward, start, &state, &order);
+                addLandmark(order.back());
+            }
+
+            std::vector<float> size(rowCount);
+            std::vector<uint8_t> covered(rowCount);
+            std::vector<uint32_t> bestChild(rowCount);
+            while (m_landmarks.size() < landmarkCount)
+            {
+                if (selection == LandmarkSelection::Farthest)
+                {
+                    addLandmark(farthest());
+                    continue;
+                }
+
+                const uint32_t root = validRows[random() % validRows.size()];
+                Dijkstra(forward, root, &state, &order);
+                // 잎에서부터 올라가며 부분 트리의 무게를 더한다. 무게는 (실제 거리 - 현재 하한)이고
+                // 랜드마크가 들어 있는 부분 트리는 이미 잘 덮였으므로 0으로 둔다.
+                for (auto row : order)
+                {
+                    size[row] = 0.f;
+                    covered[row] = isLandmark[row];
+                    bestChild[row] = SearchSlotTable::npos;
+                }
+
+                for (size_t i = order.size(); i-- > 0;)
+                {
+                    const uint32_t row = order[i];
+                    float lowerBound = 0.f;
+                    for (uint32_t k = 0; k < m_landmarks.size(); ++k)
+                    {
+                        if (distance(k, root) != unreachable && distance(k, row) != unreachable)
+                        {
+                            lowerBound = std::max(lowerBound, distance(k, row) - distance(k, root));
+                        }
+                    }
+
+                    size[row] = covered[row] != 0 ? 0.f : size[row] + std::max(0.f, state.slots[row].g - lowerBound);
+                    const uint32_t parent = state.slots[row].prev;
+                    if (parent == SearchSlotTable::npos)
+                        continue;
+
+                    if (covered[row] != 0)
+                    {
+                        covered[parent] = 1;
+                    }
+
+                    size[parent] += size[row];
+                    if (bestChild[parent] == SearchSlotTable::npos || size[row] > size[bestChild[parent]])
+                    {
+                        bestChild[parent] = row;
+                    }
+                }
+
+                uint32_t leaf = root;
+                while (bestChild[leaf] != SearchSlotTable::npos && size[bestChild[leaf]] > 0.f)
+                {
+                    leaf = bestChild[leaf];
+                }
+
+                addLandmark(isLandmark[leaf] == 0 && leaf != root ? leaf : farthest());
+            }
+        }
+
+        // NodeId -> 행 번호
+        NodeIdMap<uint32_t> m_rows;
+        std::vector<uint32_t> m_landmarks;
+        // 한 행에 들어가는 값 수. 랜드마크 수를 4의 배수로 올린 값이고 남는 칸은 0이다.
+        uint32_t m_stride;
+        std::vector<float> m_fromLandmark;
+        std::vector<float> m_toLandmark;
+    };
+
+    // TGenericPathFinder의 TFuncterH로 쓰는 ALT 휴리스틱.
+    // 표가 없으면 0을 돌려주므로 Dijkstra처럼 동작한다.
+    class LandmarkHeuristic
+    {
+    public:
+        LandmarkHeuristic() = default;
+
+        explicit LandmarkHeuristic(std::shared_ptr<const LandmarkTable> table)
+            : m_table{ std::move(table) }
+        {
+
+        }
+
+        void SetTable(std::shared_ptr<const LandmarkTable> table)
+        {
+            m_table = std::move(table);
+        }
+
+        const std::shared_ptr<const LandmarkTable>& GetTable() const
+        {
+            return m_table;
+        }
+
+        float operator()(size_t nodeId, size_t goalNodeId) const
+        {
+            if (m_table == nullptr)
+                return 0.f;
+
+            return m_table->LowerBound(nodeId, goalNodeId);
+        }
+
+    private:
+        std::shared_ptr<const LandmarkTable> m_table;
+    };
+}
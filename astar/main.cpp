@@ -1,4 +1,22 @@
 #include "prec.h"
+#include "adjacency.h"
+#include "binary_map.h"
+#include "contraction_hierarchy.h"
+#include "coordinate_store.h"
+#include "grid_map.h"
+#include "incremental_planner.h"
+#include "landmark_heuristic.h"
+#include "map.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "path_cache.h"
+#include "path_finder.h"
+#include "path_query_service.h"
+#include "search_state.h"
+#include "search_trace.h"
+#include "spatial_index.h"
+#include "thread_pool.h"
+#include "xml_map_reader.h"
 
 using namespace DirectX;
 
@@ -20,732 +38,12 @@ public:
     }
 };
 
-
-namespace astar
-{
-    struct Node;
-    struct Link
-    {
-        float depth;
-        Node* a;
-        Node* b;
-    };
-
-    struct Node
-    {
-        float x;
-        float y;
-    };
-
-    template<typename T>
-    struct Ref
-    {
-        Ref(T& t) : ref{ t } {}
-
-        bool operator == (const T& rhs) const
-        {
-            return ref == rhs;
-        }
-
-        bool operator == (const Ref& rhs) const
-        {
-            return ref == rhs.ref;
-        }
-
-        bool operator != (const T& rhs) const
-        {
-            return ref != rhs;
-        }
-
-        bool operator != (const Ref& rhs) const
-        {
-            return ref != rhs.ref;
-        }
-
-        T* operator->() { return &ref; }
-
-        operator T& () const
-        {
-            return ref;
-        }
-
-        T& ref;
-    };
-
-
-    struct NodeIdSet
-    {
-        struct Seek
-        {
-            Seek* prev;
-            Seek* next;
-            size_t budgetIndex;
-        };
-
-        struct Node : Seek
-        {
-            size_t key;
-        };
-
-        struct Iter
-        {
-            const Seek* seek;
-            Iter& operator ++ ()
-            {
-                seek = seek->next;
-                return *this;
-            }
-
-            Iter operator ++ (int)
-            {
-                Iter tmp{ seek };
-                seek = seek->next;
-                return tmp;
-            }
-
-            size_t operator*() const
-            {
-                return static_cast<const Node*>(seek)->key;
-            }
-
-            bool operator==(const Iter& it) const { return seek == it.seek; }
-
-            bool operator!=(const Iter& it) const { return seek != it.seek; }
-        };
-
-        NodeIdSet()
-            : dummyHead()
-            , dummyTail()
-            , pool()
-            , idleNode()
-            , budget()
-        {
-            dummyHead.next = &dummyTail;
-            dummyTail.prev = &dummyHead;
-            dummyTail.budgetIndex = std::numeric_limits<size_t>::max();
-            for (auto& it : budget)
-            {
-                it = &dummyTail;
-            }
-
-            Node* next = nullptr;
-            for (auto& it : pool)
-            {
-                it.next = next;
-                next = &it;
-            }
-
-            idleNode = next;
-        }
-
-        size_t count(size_t value) const
-        {
-            return find(value) != end() ? 1 : 0;
-        }
-
-        Iter erase(Iter iter)
-        {
-            if (iter == end())
-                return iter;
-
-            Node* item = const_cast<Node*>(static_cast<const Node*>(iter.seek));
-            Seek* prev = item->prev;
-            Seek* next = item->next;
-            prev->next = next;
-            next->prev = prev;
-            item->next = idleNode;
-            idleNode = static_cast<Node*>(item);
-            if (budget[item->budgetIndex] == item)
-            {
-                budget[item->budgetIndex] = item->next;
-            }
-
-            return Iter{ next };
-        }
-
-        void erase(size_t key)
-        {
-            const size_t budgetIndex = key % 97;
-            Seek* it = budget[budgetIndex];
-            Seek* item = nullptr;
-            while (it->budgetIndex == budgetIndex)
-            {
-                auto node = static_cast<Node*>(it);
-                if (node->key == key) {
-                    item = node;
-                    break;
-                }
-
-                it = it->next;
-            }
-
-            if (item != nullptr)
-            {
-                Seek* prev = item->prev;
-                Seek* next = item->next;
-                prev->next = next;
-                next->prev = prev;
-                item->next = idleNode;
-                idleNode = static_cast<Node*>(item);
-                if (budget[budgetIndex] == item)
-                {
-                    budget[budgetIndex] = item->next;
-                }
-            }
-        }
-
-        void insert(size_t key)
-        {
-            const size_t budgetIndex = key % 97;
-            Seek* it = budget[budgetIndex];
-            while (it->budgetIndex == budgetIndex)
-            {
-                auto node = static_cast<Node*>(it);
-                if (node->key == key) {
-                    // Կ ߴ.
-                    return;
-                }
-
-                it = it->next;
-            }
-
-
-            Node* newitem = idleNode;
-            if (newitem == nullptr)
-                return;
-
-            idleNode = static_cast<Node*>(newitem->next);
-            newitem->key = key;
-            newitem->budgetIndex = budgetIndex;
-
-            Seek* prev = it->prev;
-            newitem->prev = prev;
-            prev->next = newitem;
-            newitem->next = it;
-            it->prev = newitem;
-            if (budget[budgetIndex]->budgetIndex != budgetIndex)
-            {
-                budget[budgetIndex] = newitem;
-            }
-        }
-
-        Iter find(size_t key) const
-        {
-            size_t budgetIndex = key % 97;
-            Seek* it = budget[budgetIndex];
-            while (it->budgetIndex == budgetIndex)
-            {
-                Node& node = static_cast<Node&>(*it);
-                if (node.key == key) {
-                    return Iter{ &node };
-                }
-
-                it = it->next;
-            }
-
-            return end();
-        }
-
-        Iter begin() const { return Iter{ dummyHead.next }; }
-
-        Iter end() const { return Iter{ &dummyTail }; }
-
-        Seek dummyHead;
-        Seek dummyTail;
-        Seek* budget[97];
-        Node* idleNode;
-        Node pool[4096];
-    };
-
-    struct GenericPathFinder
-    {
-        struct NavigatedNode
-        {
-            size_t nodeId;
-            NavigatedNode* prevNode;
-            float g;
-            float h;
-            bool operator == (size_t rhs) const
-            {
-                return nodeId == rhs;
-            }
-
-            bool operator != (size_t rhs) const
-            {
-                return nodeId != rhs;
-            }
-
-            bool operator == (const NavigatedNode& rhs) const
-            {
-                return nodeId == rhs.nodeId;
-            }
-
-            bool operator != (const NavigatedNode& rhs) const
-            {
-                return nodeId != rhs.nodeId;
-            }
-        };
-
-        struct NavigatedNodeRef
-        {
-            NavigatedNodeRef(NavigatedNode& t) : ref{ t } {}
-
-            bool operator == (const NavigatedNode& rhs) const
-            {
-                return ref == rhs;
-            }
-
-            bool operator == (const NavigatedNodeRef& rhs) const
-            {
-                return ref == rhs.ref;
-            }
-
-            bool operator != (const NavigatedNode& rhs) const
-            {
-                return ref != rhs;
-            }
-
-            bool operator != (const NavigatedNodeRef& rhs) const
-            {
-                return ref != rhs.ref;
-            }
-
-            NavigatedNode* operator->() { return &ref; }
-
-            operator NavigatedNode& () const
-            {
-                return ref;
-            }
-
-            NavigatedNode& ref;
-        };
-
-        using NodeId = size_t;
-        struct Link
-        {
-            NodeId toNodeId;
-            NodeId fromNodeId;
-        };
-
-        GenericPathFinder()
-            : m_latestNodeId{ 0 }
-        {
-
-        }
-
-        ~GenericPathFinder()
-        {
-            for (auto it : m_linkList)
-            {
-                delete it;
-            }
-        }
-
-        NodeId AllocNodeId()
-        {
-            NodeId newNodeId = m_latestNodeId += 1;
-            m_nodeSet.insert(newNodeId);
-            return newNodeId;
-        }
-
-        NodeId AllocNodeId(NodeId id)
-        {
-            if (m_nodeSet.count(id) != 0)
-                return 0;
-
-            m_nodeSet.insert(id);
-            m_latestNodeId = std::max(m_latestNodeId, id);
-            return id;
-        }
-
-        Link* MakeLink(NodeId toNodeId, NodeId fromNodeId)
-        {
-            if (m_nodeSet.count(toNodeId) == 0 || m_nodeSet.count(fromNodeId) == 0)
-                return nullptr;
-
-            for (auto it : m_linkList)
-            {
-                if (it->toNodeId != toNodeId || it->fromNodeId != fromNodeId)
-                    continue;
-
-                return nullptr;
-            }
-
-            auto link = new Link{};
-            link->toNodeId = toNodeId;
-            link->fromNodeId = fromNodeId;
-
-            m_linkList.push_back(link);
-            return link;
-        }
-
-        void FreeNode(NodeId nodeId)
-        {
-            auto itSet = m_nodeSet.find(nodeId);
-            if (itSet == m_nodeSet.end())
-                return;
-
-            m_nodeSet.erase(itSet);
-            auto it = m_linkList.begin();
-            while (it != m_linkList.end())
-            {
-                auto link = *it;
-                if (link->toNodeId != nodeId && link->fromNodeId != nodeId)
-                {
-                    ++it;
-                    continue;
-                }
-
-                it = m_linkList.erase(it);
-                delete link;
-            }
-        }
-
-        void RemoveLink(Link* link)
-        {
-            auto it = std::find(m_linkList.begin(), m_linkList.end(), link);
-            if (it == m_linkList.end())
-                return;
-
-            delete link;
-            m_linkList.erase(it);
-        }
-
-        std::vector<std::pair<NavigatedNodeRef, Link*>>
-            CollectLinkedNode(NavigatedNode& srcNode, std::vector<NavigatedNode>& navNode)
-        {
-            std::vector<std::pair<NavigatedNodeRef, Link*>> ret;
-            for (auto it : m_linkList)
-            {
-                if (srcNode != it->fromNodeId)
-                    continue;
-
-                ret.emplace_back(*std::find(navNode.begin(), navNode.end(), it->toNodeId), it);
-            }
-
-            return ret;
-        }
-
-        size_t m_latestNodeId;
-        NodeIdSet m_nodeSet;
-        std::vector<Link*> m_linkList;
-    };
-
-    template<typename TFuncterG, typename TFuncterH>
-    class TGenericPathFinder: public GenericPathFinder
-    {
-    public:
-        template<typename ArgFuncterG, typename ArgFuncterH>
-        TGenericPathFinder(ArgFuncterG&& g, ArgFuncterH&& h)
-            : m_functerG{std::forward<ArgFuncterG>(g)}
-            , m_functerH{std::forward<ArgFuncterH>(h)}
-        {
-
-        }
-
-        bool Navigate(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result)
-        {
-            if (fromNodeId == toNodeId)
-                return true;
-
-            std::vector<NavigatedNode> nodeList;
-            std::list<NavigatedNodeRef> navigatedNodeList;
-            static constexpr float initial_max_g = std::numeric_limits<float>::max();
-            for (auto nodeId : m_nodeSet)
-            {
-                NavigatedNode node{};
-                node.nodeId = nodeId;
-                node.h = m_functerH(nodeId, toNodeId);
-                node.g = initial_max_g;
-                node.prevNode = nullptr;
-                nodeList.push_back(node);
-            }
-
-            NavigatedNodeRef navNodeFrom = *std::find(nodeList.begin(), nodeList.end(), fromNodeId);
-            NavigatedNodeRef navNodeTo = *std::find(nodeList.begin(), nodeList.end(), toNodeId);
-            navNodeFrom->g = 0.f;
-            navigatedNodeList.push_back(navNodeFrom);
-            do {
-                if (navigatedNodeList.empty())
-                    return false;
-
-                auto sel = navigatedNodeList.front();
-                navigatedNodeList.pop_front();
-                if (sel == navNodeTo)
-                    break;
-
-                auto nearNodeList = CollectLinkedNode(sel, nodeList);
-                for (auto tuple : nearNodeList)
-                {
-                    auto node = std::get<0>(tuple);
-                    auto link = std::get<1>(tuple);
-                    if (node->prevNode == &sel.ref)
-                        continue;
-
-                    float g = m_functerG(sel->nodeId, node->nodeId, link);
-                    if (node->g <= g + sel->g)
-                        continue;
-
-                    node->g = g + sel->g;
-                    node->prevNode = &sel.ref;
-                    auto it = std::find(navigatedNodeList.begin(), navigatedNodeList.end(), node);
-                    if (it != navigatedNodeList.end())
-                    {
-                        //   
-                        it = navigatedNodeList.erase(it);
-                    }
-
-                    auto end = navigatedNodeList.end();
-                    it = navigatedNodeList.begin();
-
-                    for (; it != end; ++it)
-                    {
-                        auto& rhs = *it;
-                        if (node->g + node->h >= rhs->g + rhs->h)
-                            continue;
-
-                        navigatedNodeList.insert(it, node);
-                        break;
-                    }
-
-                    if (it == end)
-                    {
-                        navigatedNodeList.push_back(node);
-                    }
-                }
-            } while (true);
-
-            result->clear();
-            {
-                NavigatedNode* it = &navNodeTo.ref;
-                while (it != nullptr)
-                {
-                    result->push_back(it->nodeId);
-                    it = it->prevNode;
-                }
-
-                std::reverse(result->begin(), result->end());
-            }
-
-            return true;
-        }
-
-    private:
-        TFuncterG m_functerG;
-        TFuncterH m_functerH;
-    };
-
-    template<typename G, typename H>
-    TGenericPathFinder<G, H> CreateGenericPathFinder(G&& g, H&& h)
-    {
-        return TGenericPathFinder<G, H>{std::forward<G>(g), std::forward<h>(h)};
-    }
-
-    class Map
-    {
-    public:
-        struct NavigatedNode
-        {
-            Node* node;
-            NavigatedNode* prevNode;
-            float g;
-            float h;
-            bool operator == (Node* rhs) const
-            {
-                return node == rhs;
-            }
-
-            operator Node* () const
-            {
-                return node;
-            }
-        };
-
-        ~Map()
-        {
-            for (auto it : m_nodeList)
-            {
-                delete it;
-            }
-
-            for (auto it : m_linkList)
-            {
-                delete it;
-            }
-        }
-
-        Node* AddNode(float x, float y)
-        {
-            auto ptr = new Node{};
-            ptr->x = x;
-            ptr->y = y;
-            m_nodeList.push_back(ptr);
-            return ptr;
-        }
-
-        void UpdateLength()
-        {
-            for (auto it : m_linkList)
-            {
-                it->depth = Length(it->a, it->b);
-            }
-        }
-
-        Link* MakeLink(Node* node1, Node* node2)
-        {
-            for (auto it : m_linkList)
-            {
-                if (it->a != node1 && it->b != node1)
-                    continue;
-
-                if (it->a != node2 && it->b != node2)
-                    continue;
-
-                return nullptr;
-            }
-
-            auto link = new Link{};
-            link->a = node1;
-            link->b = node2;
-            link->depth = Length(node1, node2);
-
-            m_linkList.push_back(link);
-            return link;
-        }
-
-        void RemoveLink(Link* link)
-        {
-
-        }
-        
-        void RemoveNode(Node* node)
-        {
-
-        }
-
-        bool Navigate(Node* from, Node* to, std::vector<Node*>* result)
-        {
-            if (from == to)
-                return true;
-
-            std::vector<NavigatedNode> nodeList;
-            std::list<Ref<NavigatedNode>> navigatedNodeList;
-
-            for (auto it : m_nodeList)
-            {
-                NavigatedNode node{};
-                node.node = it;
-                node.h = Length(it, to);
-                node.g = std::numeric_limits<float>::max();
-                node.prevNode = nullptr;
-                nodeList.push_back(node);
-            }
-
-            Ref<NavigatedNode> navNodeFrom = *std::find(nodeList.begin(), nodeList.end(), from);
-            Ref<NavigatedNode> navNodeTo = *std::find(nodeList.begin(), nodeList.end(), to);
-            navNodeFrom->g = 0.f;
-            navigatedNodeList.push_back(navNodeFrom);
-            do {
-                if (navigatedNodeList.empty())
-                    return false;
-
-                auto sel = navigatedNodeList.front();
-                navigatedNodeList.pop_front();
-                if (sel == navNodeTo)
-                    break;
-
-                auto nearNodeList = CollectLinkedNode(sel, nodeList);
-                for (auto node : nearNodeList)
-                {
-                    if (node->prevNode == &sel.ref)
-                        continue;
-
-                    float g = Length(node->node, sel->node);
-                    if (node->g <= g + sel->g)
-                        continue;
-
-                    node->g = g + sel->g;
-                    node->prevNode = &sel.ref;
-                    auto it = std::find(navigatedNodeList.begin(), navigatedNodeList.end(), node);
-                    if (it != navigatedNodeList.end())
-                    {
-                        //   
-                        it = navigatedNodeList.erase(it);
-                    }
-
-                    auto end = navigatedNodeList.end();
-                    it = navigatedNodeList.begin();
-                    
-                    for (; it != end; ++it)
-                    {
-                        auto& rhs = *it;
-                        if (node->g + node->h >= rhs->g + rhs->h)
-                            continue;
-
-                        navigatedNodeList.insert(it, node);
-                        break;
-                    }
-
-                    if (it == end)
-                    {
-                        navigatedNodeList.push_back(node);
-                    }
-                }
-            } while (true);
-            
-            result->clear();
-            {
-                NavigatedNode* it = &navNodeTo.ref;
-                while (it != nullptr)
-                {
-                    result->push_back(it->node);
-                    it = it->prevNode;
-                }
-
-                std::reverse(result->begin(), result->end());
-            }
-
-            return true;
-        }
-
-    private:
-        static float Length(Node* node1, Node* node2)
-        {
-            float dx = node1->x - node2->x;
-            float dy = node1->y - node2->y;
-            return std::sqrt(std::pow(dx, 2) + std::pow(dy, 2));
-        }
-
-        std::vector<Ref<NavigatedNode>> CollectLinkedNode(Ref<NavigatedNode> node, std::vector<NavigatedNode>& navNode)
-        {
-            std::vector<Ref<NavigatedNode>> ret;
-            for (auto it : m_linkList)
-            {
-                if (it->a == node.ref.node)
-                {
-                    ret.push_back(*std::find(navNode.begin(), navNode.end(), it->b));
-                }
-                else if (it->b == node.ref.node)
-                {
-                    ret.push_back(*std::find(navNode.begin(), navNode.end(), it->a));
-                }
-            }
-
-            return ret;
-        }
-
-    private:
-        std::vector<Node*> m_nodeList;
-        std::vector<Link*> m_linkList;
-    };
-
-}
-
 enum {
     ID_ADD_NODE = wxID_HIGHEST + 1,
     ID_ADD_LINK,
     ID_MOVE_NODE,
-    ID_FIND_PATH
+    ID_FIND_PATH,
+    ID_SHOW_SEARCH
 };
 
 class AStarFrame : public AStarFrameUi
@@ -753,14 +51,15 @@ class AStarFrame : public AStarFrameUi
 public:
     AStarFrame(wxWindow* win, wxWindowID id, const wxString& title)
         : AStarFrameUi(win, id, title)
+        , m_selectedNode{ astar::Map::npos }
         , m_selectedToolId{ ID_MOVE_NODE } {
         Bind(wxEVT_CONTEXT_MENU, [this](wxContextMenuEvent& evt)
             {
                 wxMenu menu;
-                menu.Append(ID_ADD_NODE, wxS(" ߰"));
-                menu.AppendRadioItem(ID_ADD_LINK, wxS(" "));
-                menu.AppendRadioItem(ID_MOVE_NODE, wxS(" ̵"));
-                menu.AppendRadioItem(ID_FIND_PATH, wxS(" ã"));
+                menu.Append(ID_ADD_NODE, wxS("노드 추가"));
+                menu.AppendRadioItem(ID_ADD_LINK, wxS("노드 연결"));
+                menu.AppendRadioItem(ID_MOVE_NODE, wxS("노드 이동"));
+                menu.AppendRadioItem(ID_FIND_PATH, wxS("길 찾기"));
                 menu.Check(m_selectedToolId, true);
             PopupMenu(&menu);
         });
@@ -770,27 +69,26 @@ public:
             auto size = GetClientSize();
             size /= 2;
             wxPoint pt{ size.x, size.y };
-            auto node = m_map.AddNode(pt.x, pt.y);
-            m_nodeList.push_back(node);
+            m_map.AddNode(pt.x, pt.y);
             Refresh();
             m_selectedToolId = ID_MOVE_NODE;
         }, ID_ADD_NODE);
 
         Bind(wxEVT_MENU, [this](wxCommandEvent& evt)
             {
-                m_selectedNode = nullptr;
+                m_selectedNode = astar::Map::npos;
                 m_selectedToolId = ID_ADD_LINK;
             }, ID_ADD_LINK);
 
         Bind(wxEVT_MENU, [this](wxCommandEvent& evt)
             {
-                m_selectedNode = nullptr;
+                m_selectedNode = astar::Map::npos;
                 m_selectedToolId = ID_MOVE_NODE;
             }, ID_MOVE_NODE);
 
         Bind(wxEVT_MENU, [this](wxCommandEvent& evt)
             {
-                m_selectedNode = nullptr;
+                m_selectedNode = astar::Map::npos;
                 m_selectedToolId = ID_FIND_PATH;
             }, ID_FIND_PATH);
 
@@ -801,56 +99,52 @@ public:
                 Refresh();
                 m_basePosition = evt.GetPosition();
                 m_selectedNode = GetHitNode(m_basePosition);
-                if (m_selectedNode != nullptr)
+                if (m_selectedNode != astar::Map::npos)
                 {
-                    m_oldNodePosition.x = m_selectedNode->x;
-                    m_oldNodePosition.y = m_selectedNode->y;
+                    m_oldNodePosition.x = m_map.GetX(m_selectedNode);
+                    m_oldNodePosition.y = m_map.GetY(m_selectedNode);
                 }
             }
             else if (m_selectedToolId == ID_ADD_LINK)
             {
                 Refresh();
                 auto selectedNode = GetHitNode(evt.GetPosition());
-                if (m_selectedNode == nullptr)
+                if (m_selectedNode == astar::Map::npos)
                 {
                     m_selectedNode = selectedNode;
                     return;
                 }
                 
-                if (selectedNode == nullptr)
+                if (selectedNode == astar::Map::npos)
                 {
-                    m_selectedNode = nullptr;
+                    m_selectedNode = astar::Map::npos;
                     return;
                 }
 
-                auto link = m_map.MakeLink(selectedNode, m_selectedNode);
-                m_selectedNode = nullptr;
-                if (link != nullptr)
-                {
-                    m_linkList.push_back(link);
-                }
+                m_map.MakeLink(selectedNode, m_selectedNode);
+                m_selectedNode = astar::Map::npos;
             }
             else if(m_selectedToolId == ID_FIND_PATH)
             {
                 Refresh();
                 auto selectedNode = GetHitNode(evt.GetPosition());
-                if (m_selectedNode == nullptr)
+                if (m_selectedNode == astar::Map::npos)
                 {
                     m_pathNodeList.clear();
                     m_selectedNode = selectedNode;
                     return;
                 }
 
-                if (selectedNode == nullptr)
+                if (selectedNode == astar::Map::npos)
                 {
                     m_pathNodeList.clear();
-                    m_selectedNode = nullptr;
+                    m_selectedNode = astar::Map::npos;
                     return;
                 }
 
                 m_map.UpdateLength();
                 m_map.Navigate(m_selectedNode, selectedNode, &m_pathNodeList);
-                m_selectedNode = nullptr;
+                m_selectedNode = astar::Map::npos;
             }
         });
 
@@ -859,21 +153,20 @@ public:
                 if (m_selectedToolId != ID_MOVE_NODE)
                     return;
                 
-                if (m_selectedNode == nullptr)
+                if (m_selectedNode == astar::Map::npos)
                     return;
 
                 Refresh();
                 wxPoint newPos = m_oldNodePosition;
                 newPos += evt.GetPosition() - m_basePosition;
-                m_selectedNode->x = newPos.x;
-                m_selectedNode->y = newPos.y;
+                m_map.SetPosition(m_selectedNode, newPos.x, newPos.y);
         });
 
         Bind(wxEVT_LEFT_UP, [this](wxMouseEvent& evt)
         {
-            if (m_selectedToolId == ID_MOVE_NODE && m_selectedNode != nullptr)
+            if (m_selectedToolId == ID_MOVE_NODE && m_selectedNode != astar::Map::npos)
             {
-                m_selectedNode = nullptr;
+                m_selectedNode = astar::Map::npos;
                 Refresh();
             }
         });
@@ -883,68 +176,198 @@ public:
                 wxPaintDC dc{ this };
                 wxBrush whiteBrush{ *wxWHITE_BRUSH };
                 wxBrush blackBrush{ *wxBLACK_BRUSH };
-                for (auto it : m_linkList)
+                const size_t linkCount = m_map.GetLinkCount();
+                for (astar::Map::LinkHandle i = 0; i < linkCount; ++i)
                 {
-                    dc.DrawLine(it->a->x, it->a->y, it->b->x, it->b->y);
+                    const auto a = m_map.GetLinkA(i);
+                    const auto b = m_map.GetLinkB(i);
+                    dc.DrawLine(m_map.GetX(a), m_map.GetY(a), m_map.GetX(b), m_map.GetY(b));
                 }
 
-                dc.SetBrush(whiteBrush);
-                for (auto it : m_nodeList)
-                {
-                    if (it == m_selectedNode)
-                    {
-                        dc.SetBrush(blackBrush);
-                    }
+                dc.SetBrush(whiteBrush);
+                m_map.ForEachNode([&](astar::Map::NodeHandle node, float x, float y)
+                    {
+                        if (node == m_selectedNode)
+                        {
+                            dc.SetBrush(blackBrush);
+                        }
+
+                        dc.DrawEllipse(wxPoint(x - 10, y - 10), wxSize{ 21, 21 });
+
+                        if (node == m_selectedNode)
+                        {
+                            dc.SetBrush(whiteBrush);
+                        }
+                    });
+
+                dc.SetBrush(*wxRED_BRUSH);
+                for (auto it : m_pathNodeList)
+                {
+                    dc.DrawEllipse(wxPoint(m_map.GetX(it) - 10, m_map.GetY(it) - 10), wxSize{ 21, 21 });
+                }
+
+                if (!m_pathNodeList.empty() && m_selectedNode != astar::Map::npos)
+                {
+                    dc.SetBrush(blackBrush);
+                    dc.DrawEllipse(wxPoint(m_map.GetX(m_selectedNode) - 10, m_map.GetY(m_selectedNode) - 10), wxSize{ 21, 21 });
+                }
+            });
+    }
+
+    // 노드 반지름 안에서 가장 가까운 노드. 겹치면 나중에 그린(핸들이 큰) 노드를 고른다.
+    astar::Map::NodeHandle GetHitNode(const wxPoint& pt)
+    {
+        return m_map.FindNearestNode(pt.x, pt.y, 21.f);
+    }
+
+private:
+    astar::Map m_map;
+    std::vector<astar::Map::NodeHandle> m_pathNodeList;
+    wxPoint m_basePosition;
+    wxPoint m_oldNodePosition;
+    astar::Map::NodeHandle m_selectedNode;
+    wxWindowID m_selectedToolId;
+};
+
+// 확장자가 .amap이면 바이너리 지도, 아니면 XML 지도로 다룬다.
+static bool IsBinaryMapPath(const wxString& path)
+{
+    return path.Lower().EndsWith(wxS(".amap"));
+}
+
+static wxString FormatXmlMapError(const astar::XmlMapError& error)
+{
+    switch (error.kind)
+    {
+    case astar::XmlMapErrorKind::BadSyntax:
+        return wxString::Format(wxS("%llu번째 줄: 태그 형식이 잘못되었습니다."), static_cast<unsigned long long>(error.line));
+    case astar::XmlMapErrorKind::MissingAttribute:
+        return wxString::Format(wxS("%llu번째 줄: 속성이 빠졌습니다."), static_cast<unsigned long long>(error.line));
+    case astar::XmlMapErrorKind::BadAttribute:
+        return wxString::Format(wxS("%llu번째 줄: 속성 값이 잘못되었습니다."), static_cast<unsigned long long>(error.line));
+    case astar::XmlMapErrorKind::DuplicateNode:
+        return wxString::Format(wxS("노드 %llu가 여러 번 나옵니다."), static_cast<unsigned long long>(error.nodeId));
+    case astar::XmlMapErrorKind::UnknownNode:
+        return wxString::Format(wxS("간선이 없는 노드 %llu를 가리킵니다."), static_cast<unsigned long long>(error.nodeId));
+    case astar::XmlMapErrorKind::NotMapFile:
+        return wxS("map 파일이 아닙니다.");
+    default:
+        return wxS("파일을 읽을 수 없습니다.");
+    }
+}
+
+// 지도 XML을 스트리밍으로 읽는다. 잘못된 레코드는 건너뛰고 parent가 있으면 진행률과 오류 목록을 보여준다.
+static bool ReadXmlMap(const wxString& path, astar::BinaryMapData* data, wxWindow* parent = nullptr)
+{
+    // 이보다 큰 파일은 매핑해서 여러 스레드로 나눠 읽는다.
+    constexpr uint64_t parallelThreshold = 32ull << 20;
+    const std::filesystem::path filePath{ path.ToStdWstring() };
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(filePath, error);
+
+    astar::XmlMapCollector collector{ data };
+    std::unique_ptr<wxProgressDialog> progress;
+    if (parent != nullptr)
+    {
+        progress = std::make_unique<wxProgressDialog>(wxS("지도 읽기"), path, 1000, parent, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+        collector.SetProgressCallback([&progress](uint64_t readBytes, uint64_t totalBytes)
+            {
+                const int value = totalBytes == 0 ? 1000 : static_cast<int>(readBytes * 1000 / totalBytes);
+                return progress->Update(std::min(value, 1000));
+            });
+    }
+
+    astar::XmlMapReader reader;
+    bool completed;
+    if (!error && fileSize >= parallelThreshold)
+    {
+        astar::ThreadPool pool;
+        completed = reader.Read(filePath, collector, pool);
+    }
+    else
+    {
+        completed = reader.Read(filePath, collector);
+    }
 
-                    dc.DrawEllipse(wxPoint(it->x - 10, it->y - 10), wxSize{ 21, 21 });
+    completed = completed && collector.Finish();
+    progress.reset();
+    if (parent != nullptr && collector.GetErrorCount() != 0)
+    {
+        wxString message = wxString::Format(wxS("오류 %llu개"), static_cast<unsigned long long>(collector.GetErrorCount()));
+        for (auto& it : collector.GetErrors())
+        {
+            message << wxS("\n") << FormatXmlMapError(it);
+        }
 
-                    if (it == m_selectedNode)
-                    {
-                        dc.SetBrush(whiteBrush);
-                    }
-                }
+        wxMessageBox(message, path, wxOK | (completed ? wxICON_WARNING : wxICON_ERROR), parent);
+    }
 
-                dc.SetBrush(*wxRED_BRUSH);
-                for (auto it : m_pathNodeList)
-                {
-                    dc.DrawEllipse(wxPoint(it->x - 10, it->y - 10), wxSize{ 21, 21 });
-                }
+    return completed;
+}
 
-                if (!m_pathNodeList.empty() && m_selectedNode != nullptr)
-                {
-                    dc.SetBrush(blackBrush);
-                    dc.DrawEllipse(wxPoint(m_selectedNode->x - 10, m_selectedNode->y - 10), wxSize{ 21, 21 });
-                }
-            });
+static bool WriteXmlMap(const wxString& path, const astar::BinaryMapData& data)
+{
+    wxFile file;
+    if (!file.Open(path, wxFile::write))
+        return false;
+
+    wxFileOutputStream os{ file };
+    wxXmlDocument doc;
+    wxXmlNode* rootNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("map") };
+    for (size_t i = 0; i < data.nodeIds.size(); ++i)
+    {
+        wxXmlNode* mapNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("node") };
+        mapNode->AddAttribute(wxS("id"), wxString() << data.nodeIds[i]);
+        mapNode->AddAttribute(wxS("x"), wxString() << static_cast<long>(data.x[i]));
+        mapNode->AddAttribute(wxS("y"), wxString() << static_cast<long>(data.y[i]));
+        rootNode->AddChild(mapNode);
     }
 
-    astar::Node* GetHitNode(const wxPoint& pt)
+    for (size_t row = 0; row < data.nodeIds.size(); ++row)
     {
-        auto it = m_nodeList.rbegin();
-        for (; it != m_nodeList.rend(); ++it)
+        for (uint32_t i = data.linkOffsets[row]; i != data.linkOffsets[row + 1]; ++i)
         {
-            auto node = *it;
-            float dx = node->x - pt.x;
-            float dy = node->y - pt.y;
-            if (dx * dx + dy * dy < 441)
-            {
-                return node;
-            }
+            wxXmlNode* linkNode;
+            linkNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("link") };
+            linkNode->AddAttribute(wxS("from"), wxString() << data.nodeIds[row]);
+            linkNode->AddAttribute(wxS("to"), wxString() << data.nodeIds[data.linkTargets[i]]);
+            rootNode->AddChild(linkNode);
         }
+    }
 
-        return nullptr;
+    doc.SetRoot(rootNode);
+    doc.SetFileEncoding(wxS("utf-8"));
+    doc.SetVersion(wxS("1.0"));
+    return doc.Save(os);
+}
+
+// XML <-> 바이너리 변환. 형식은 확장자로 정한다.
+static bool ConvertMapFile(const wxString& srcPath, const wxString& dstPath)
+{
+    astar::BinaryMapData data;
+    if (IsBinaryMapPath(srcPath))
+    {
+        astar::BinaryMapView view;
+        if (view.Open(std::filesystem::path{ srcPath.ToStdWstring() }) != astar::BinaryMapError::None)
+            return false;
+
+        const size_t nodeCount = view.GetNodeCount();
+        data.nodeIds.assign(view.NodeIds(), view.NodeIds() + nodeCount);
+        data.x.assign(view.X(), view.X() + nodeCount);
+        data.y.assign(view.Y(), view.Y() + nodeCount);
+        data.linkOffsets.assign(view.LinkOffsets(), view.LinkOffsets() + nodeCount + 1);
+        data.linkTargets.assign(view.LinkTargets(), view.LinkTargets() + view.GetLinkCount());
+    }
+    else if (!ReadXmlMap(srcPath, &data))
+    {
+        return false;
     }
 
-private:
-    astar::Map m_map;
-    std::vector<astar::Node*> m_nodeList;
-    std::vector<astar::Link*> m_linkList;
-    std::vector<astar::Node*> m_pathNodeList;
-    wxPoint m_basePosition;
-    wxPoint m_oldNodePosition;
-    astar::Node* m_selectedNode;
-    wxWindowID m_selectedToolId;
-};
+    if (IsBinaryMapPath(dstPath))
+        return astar::WriteBinaryMap(std::filesystem::path{ dstPath.ToStdWstring() }, data) == astar::BinaryMapError::None;
+
+    return WriteXmlMap(dstPath, data);
+}
 
 class AStarFrame2 : public AStarFrameUi
 {
@@ -956,9 +379,9 @@ public:
         {
             auto srcPt = frame->m_nodeTable[src];
             auto dstPt = frame->m_nodeTable[dst];
-            float dx = dstPt.x - srcPt.x;
-            float dy = dstPt.y - srcPt.y;
-            return std::sqrt(std::pow(dx, 2) + std::pow(dy, 2));
+            float dx = static_cast<float>(dstPt.x - srcPt.x);
+            float dy = static_cast<float>(dstPt.y - srcPt.y);
+            return std::sqrt(dx * dx + dy * dy);
         }
     };
 
@@ -969,41 +392,58 @@ public:
         {
             auto srcPt = frame->m_nodeTable[src];
             auto dstPt = frame->m_nodeTable[finalDest];
-            float dx = dstPt.x - srcPt.x;
-            float dy = dstPt.y - srcPt.y;
-            return std::sqrt(std::pow(dx, 2) + std::pow(dy, 2));
+            float dx = static_cast<float>(dstPt.x - srcPt.x);
+            float dy = static_cast<float>(dstPt.y - srcPt.y);
+            return std::sqrt(dx * dx + dy * dy);
         }
     };
 
+    using PathFinder = astar::TGenericPathFinder<FuncterG, FunctionH>;
+
     AStarFrame2(wxWindow* win, wxWindowID id, const wxString& title)
         : AStarFrameUi(win, id, title)
-        , m_pathFinder{ new astar::TGenericPathFinder<FuncterG, FunctionH>(FuncterG{this}, FunctionH{this}) }
+        , m_pathFinder{ new PathFinder(FuncterG{this}, FunctionH{this}) }
         , m_selectedToolId{ ID_MOVE_NODE }
-        , m_selectedNode{ nullptr } {
+        , m_selectedNode{ nullptr }
+        , m_zoom{ 1.0 }
+        , m_dragging{ false }
+        , m_staticLayerValid{ false }
+        , m_showSearch{ false }
+        , m_searchFromNodeId{ 0 }
+        , m_searchToNodeId{ 0 }
+        , m_searchQueryId{ 0 }
+        , m_overlayQueryId{ 0 }
+        , m_lastQueryId{ 0 } {
         auto toolBar = CreateToolBar(wxTB_DEFAULT_STYLE | wxTB_TEXT);
         toolBar->AddTool(wxID_OPEN, wxGetStockLabel(wxID_OPEN), wxArtProvider::GetBitmapBundle(wxART_FILE_OPEN, wxART_TOOLBAR), wxGetStockHelpString(wxID_OPEN));
         toolBar->AddTool(wxID_SAVE, wxGetStockLabel(wxID_SAVE), wxArtProvider::GetBitmapBundle(wxART_FILE_SAVE, wxART_TOOLBAR), wxGetStockHelpString(wxID_SAVE));
         toolBar->Realize();
         m_drawPanel = new wxPanel{ this };
+        m_drawPanel->SetBackgroundStyle(wxBG_STYLE_PAINT);
+        CreateStatusBar();
         m_drawPanel->Bind(wxEVT_CONTEXT_MENU, [this](wxContextMenuEvent& evt)
             {
                 wxMenu menu;
-                menu.Append(ID_ADD_NODE, wxS(" ߰"));
-                menu.AppendRadioItem(ID_ADD_LINK, wxS(" "));
-                menu.AppendRadioItem(ID_MOVE_NODE, wxS(" ̵"));
-                menu.AppendRadioItem(ID_FIND_PATH, wxS(" ã"));
+                menu.Append(ID_ADD_NODE, wxS("노드 추가"));
+                menu.AppendRadioItem(ID_ADD_LINK, wxS("노드 연결"));
+                menu.AppendRadioItem(ID_MOVE_NODE, wxS("노드 이동"));
+                menu.AppendRadioItem(ID_FIND_PATH, wxS("길 찾기"));
+                menu.AppendSeparator();
+                menu.AppendCheckItem(ID_SHOW_SEARCH, wxS("탐색 영역 표시"));
                 menu.Check(m_selectedToolId, true);
+                menu.Check(ID_SHOW_SEARCH, m_showSearch);
                 m_drawPanel->PopupMenu(&menu);
             });
 
         Bind(wxEVT_MENU, [this](wxCommandEvent& evt)
             {
-                auto size = GetClientSize();
+                auto size = m_drawPanel->GetClientSize();
                 size /= 2;
-                wxPoint pt{ size.x, size.y };
+                wxPoint pt = ToWorld(wxPoint{ size.x, size.y });
                 auto nodeId = m_pathFinder->AllocNodeId();
                 m_nodeTable[nodeId] = pt;
-                m_drawPanel->Refresh();
+                m_spatialIndex.Insert(nodeId, static_cast<float>(pt.x), static_cast<float>(pt.y));
+                InvalidateStaticLayer();
                 m_selectedToolId = ID_MOVE_NODE;
             }, ID_ADD_NODE);
 
@@ -1025,22 +465,45 @@ public:
                 m_selectedToolId = ID_FIND_PATH;
             }, ID_FIND_PATH);
 
+        Bind(wxEVT_MENU, [this](wxCommandEvent& evt)
+            {
+                m_showSearch = !m_showSearch;
+                if (m_showSearch)
+                {
+                    RequestSearchOverlay();
+                }
+                else
+                {
+                    CancelSearchOverlay();
+                    ClearSearchOverlay();
+                }
+
+                m_drawPanel->Refresh();
+            }, ID_SHOW_SEARCH);
+
         m_drawPanel->Bind(wxEVT_LEFT_DOWN, [this](wxMouseEvent& evt)
             {
+                if (m_dragging)
+                {
+                    // 패널 밖에서 버튼을 뗐으면 LEFT_UP을 받지 못한다.
+                    EndDrag();
+                }
+
                 if (m_selectedToolId == ID_MOVE_NODE)
                 {
                     m_drawPanel->Refresh();
-                    m_basePosition = evt.GetPosition();
+                    m_basePosition = ToWorld(evt.GetPosition());
                     m_selectedNode = GetHitNode(m_basePosition);
                     if (m_selectedNode != nullptr)
                     {
                         m_oldNodePosition = m_selectedNode->second;
+                        BeginDrag();
                     }
                 }
                 else if (m_selectedToolId == ID_ADD_LINK)
                 {
                     m_drawPanel->Refresh();
-                    auto selectedNode = GetHitNode(evt.GetPosition());
+                    auto selectedNode = GetHitNode(ToWorld(evt.GetPosition()));
                     if (m_selectedNode == nullptr)
                     {
                         m_selectedNode = selectedNode;
@@ -1058,27 +521,29 @@ public:
                     if (link != nullptr)
                     {
                         m_linkList.emplace_back(link);
+                        InvalidateStaticLayer();
+                        ReplanPath();
                     }
                 }
                 else if (m_selectedToolId == ID_FIND_PATH)
                 {
                     Refresh();
-                    auto selectedNode = GetHitNode(evt.GetPosition());
+                    auto selectedNode = GetHitNode(ToWorld(evt.GetPosition()));
                     if (m_selectedNode == nullptr)
                     {
-                        m_pathNodeList.clear();
+                        ClearPathSearch();
                         m_selectedNode = selectedNode;
                         return;
                     }
 
                     if (selectedNode == nullptr)
                     {
-                        m_pathNodeList.clear();
+                        ClearPathSearch();
                         m_selectedNode = nullptr;
                         return;
                     }
 
-                    m_pathFinder->Navigate(m_selectedNode->first, selectedNode->first, &m_pathNodeList);
+                    StartPathSearch(m_selectedNode->first, selectedNode->first);
                     m_selectedNode = nullptr;
                 }
             });
@@ -1094,67 +559,100 @@ public:
                 if (!evt.ButtonIsDown(wxMOUSE_BTN_LEFT))
                     return;
 
-                m_drawPanel->Refresh();
+                // 끄는 노드와 거기 붙은 간선이 차지하던 곳과 새로 차지할 곳만 다시 그린다.
+                wxRect dirtyRect = GetDragBounds();
                 wxPoint newPos = m_oldNodePosition;
-                newPos += evt.GetPosition() - m_basePosition;
+                newPos += ToWorld(evt.GetPosition()) - m_basePosition;
                 m_selectedNode->second = newPos;
+                m_spatialIndex.Move(m_selectedNode->first, static_cast<float>(newPos.x), static_cast<float>(newPos.y));
+                m_pathFinder->InvalidateNodeLinkCost(m_selectedNode->first);
+                if (ReplanPath())
+                {
+                    // 경로는 어디로든 바뀔 수 있다.
+                    m_drawPanel->Refresh();
+                    return;
+                }
+
+                dirtyRect.Union(GetDragBounds());
+                m_drawPanel->RefreshRect(ToScreen(dirtyRect));
             });
 
         m_drawPanel->Bind(wxEVT_LEFT_UP, [this](wxMouseEvent& evt)
             {
+                if (m_dragging)
+                {
+                    EndDrag();
+                }
             });
 
-        m_drawPanel->Bind(wxEVT_PAINT, [this](wxPaintEvent& evt)
+        m_drawPanel->Bind(wxEVT_SIZE, [this](wxSizeEvent& evt)
             {
-                wxPaintDC dc{ m_drawPanel };
-                wxBrush whiteBrush{ *wxWHITE_BRUSH };
-                wxBrush blackBrush{ *wxBLACK_BRUSH };
+                InvalidateStaticLayer();
+                evt.Skip();
+            });
 
+        // 휠로 커서 위치를 중심으로 확대/축소한다.
+        m_drawPanel->Bind(wxEVT_MOUSEWHEEL, [this](wxMouseEvent& evt)
+            {
+                if (evt.GetWheelRotation() == 0 || m_dragging)
+                    return;
 
-                wxPoint array[3]{
-                    {-11, 0},
-                    {-26, 15},
-                    {-26, -15}
-                };
+                const wxPoint anchor = ToWorld(evt.GetPosition());
+                const double steps = static_cast<double>(evt.GetWheelRotation()) / evt.GetWheelDelta();
+                m_zoom = std::clamp(m_zoom * std::pow(1.25, steps), minZoom, maxZoom);
+                m_viewOrigin.x = anchor.x - static_cast<int>(evt.GetX() / m_zoom);
+                m_viewOrigin.y = anchor.y - static_cast<int>(evt.GetY() / m_zoom);
+                InvalidateStaticLayer();
+            });
 
-                for (auto link : m_linkList)
+        m_drawPanel->Bind(wxEVT_PAINT, [this](wxPaintEvent& evt)
+            {
+                wxStopWatch stopWatch;
+                wxAutoBufferedPaintDC dc{ m_drawPanel };
+                if (!m_staticLayerValid)
                 {
-                    auto& pt1 = m_nodeTable[link->toNodeId];
-                    auto& pt2 = m_nodeTable[link->fromNodeId];
-                    auto vPtTo = XMVectorSet(pt1.x, pt1.y, 0.f, 0.f);
-                    auto vPtFr = XMVectorSet(pt2.x, pt2.y, 0.f, 0.f);
-                    auto vArrow = XMVector2Normalize(vPtTo - vPtFr);
-                    auto vTop = XMVector2Orthogonal(vArrow);
-                    XMFLOAT2 s;
-                    XMFLOAT2 s2;
-                    XMStoreFloat2(&s, vArrow);
-                    XMStoreFloat2(&s2, vTop);
-                    wxAffineMatrix2D mat{};
-                    mat.Set(wxMatrix2D{ s.x, s.y, s2.x, s2.y }, wxPoint2DDouble{ static_cast<double>(pt1.x), static_cast<double>(pt1.y) });
-
-                    dc.DrawLine(pt1, pt2);
-
-                    dc.SetTransformMatrix(mat);
-                    dc.DrawPolygon(3, array);
-                    dc.ResetTransformMatrix();
+                    RebuildStaticLayer();
                 }
 
-                dc.SetBrush(whiteBrush);
-                for (auto& it : m_nodeTable)
+                // 바뀌지 않는 간선과 노드는 미리 그려 둔 비트맵을 그대로 옮긴다.
+                dc.DrawBitmap(m_staticLayer, 0, 0);
+                SetViewTransform(dc);
+                wxBrush blackBrush{ *wxBLACK_BRUSH };
+                if (m_showSearch)
                 {
-                    if (&it == m_selectedNode)
+                    // 확장한 노드는 파란색, 끝났을 때 열린 목록에 남은 노드는 주황색
+                    const wxPen pen = dc.GetPen();
+                    dc.SetPen(*wxTRANSPARENT_PEN);
+                    dc.SetBrush(wxBrush{ wxColour{ 120, 170, 255 } });
+                    for (auto it : m_exploredNodeList)
+                    {
+                        dc.DrawEllipse(m_nodeTable[it] - wxPoint(6, 6), wxSize{ 13, 13 });
+                    }
+
+                    dc.SetBrush(wxBrush{ wxColour{ 255, 160, 40 } });
+                    for (auto it : m_frontierNodeList)
                     {
-                        dc.SetBrush(blackBrush);
+                        dc.DrawEllipse(m_nodeTable[it] - wxPoint(6, 6), wxSize{ 13, 13 });
                     }
 
-                    dc.DrawEllipse(it.second - wxPoint(10, 10), wxSize{ 21, 21 });
+                    dc.SetPen(pen);
+                }
 
-                    if (&it == m_selectedNode)
+                if (m_dragging && m_selectedNode != nullptr)
+                {
+                    const bool drawArrowhead = m_zoom >= arrowheadMinZoom;
+                    for (auto link : m_dragLinks)
                     {
-                        dc.SetBrush(whiteBrush);
+                        DrawLink(dc, m_nodeTable[link->toNodeId], m_nodeTable[link->fromNodeId], drawArrowhead);
                     }
                 }
 
+                if (m_selectedNode != nullptr)
+                {
+                    dc.SetBrush(blackBrush);
+                    dc.DrawEllipse(m_selectedNode->second - wxPoint(10, 10), wxSize{ 21, 21 });
+                }
+
                 dc.SetBrush(*wxRED_BRUSH);
                 for (auto it : m_pathNodeList)
                 {
@@ -1167,162 +665,507 @@ public:
                     dc.SetBrush(blackBrush);
                     dc.DrawEllipse(m_selectedNode->second - wxPoint(10, 10), wxSize{ 21, 21 });
                 }
+
+                SetStatusText(wxString::Format(wxS("그리기 %.2f ms, 배율 %.2f%s"), stopWatch.TimeInMicro().ToDouble() / 1000.0, m_zoom, m_searchStatus));
             });
 
         Bind(wxEVT_TOOL, [this](wxCommandEvent& evt)
             {
               
-                wxFileDialog dialog{ this, wxFileSelectorPromptStr, {}, {}, wxS("xml file|*.xml"), wxFD_OPEN };
+                wxFileDialog dialog{ this, wxFileSelectorPromptStr, {}, {}, wxS("xml file|*.xml|binary map|*.amap"), wxFD_OPEN };
                 auto id = dialog.ShowModal();
                 if (id == wxID_CANCEL)
                     return;
 
-                wxXmlDocument doc;
-                doc.Load(dialog.GetPath());
-                auto root = doc.GetRoot();
-                if (root->GetName() != wxS("map"))
-                    return;
-
-
-                auto pathFinder = std::make_unique<astar::TGenericPathFinder<FuncterG, FunctionH>>(FuncterG {this}, FunctionH{ this });
+                auto pathFinder = std::make_unique<PathFinder>(FuncterG {this}, FunctionH{ this });
                 std::map<astar::GenericPathFinder::NodeId, wxPoint> nodeTable;
-                std::vector<astar::GenericPathFinder::Link*> linkList;
-                wxXmlNode* it;
-                it = root->GetChildren();
-                while (it != nullptr)
+                auto load = [&pathFinder, &nodeTable](size_t nodeCount, const uint64_t* nodeIds, const float* xs, const float* ys, const uint32_t* linkOffsets, const uint32_t* linkTargets)
                 {
-                    wxXmlNode* child = it;
-                    it = it->GetNext();
+                    if (!pathFinder->LoadGraph(nodeCount, nodeIds, linkOffsets, linkTargets))
+                        return false;
 
-                    if (child->GetName() != wxS("node"))
-                        continue;
+                    for (size_t i = 0; i < nodeCount; ++i)
+                    {
+                        nodeTable.emplace_hint(nodeTable.end(), nodeIds[i], wxPoint{ static_cast<int>(xs[i]), static_cast<int>(ys[i]) });
+                    }
 
-                    long idLong;
-                    long x;
-                    long y;
-                    wxString attr = child->GetAttribute(wxS("id"));
-                    if (!attr.ToLong(&idLong))
-                        return;
+                    return true;
+                };
 
-                    attr = child->GetAttribute(wxS("x"));
-                    if (!attr.ToLong(&x))
+                const wxString path = dialog.GetPath();
+                if (IsBinaryMapPath(path))
+                {
+                    // 매핑한 파일의 CSR을 그대로 finder에 넘긴다.
+                    astar::BinaryMapView view;
+                    if (view.Open(std::filesystem::path{ path.ToStdWstring() }) != astar::BinaryMapError::None)
                         return;
 
-                    attr = child->GetAttribute(wxS("y"));
-                    if (!attr.ToLong(&y))
+                    if (!load(view.GetNodeCount(), view.NodeIds(), view.X(), view.Y(), view.LinkOffsets(), view.LinkTargets()))
                         return;
-
-                    nodeTable.emplace(idLong, wxPoint{ x, y });
-                    pathFinder->AllocNodeId(idLong);
                 }
-
-                it = root->GetChildren();
-                while (it != nullptr)
+                else
                 {
-                    wxXmlNode* child = it;
-                    it = it->GetNext();
-
-                    if (child->GetName() != wxS("link"))
-                        continue;
-
-                    long fromNodeId;
-                    long toNodeId;
-                    auto attr = child->GetAttribute(wxS("from"));
-                    if (!attr.ToLong(&fromNodeId))
-                        return;
-
-                    attr = child->GetAttribute(wxS("to"));
-                    if (!attr.ToLong(&toNodeId))
+                    astar::BinaryMapData data;
+                    if (!ReadXmlMap(path, &data, this))
                         return;
 
-                    auto link = pathFinder->MakeLink(toNodeId, fromNodeId);
-                    if (link == nullptr)
+                    if (!load(data.nodeIds.size(), data.nodeIds.data(), data.x.data(), data.y.data(), data.linkOffsets.data(), data.linkTargets.data()))
                         return;
-
-                    linkList.push_back(link);
                 }
 
+                ClearPathSearch();
                 m_pathFinder = std::move(pathFinder);
+                m_graphSnapshot.reset();
                 m_nodeTable.swap(nodeTable);
-                m_linkList.swap(linkList);
-                m_pathNodeList.clear();
-                Refresh();
+                m_spatialIndex.Clear();
+                m_spatialIndex.Reserve(m_nodeTable.size());
+                for (auto& it : m_nodeTable)
+                {
+                    m_spatialIndex.Insert(it.first, static_cast<float>(it.second.x), static_cast<float>(it.second.y));
+                }
+
+                m_linkList = m_pathFinder->m_linkList;
+                m_selectedNode = nullptr;
+                m_dragging = false;
+                m_dragLinks.clear();
+                InvalidateStaticLayer();
             }, wxID_OPEN);
 
         Bind(wxEVT_TOOL, [this](wxCommandEvent& evt)
             {
 
-                wxFileDialog dialog{ this, wxFileSelectorPromptStr, {}, {}, wxS("xml file|*.xml"), wxFD_SAVE };
+                wxFileDialog dialog{ this, wxFileSelectorPromptStr, {}, {}, wxS("xml file|*.xml|binary map|*.amap"), wxFD_SAVE };
                 auto id = dialog.ShowModal();
                 if (id == wxID_CANCEL)
                     return;
 
-                auto filePath = dialog.GetPath();
-                wxFile file;
-                if (!file.Open(filePath, wxFile::write))
-                    return;
-
-                wxFileOutputStream os{ file };
-                wxXmlDocument doc;
-                wxXmlNode* rootNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("map") };
+                astar::BinaryMapData data;
                 for (auto& pair : m_nodeTable)
                 {
-                    wxXmlNode* mapNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("node") };
-                    mapNode->AddAttribute(wxS("id"), wxString() << pair.first);
-                    mapNode->AddAttribute(wxS("x"), wxString() << pair.second.x);
-                    mapNode->AddAttribute(wxS("y"), wxString() << pair.second.y);
-                    rootNode->AddChild(mapNode);
+                    data.nodeIds.push_back(pair.first);
+                    data.x.push_back(static_cast<float>(pair.second.x));
+                    data.y.push_back(static_cast<float>(pair.second.y));
                 }
 
+                std::vector<std::pair<uint64_t, uint64_t>> links;
                 for (auto& link : m_linkList)
                 {
-                    wxXmlNode* linkNode;
-                    linkNode = new wxXmlNode{ wxXML_ELEMENT_NODE, wxS("link") };
-                    linkNode->AddAttribute(wxS("from"), wxString() << link->fromNodeId);
-                    linkNode->AddAttribute(wxS("to"), wxString() << link->toNodeId);
-                    rootNode->AddChild(linkNode);
+                    links.emplace_back(link->fromNodeId, link->toNodeId);
                 }
 
-                doc.SetRoot(rootNode);
-                doc.SetFileEncoding(wxS("utf-8"));
-                doc.SetVersion(wxS("1.0"));
-                doc.Save(os);
+                if (!data.BuildLinks(links))
+                    return;
 
+                auto filePath = dialog.GetPath();
+                if (IsBinaryMapPath(filePath))
+                {
+                    astar::WriteBinaryMap(std::filesystem::path{ filePath.ToStdWstring() }, data);
+                }
+                else
+                {
+                    WriteXmlMap(filePath, data);
+                }
             }, wxID_SAVE);
     }
 
+    // 지도 좌표 pt에서 노드 반지름 안의 가장 가까운 노드. 겹치면 나중에 그린(ID가 큰) 노드를 고른다.
     std::pair<const astar::GenericPathFinder::NodeId, wxPoint>*
         GetHitNode(const wxPoint& pt)
     {
-        auto it = m_nodeTable.rbegin();
-        for (; it != m_nodeTable.rend(); ++it)
+        const auto nodeId = m_spatialIndex.FindNearest(static_cast<float>(pt.x), static_cast<float>(pt.y), 21.f);
+        if (nodeId == m_spatialIndex.npos)
+            return nullptr;
+
+        auto it = m_nodeTable.find(nodeId);
+        return it != m_nodeTable.end() ? std::addressof(*it) : nullptr;
+    }
+
+private:
+    // 화살촉은 이 배율보다 작게 보면 그리지 않는다.
+    static constexpr double arrowheadMinZoom = 0.5;
+    static constexpr double minZoom = 0.05;
+    static constexpr double maxZoom = 8.0;
+    // 화살촉 끝이 노드 중심에서 떨어진 거리와 크기
+    static constexpr int arrowheadLength = 26;
+
+    wxPoint ToWorld(const wxPoint& pt) const
+    {
+        return wxPoint{ m_viewOrigin.x + static_cast<int>(std::floor(pt.x / m_zoom)), m_viewOrigin.y + static_cast<int>(std::floor(pt.y / m_zoom)) };
+    }
+
+    wxRect ToScreen(const wxRect& rect) const
+    {
+        const int left = static_cast<int>(std::floor((rect.GetLeft() - m_viewOrigin.x) * m_zoom));
+        const int top = static_cast<int>(std::floor((rect.GetTop() - m_viewOrigin.y) * m_zoom));
+        const int right = static_cast<int>(std::ceil((rect.GetRight() + 1 - m_viewOrigin.x) * m_zoom));
+        const int bottom = static_cast<int>(std::ceil((rect.GetBottom() + 1 - m_viewOrigin.y) * m_zoom));
+        return wxRect{ left, top, right - left, bottom - top }.Inflate(2);
+    }
+
+    // 화면에 보이는 지도 영역
+    wxRect GetViewport() const
+    {
+        const wxSize size = m_drawPanel->GetClientSize();
+        const wxPoint bottomRight = ToWorld(wxPoint{ size.x, size.y });
+        return wxRect{ m_viewOrigin, bottomRight }.Inflate(1);
+    }
+
+    void SetViewTransform(wxDC& dc) const
+    {
+        dc.SetUserScale(m_zoom, m_zoom);
+        dc.SetLogicalOrigin(m_viewOrigin.x, m_viewOrigin.y);
+    }
+
+    static wxRect GetNodeBounds(const wxPoint& pt)
+    {
+        return wxRect{ pt - wxPoint(10, 10), wxSize{ 21, 21 } };
+    }
+
+    static wxRect GetLinkBounds(const wxPoint& to, const wxPoint& from)
+    {
+        return wxRect{ to, from }.Inflate(arrowheadLength);
+    }
+
+    // to 쪽 끝에 화살촉을 붙여 그린다. 변환 행렬 대신 세 꼭짓점을 직접 계산한다.
+    static void DrawLink(wxDC& dc, const wxPoint& to, const wxPoint& from, bool drawArrowhead)
+    {
+        dc.DrawLine(to, from);
+        if (!drawArrowhead)
+            return;
+
+        const float dx = static_cast<float>(to.x - from.x);
+        const float dy = static_cast<float>(to.y - from.y);
+        const float length = std::sqrt(dx * dx + dy * dy);
+        if (length == 0.f)
+            return;
+
+        const float ax = dx / length;
+        const float ay = dy / length;
+        static constexpr float shape[3][2]{
+            { -11.f, 0.f },
+            { -arrowheadLength, 15.f },
+            { -arrowheadLength, -15.f }
+        };
+
+        wxPoint points[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            points[i].x = to.x + static_cast<int>(std::lround(shape[i][0] * ax - shape[i][1] * ay));
+            points[i].y = to.y + static_cast<int>(std::lround(shape[i][0] * ay + shape[i][1] * ax));
+        }
+
+        dc.DrawPolygon(3, points);
+    }
+
+    void InvalidateStaticLayer()
+    {
+        m_staticLayerValid = false;
+        m_drawPanel->Refresh();
+    }
+
+    // 보이는 간선과 노드를 비트맵에 그린다. 끄는 노드와 거기 붙은 간선은 빼고 매번 따로 그린다.
+    void RebuildStaticLayer()
+    {
+        wxSize size = m_drawPanel->GetClientSize();
+        size.IncTo(wxSize{ 1, 1 });
+        if (!m_staticLayer.IsOk() || m_staticLayer.GetSize() != size)
+        {
+            m_staticLayer.Create(size);
+        }
+
+        wxMemoryDC dc{ m_staticLayer };
+        dc.SetBackground(wxBrush{ m_drawPanel->GetBackgroundColour() });
+        dc.Clear();
+        SetViewTransform(dc);
+
+        const wxRect viewport = GetViewport();
+        const bool drawArrowhead = m_zoom >= arrowheadMinZoom;
+        const bool dragging = m_dragging && m_selectedNode != nullptr;
+        const astar::GenericPathFinder::NodeId draggedNodeId = dragging ? m_selectedNode->first : 0;
+        for (auto link : m_linkList)
+        {
+            if (dragging && (link->fromNodeId == draggedNodeId || link->toNodeId == draggedNodeId))
+                continue;
+
+            auto& pt1 = m_nodeTable[link->toNodeId];
+            auto& pt2 = m_nodeTable[link->fromNodeId];
+            if (!viewport.Intersects(GetLinkBounds(pt1, pt2)))
+                continue;
+
+            DrawLink(dc, pt1, pt2, drawArrowhead);
+        }
+
+        // 노드는 ID 순서로 그려서 겹칠 때 전과 같은 노드가 위에 오게 한다.
+        std::vector<astar::GenericPathFinder::NodeId> visibleNodes;
+        m_spatialIndex.QueryBox(static_cast<float>(viewport.GetLeft() - 11), static_cast<float>(viewport.GetTop() - 11),
+            static_cast<float>(viewport.GetRight() + 11), static_cast<float>(viewport.GetBottom() + 11), &visibleNodes);
+        std::sort(visibleNodes.begin(), visibleNodes.end());
+        dc.SetBrush(*wxWHITE_BRUSH);
+        for (auto it : visibleNodes)
+        {
+            if (dragging && it == draggedNodeId)
+                continue;
+
+            dc.DrawEllipse(GetNodeBounds(m_nodeTable[it]));
+        }
+
+        dc.SelectObject(wxNullBitmap);
+        m_staticLayerValid = true;
+    }
+
+    void BeginDrag()
+    {
+        m_dragging = true;
+        m_dragLinks.clear();
+        for (auto link : m_linkList)
         {
-            auto& node = it->second;
-            auto dx = node.x - pt.x;
-            auto dy = node.y - pt.y;
-            if (dx * dx + dy * dy < 441)
+            if (link->fromNodeId == m_selectedNode->first || link->toNodeId == m_selectedNode->first)
             {
-                return std::addressof(*it);
+                m_dragLinks.push_back(link);
             }
         }
 
-        return nullptr;
+        InvalidateStaticLayer();
+    }
+
+    void EndDrag()
+    {
+        m_dragging = false;
+        m_dragLinks.clear();
+        InvalidateStaticLayer();
+        // 끄는 동안 숨긴 탐색 영역을 옮긴 자리에서 다시 구한다.
+        RequestSearchOverlay();
+    }
+
+    // 끄는 노드와 거기 붙은 간선이 차지하는 지도 영역
+    wxRect GetDragBounds()
+    {
+        wxRect rect = GetNodeBounds(m_selectedNode->second);
+        for (auto link : m_dragLinks)
+        {
+            rect.Union(GetLinkBounds(m_nodeTable[link->toNodeId], m_nodeTable[link->fromNodeId]));
+        }
+
+        return rect;
+    }
+
+    // 경로는 작업자 스레드에서 그래프 스냅샷으로 찾고, 찾은 뒤 노드를 끌거나 간선을 이으면 증분 탐색으로 고친다.
+    // 탐색 영역을 켜 두었으면 작업자가 같은 질의에서 남긴 추적 결과를 받아서 그린다.
+    void StartPathSearch(astar::GenericPathFinder::NodeId fromNodeId, astar::GenericPathFinder::NodeId toNodeId)
+    {
+        ClearPathSearch();
+        UpdateGraphSnapshot();
+        const uint64_t queryId = ++m_lastQueryId;
+        m_searchQueryId = queryId;
+        m_searchToken = m_queryService.Submit(m_graphSnapshot, fromNodeId, toNodeId, [this, queryId](astar::PathQueryResult&& result)
+            {
+                CallAfter([this, queryId, result]() { OnPathQueryFinished(queryId, result); });
+            }, m_showSearch);
+
+        m_searchStatus = wxS(", 길 찾는 중");
+    }
+
+    void OnPathQueryFinished(uint64_t queryId, const astar::PathQueryResult& result)
+    {
+        // 다시 클릭해서 취소한 질의의 결과가 늦게 올 수 있다.
+        if (queryId != m_searchQueryId)
+            return;
+
+        m_searchQueryId = 0;
+        if (result.version != m_pathFinder->GetGraphVersion())
+        {
+            // 찾는 동안 노드를 옮겼으면 지금 그래프로 다시 찾는다.
+            StartPathSearch(result.fromNodeId, result.toNodeId);
+            return;
+        }
+
+        m_pathNodeList = result.path;
+        SetSearchEnds(result.fromNodeId, result.toNodeId);
+        if (m_showSearch && result.statistics.expandedCount == 0 && result.expandedCount != 0)
+        {
+            // 찾는 동안 탐색 영역을 켰으면 추적 없이 찾았으므로 따로 구한다.
+            RequestSearchOverlay();
+        }
+        else
+        {
+            SetSearchOverlay(result);
+        }
+
+        m_drawPanel->Refresh();
+    }
+
+    void ClearPathSearch()
+    {
+        if (m_searchQueryId != 0)
+        {
+            m_searchToken.Cancel();
+            m_searchQueryId = 0;
+        }
+
+        CancelSearchOverlay();
+        m_pathFinder->EndReplan();
+        m_pathNodeList.clear();
+        SetSearchEnds(0, 0);
+        ClearSearchOverlay();
+    }
+
+    // 찾아 둔 경로가 있으면 다시 계산하고 true를 돌려준다. 아직 찾는 중이면 결과가 왔을 때 버전을 보고 다시 찾는다.
+    bool ReplanPath()
+    {
+        if (m_searchFromNodeId == 0 || m_searchQueryId != 0)
+            return false;
+
+        if (m_pathFinder->IsReplanning())
+        {
+            m_pathFinder->Replan(&m_pathNodeList);
+        }
+        else
+        {
+            // 처음 고칠 때 증분 탐색 상태를 만든다.
+            m_pathFinder->BeginReplan(m_searchFromNodeId, m_searchToNodeId, &m_pathNodeList);
+        }
+
+        // 그려 둔 탐색 영역은 이전 그래프의 것이므로 다시 구한다.
+        RequestSearchOverlay();
+        return true;
+    }
+
+    void SetSearchEnds(astar::GenericPathFinder::NodeId fromNodeId, astar::GenericPathFinder::NodeId toNodeId)
+    {
+        m_searchFromNodeId = fromNodeId;
+        m_searchToNodeId = toNodeId;
+    }
+
+    void UpdateGraphSnapshot()
+    {
+        if (m_graphSnapshot != nullptr && m_graphSnapshot->version == m_pathFinder->GetGraphVersion())
+            return;
+
+        m_graphSnapshot = m_pathFinder->CreateGraphSnapshot([this](astar::GenericPathFinder::NodeId nodeId, float* x, float* y)
+            {
+                auto& pt = m_nodeTable[nodeId];
+                *x = static_cast<float>(pt.x);
+                *y = static_cast<float>(pt.y);
+            });
+    }
+
+    // 증분 탐색은 A*와 확장 순서가 다르므로, 같은 질의를 작업자에서 A*로 한 번 더 풀어서 그 탐색 영역을 보여 준다.
+    // 경로를 찾는 중이면 그 결과에 탐색 영역이 함께 오므로 따로 구하지 않는다. 노드를 끄는 동안에는 숨겨 두고 EndDrag에서 구한다.
+    void RequestSearchOverlay()
+    {
+        CancelSearchOverlay();
+        ClearSearchOverlay();
+        if (!m_showSearch || m_searchFromNodeId == 0 || m_searchQueryId != 0 || m_dragging)
+            return;
+
+        UpdateGraphSnapshot();
+        const uint64_t queryId = ++m_lastQueryId;
+        m_overlayQueryId = queryId;
+        m_overlayToken = m_queryService.Submit(m_graphSnapshot, m_searchFromNodeId, m_searchToNodeId, [this, queryId](astar::PathQueryResult&& result)
+            {
+                CallAfter([this, queryId, result]() { OnSearchOverlayFinished(queryId, result); });
+            }, true);
+
+        m_searchStatus = wxS(", 탐색 영역 계산 중");
+    }
+
+    void OnSearchOverlayFinished(uint64_t queryId, const astar::PathQueryResult& result)
+    {
+        if (queryId != m_overlayQueryId)
+            return;
+
+        m_overlayQueryId = 0;
+        if (result.version != m_pathFinder->GetGraphVersion())
+        {
+            RequestSearchOverlay();
+            return;
+        }
+
+        SetSearchOverlay(result);
+        m_drawPanel->Refresh();
+    }
+
+    void CancelSearchOverlay()
+    {
+        if (m_overlayQueryId != 0)
+        {
+            m_overlayToken.Cancel();
+            m_overlayQueryId = 0;
+        }
+    }
+
+    void ClearSearchOverlay()
+    {
+        m_exploredNodeList.clear();
+        m_frontierNodeList.clear();
+        m_searchStatus = m_searchQueryId != 0 ? wxString{ wxS(", 길 찾는 중") } : wxString{};
+    }
+
+    void SetSearchOverlay(const astar::PathQueryResult& result)
+    {
+        ClearSearchOverlay();
+        if (!m_showSearch)
+            return;
+
+        m_exploredNodeList = result.explored;
+        m_frontierNodeList = result.frontier;
+        const auto& statistics = result.statistics;
+        m_searchStatus = wxString::Format(wxS(", 확장 %llu, 갱신 %llu, 휴리스틱 %llu, 열린 목록 최대 %zu, 탐색 %.3f ms"),
+            static_cast<unsigned long long>(statistics.expandedCount),
+            static_cast<unsigned long long>(statistics.relaxedCount),
+            static_cast<unsigned long long>(statistics.heuristicCount),
+            statistics.peakOpenListSize,
+            statistics.elapsedSeconds * 1000.0);
     }
 
-private:
     wxPanel* m_drawPanel;
-    std::unique_ptr<astar::TGenericPathFinder<FuncterG, FunctionH>> m_pathFinder;
+    std::unique_ptr<PathFinder> m_pathFinder;
     std::map<astar::GenericPathFinder::NodeId, wxPoint> m_nodeTable;
+    astar::SpatialGrid<astar::GenericPathFinder::NodeId> m_spatialIndex;
     std::pair<const astar::GenericPathFinder::NodeId, wxPoint>* m_selectedNode;
     std::vector<astar::GenericPathFinder::Link*> m_linkList;
     std::vector<astar::GenericPathFinder::NodeId> m_pathNodeList;
     wxPoint m_basePosition;
     wxPoint m_oldNodePosition;
     wxWindowID m_selectedToolId;
+    // 화면 (0, 0)에 오는 지도 좌표와 배율
+    wxPoint m_viewOrigin;
+    double m_zoom;
+    bool m_dragging;
+    std::vector<astar::GenericPathFinder::Link*> m_dragLinks;
+    wxBitmap m_staticLayer;
+    bool m_staticLayerValid;
+    bool m_showSearch;
+    astar::GenericPathFinder::NodeId m_searchFromNodeId;
+    astar::GenericPathFinder::NodeId m_searchToNodeId;
+    std::vector<astar::GenericPathFinder::NodeId> m_exploredNodeList;
+    std::vector<astar::GenericPathFinder::NodeId> m_frontierNodeList;
+    wxString m_searchStatus;
+    std::shared_ptr<const astar::GraphSnapshot> m_graphSnapshot;
+    // 진행 중인 질의의 번호. 0이면 없다.
+    uint64_t m_searchQueryId;
+    // 탐색 영역만 구하는 질의의 번호. 0이면 없다.
+    uint64_t m_overlayQueryId;
+    uint64_t m_lastQueryId;
+    astar::CancellationToken m_searchToken;
+    astar::CancellationToken m_overlayToken;
+    // 작업자가 this에 CallAfter를 걸므로 다른 멤버보다 먼저 없애서 작업자를 멈춘다.
+    astar::PathQueryService m_queryService;
 };
 
 bool AStarApp::OnInit()
 {
+    // astar --convert <입력> <출력>: 창을 띄우지 않고 지도 형식만 바꾼다.
+    if (argc == 4 && argv[1] == wxS("--convert"))
+    {
+        if (!ConvertMapFile(argv[2], argv[3]))
+        {
+            wxSafeShowMessage(wxS("astar"), wxS("map conversion failed"));
+        }
+
+        return false;
+    }
+
     if (!wxApp::OnInit())
     {
         return false;
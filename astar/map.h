@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "coordinate_store.h"
+#include "node_id_set.h"
+#include "search_state.h"
+#include "spatial_index.h"
+
+namespace astar
+{
+    // 노드 좌표는 CoordinateStore의 x/y 배열에, 간선은 양 끝 노드 핸들 배열에 연속으로 저장한다.
+    // 노드 핸들은 배열 인덱스이고 RemoveNode 전까지 바뀌지 않는다. 지운 핸들은 다음 AddNode에서 다시 쓴다.
+    // 노드마다 붙은 간선 목록과 (노드, 노드) 쌍으로 찾는 간선 해시를 함께 유지해서
+    // MakeLink의 중복 검사는 O(1), 이웃 나열은 O(차수)이다.
+    class Map
+    {
+    public:
+        using NodeHandle = uint32_t;
+        using LinkHandle = uint32_t;
+
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        Map()
+            : m_componentsDirty{ true }
+        {
+
+        }
+
+        NodeHandle AddNode(float x, float y)
+        {
+            NodeHandle handle;
+            if (!m_freeNodes.empty())
+            {
+                handle = m_freeNodes.back();
+                m_freeNodes.pop_back();
+                m_alive[handle] = 1;
+            }
+            else
+            {
+                handle = static_cast<NodeHandle>(m_alive.size());
+                m_alive.push_back(1);
+                m_adjacency.emplace_back();
+                m_coordinates.Resize(m_alive.size());
+            }
+
+            m_coordinates.Set(handle, x, y);
+            m_spatialIndex.Insert(handle, x, y);
+            m_componentsDirty = true;
+            return handle;
+        }
+
+        bool IsValidNode(NodeHandle node) const
+        {
+            return node < m_alive.size() && m_alive[node] != 0;
+        }
+
+        // 핸들 범위. 지운 노드의 핸들도 포함한다.
+        size_t GetNodeCapacity() const { return m_alive.size(); }
+
+        size_t GetNodeCount() const { return m_alive.size() - m_freeNodes.size(); }
+
+        void Reserve(size_t nodeCount, size_t linkCount)
+        {
+            m_alive.reserve(nodeCount);
+            m_adjacency.reserve(nodeCount);
+            m_linkA.reserve(linkCount);
+            m_linkB.reserve(linkCount);
+            m_linkLength.reserve(linkCount);
+            m_linkTable.reserve(linkCount);
+        }
+
+        float GetX(NodeHandle node) const { return m_coordinates.GetX(node); }
+
+        float GetY(NodeHandle node) const { return m_coordinates.GetY(node); }
+
+        // 간선 길이는 UpdateLength를 부를 때 다시 계산한다.
+        void SetPosition(NodeHandle node, float x, float y)
+        {
+            m_coordinates.Set(node, x, y);
+            m_spatialIndex.Move(node, x, y);
+        }
+
+        // (x, y)에서 radius 미만인 노드
+        void FindNodesInRadius(float x, float y, float radius, std::vector<NodeHandle>* result) const
+        {
+            m_spatialIndex.QueryRadius(x, y, radius, result);
+        }
+
+        // maxDistance 미만에서 가장 가까운 노드. 없으면 npos
+        NodeHandle FindNearestNode(float x, float y, float maxDistance = std::numeric_limits<float>::infinity()) const
+        {
+            return m_spatialIndex.FindNearest(x, y, maxDistance);
+        }
+
+        // 가까운 순서로 최대 k개
+        void FindNearestNodes(float x, float y, size_t k, std::vector<NodeHandle>* result) const
+        {
+            std::vector<std::pair<float, NodeHandle>> nearest;
+            m_spatialIndex.FindKNearest(x, y, k, &nearest);
+            result->clear();
+            for (auto& it : nearest)
+            {
+                result->push_back(it.second);
+            }
+        }
+
+        // target까지 길이 있는 노드 중 (x, y)에서 가장 가까운 노드. 없으면 npos
+        NodeHandle FindNearestReachableNode(float x, float y, NodeHandle target, float maxDistance = std::numeric_limits<float>::infinity())
+        {
+            if (!IsValidNode(target))
+                return npos;
+
+            UpdateComponents();
+            const uint32_t component = m_component[target];
+            return m_spatialIndex.FindNearest(x, y, [this, component](NodeHandle node) { return m_component[node] == component; }, maxDistance);
+        }
+
+        // 노드가 아닌 위치에서 출발한다. 출발점은 to까지 길이 있는 가장 가까운 노드로 잡고 결과의 맨 앞에 둔다.
+        bool NavigateFrom(float x, float y, NodeHandle to, std::vector<NodeHandle>* result)
+        {
+            const NodeHandle from = FindNearestReachableNode(x, y, to);
+            if (from == npos)
+                return false;
+
+            if (from == to)
+            {
+                result->assign(1, to);
+                return true;
+            }
+
+            return Navigate(from, to, result);
+        }
+
+        // func(handle, x, y)를 살아 있는 노드마다 핸들 순서로 부른다.
+        template<typename TFunc>
+        void ForEachNode(TFunc&& func) const
+        {
+            for (NodeHandle i = 0; i < m_alive.size(); ++i)
+            {
+                if (m_alive[i] != 0)
+                {
+                    func(i, m_coordinates.GetX(i), m_coordinates.GetY(i));
+                }
+            }
+        }
+
+        size_t GetLinkCount() const { return m_linkA.size(); }
+
+        NodeHandle GetLinkA(LinkHandle link) const { return m_linkA[link]; }
+
+        NodeHandle GetLinkB(LinkHandle link) const { return m_linkB[link]; }
+
+        float GetLinkLength(LinkHandle link) const { return m_linkLength[link]; }
+
+        // 방향은 구분하지 않는다. 없으면 npos
+        LinkHandle FindLink(NodeHandle node1, NodeHandle node2) const
+        {
+            auto it = m_linkTable.find(LinkKey(node1, node2));
+            return it != m_linkTable.end() ? it->value : npos;
+        }
+
+        // 노드에 붙은 간선 핸들 목록
+        const std::vector<LinkHandle>& GetLinks(NodeHandle node) const { return m_adjacency[node]; }
+
+        // 모든 간선 길이를 한 번에 다시 계산한다.
+        void UpdateLength()
+        {
+            m_coordinates.Distances(m_linkA.data(), m_linkB.data(), m_linkA.size(), m_linkLength.data());
+        }
+
+        CoordinateStore& GetCoordinateStore() { return m_coordinates; }
+
+        LinkHandle MakeLink(NodeHandle node1, NodeHandle node2)
+        {
+            if (!IsValidNode(node1) || !IsValidNode(node2) || node1 == node2)
+                return npos;
+
+            const LinkHandle link = static_cast<LinkHandle>(m_linkA.size());
+            if (!m_linkTable.insert(LinkKey(node1, node2), link).second)
+                return npos;
+
+            m_linkA.push_back(node1);
+            m_linkB.push_back(node2);
+            m_linkLength.push_back(m_coordinates.Distance(node1, node2));
+            m_adjacency[node1].push_back(link);
+            m_adjacency[node2].push_back(link);
+            m_componentsDirty = true;
+            return link;
+        }
+
+        // 마지막 간선을 link 자리로 옮겨서 지운다. 마지막 간선의 핸들은 link로 바뀐다.
+        void RemoveLink(LinkHandle link)
+        {
+            if (link >= m_linkA.size())
+                return;
+
+            const LinkHandle last = static_cast<LinkHandle>(m_linkA.size() - 1);
+            m_linkTable.erase(LinkKey(m_linkA[link], m_linkB[link]));
+            ReplaceAdjacentLink(m_linkA[link], link, npos);
+            ReplaceAdjacentLink(m_linkB[link], link, npos);
+            if (link != last)
+            {
+                ReplaceAdjacentLink(m_linkA[last], last, link);
+                ReplaceAdjacentLink(m_linkB[last], last, link);
+                *m_linkTable.get(LinkKey(m_linkA[last], m_linkB[last])) = link;
+                m_linkA[link] = m_linkA[last];
+                m_linkB[link] = m_linkB[last];
+                m_linkLength[link] = m_linkLength[last];
+            }
+
+            m_linkA.pop_back();
+            m_linkB.pop_back();
+            m_linkLength.pop_back();
+            m_componentsDirty = true;
+        }
+
+        // 노드에 붙은 간선도 함께 지운다.
+        void RemoveNode(NodeHandle node)
+        {
+            if (!IsValidNode(node))
+                return;
+
+            while (!m_adjacency[node].empty())
+            {
+                RemoveLink(m_adjacency[node].back());
+            }
+
+            m_alive[node] = 0;
+            m_freeNodes.push_back(node);
+            m_spatialIndex.Remove(node);
+        }
+
+        bool Navigate(NodeHandle from, NodeHandle to, std::vector<NodeHandle>* result)
+        {
+            return Navigate(from, to, result, m_context);
+        }
+
+        template<typename TOpenList, typename TTrace>
+        bool Navigate(NodeHandle from, NodeHandle to, std::vector<NodeHandle>* result, PathQueryContext<TOpenList, TTrace>& context)
+        {
+            result->clear();
+            if (!IsValidNode(from) || !IsValidNode(to))
+                return false;
+
+            if (from == to)
+            {
+                result->push_back(from);
+                return true;
+            }
+
+            const float toX = m_coordinates.GetX(to);
+            const float toY = m_coordinates.GetY(to);
+            auto funcH = [this, toX, toY](uint32_t index)
+            {
+                return m_coordinates.Distance(index, toX, toY);
+            };
+
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            auto& nearNodeList = context.neighbors;
+            auto& nearH = context.neighborH;
+            auto& nearCost = context.neighborCost;
+            auto& trace = context.trace;
+            trace.BeginQuery(from, to);
+            slots.BeginQuery(m_alive.size());
+            SearchSlot& navNodeFrom = slots.Touch(from, funcH);
+            trace.OnHeuristic(1);
+            navNodeFrom.g = 0.f;
+            openList.Clear();
+            openList.Reserve(m_alive.size());
+            openList.Push(from, navNodeFrom.h);
+            do {
+                if (openList.Empty())
+                    return trace.EndQuery(false);
+
+                const uint32_t selIndex = openList.Pop();
+                trace.OnExpand(selIndex);
+                if (selIndex == to)
+                    break;
+
+                const float selG = slots[selIndex].g;
+                const float selX = m_coordinates.GetX(selIndex);
+                const float selY = m_coordinates.GetY(selIndex);
+                CollectLinkedNode(selIndex, &nearNodeList);
+                // 처음 닿는 이웃을 앞으로 모아서 그 이웃들의 휴리스틱과 간선 길이만 블록 단위로 계산한다.
+                // 이미 닿은 이웃은 h가 슬롯에 있으므로 간선 길이만 하나씩 구한다.
+                const size_t freshCount = std::partition(nearNodeList.begin(), nearNodeList.end(), [&slots](uint32_t node) { return !slots.IsTouched(node); }) - nearNodeList.begin();
+                nearH.resize(freshCount);
+                nearCost.resize(freshCount);
+                m_coordinates.Distances(nearNodeList.data(), freshCount, toX, toY, nearH.data());
+                trace.OnHeuristic(freshCount);
+                m_coordinates.Distances(nearNodeList.data(), freshCount, selX, selY, nearCost.data());
+                for (size_t i = 0; i < nearNodeList.size(); ++i)
+                {
+                    const uint32_t nodeIndex = nearNodeList[i];
+                    const bool fresh = i < freshCount;
+                    SearchSlot& node = fresh ? slots.Touch(nodeIndex, [&nearH, i](uint32_t) { return nearH[i]; }) : slots[nodeIndex];
+                    if (node.prev == selIndex)
+                        continue;
+
+                    float g = (fresh ? nearCost[i] : m_coordinates.Distance(nodeIndex, selX, selY)) + selG;
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    openList.Push(nodeIndex, g + node.h);
+                    trace.OnRelax(nodeIndex, openList.Size());
+                }
+            } while (true);
+            
+            result->clear();
+            {
+                uint32_t it = to;
+                while (it != SearchSlotTable::npos)
+                {
+                    result->push_back(it);
+                    it = slots[it].prev;
+                }
+
+                std::reverse(result->begin(), result->end());
+            }
+
+            return trace.EndQuery(true);
+        }
+
+    private:
+        static uint64_t LinkKey(NodeHandle node1, NodeHandle node2)
+        {
+            if (node1 > node2)
+            {
+                std::swap(node1, node2);
+            }
+
+            return (static_cast<uint64_t>(node1) << 32) | node2;
+        }
+
+        // node의 간선 목록에서 from을 to로 바꾼다. to가 npos면 목록에서 뺀다.
+        void ReplaceAdjacentLink(NodeHandle node, LinkHandle from, LinkHandle to)
+        {
+            auto& links = m_adjacency[node];
+            for (auto& it : links)
+            {
+                if (it != from)
+                    continue;
+
+                if (to != npos)
+                {
+                    it = to;
+                }
+                else
+                {
+                    it = links.back();
+                    links.pop_back();
+                }
+
+                return;
+            }
+        }
+
+        // 간선이 바뀐 뒤 처음 물을 때 연결 요소 번호를 다시 매긴다.
+        void UpdateComponents()
+        {
+            if (!m_componentsDirty)
+                return;
+
+            m_component.assign(m_alive.size(), npos);
+            std::vector<NodeHandle> stack;
+            uint32_t count = 0;
+            for (NodeHandle i = 0; i < m_alive.size(); ++i)
+            {
+                if (m_alive[i] == 0 || m_component[i] != npos)
+                    continue;
+
+                m_component[i] = count;
+                stack.push_back(i);
+                while (!stack.empty())
+                {
+                    const NodeHandle node = stack.back();
+                    stack.pop_back();
+                    for (auto link : m_adjacency[node])
+                    {
+                        const NodeHandle next = m_linkA[link] != node ? m_linkA[link] : m_linkB[link];
+                        if (m_component[next] == npos)
+                        {
+                            m_component[next] = count;
+                            stack.push_back(next);
+                        }
+                    }
+                }
+
+                count += 1;
+            }
+
+            m_componentsDirty = false;
+        }
+
+        void CollectLinkedNode(NodeHandle node, std::vector<uint32_t>* result) const
+        {
+            result->clear();
+            for (auto link : m_adjacency[node])
+            {
+                result->push_back(m_linkA[link] != node ? m_linkA[link] : m_linkB[link]);
+            }
+        }
+
+    private:
+        CoordinateStore m_coordinates;
+        std::vector<uint8_t> m_alive;
+        std::vector<NodeHandle> m_freeNodes;
+        // 간선의 양 끝 노드와 길이
+        std::vector<NodeHandle> m_linkA;
+        std::vector<NodeHandle> m_linkB;
+        std::vector<float> m_linkLength;
+        std::vector<std::vector<LinkHandle>> m_adjacency;
+        NodeIdMap<LinkHandle, uint64_t> m_linkTable;
+        SpatialGrid<NodeHandle> m_spatialIndex;
+        // 노드별 연결 요소 번호. m_componentsDirty면 다시 계산해야 한다.
+        std::vector<uint32_t> m_component;
+        bool m_componentsDirty;
+        PathQueryContext<> m_context;
+    };
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace astar
+{
+    // Robin Hood 해싱을 쓰는 NodeId 키 해시 테이블.
+    // 용량은 2의 거듭제곱으로 늘어나며 삭제는 backward shift로 처리해서 묘비(tombstone)가 없다.
+    // TKey는 NodeId 외에 두 인덱스를 합친 64비트 키처럼 부호 없는 정수면 된다.
+    template<typename TValue, typename TKey = size_t>
+    class NodeIdMap
+    {
+    public:
+        struct Slot
+        {
+            TKey key;
+            TValue value;
+            // 0이면 빈 슬롯, 아니면 (원래 위치로부터의 거리 + 1)
+            uint32_t distance;
+        };
+
+        struct Iter
+        {
+            const Slot* slot;
+            const Slot* last;
+
+            Iter& operator ++ ()
+            {
+                ++slot;
+                SkipEmpty();
+                return *this;
+            }
+
+            Iter operator ++ (int)
+            {
+                Iter tmp{ *this };
+                ++*this;
+                return tmp;
+            }
+
+            const Slot& operator*() const { return *slot; }
+
+            const Slot* operator->() const { return slot; }
+
+            bool operator==(const Iter& it) const { return slot == it.slot; }
+
+            bool operator!=(const Iter& it) const { return slot != it.slot; }
+
+            void SkipEmpty()
+            {
+                while (slot != last && slot->distance == 0)
+                {
+                    ++slot;
+                }
+            }
+        };
+
+        // 최대 적재율 7/8
+        static constexpr size_t maxLoadNumerator = 7;
+        static constexpr size_t maxLoadDenominator = 8;
+        static constexpr size_t minCapacity = 8;
+
+        NodeIdMap()
+            : m_size{ 0 }
+            , m_shift{ 64 }
+        {
+
+        }
+
+        size_t size() const { return m_size; }
+
+        bool empty() const { return m_size == 0; }
+
+        size_t capacity() const { return m_slots.size(); }
+
+        size_t count(TKey key) const
+        {
+            return find(key) != end() ? 1 : 0;
+        }
+
+        Iter find(TKey key) const
+        {
+            if (m_size == 0)
+                return end();
+
+            const size_t mask = m_slots.size() - 1;
+            size_t pos = HomeOf(key);
+            uint32_t distance = 1;
+            while (true)
+            {
+                const Slot& slot = m_slots[pos];
+                if (slot.distance < distance)
+                    return end();
+
+                if (slot.key == key)
+                    return MakeIter(&slot);
+
+                pos = (pos + 1) & mask;
+                distance += 1;
+            }
+        }
+
+        TValue* get(TKey key)
+        {
+            Iter it = find(key);
+            if (it == end())
+                return nullptr;
+
+            return const_cast<TValue*>(&it->value);
+        }
+
+        // 이미 있으면 값을 바꾸지 않고 false를 돌려준다.
+        std::pair<Iter, bool> insert(TKey key, const TValue& value)
+        {
+            Iter it = find(key);
+            if (it != end())
+                return { it, false };
+
+            if ((m_size + 1) * maxLoadDenominator > m_slots.size() * maxLoadNumerator)
+            {
+                Rehash(m_slots.empty() ? minCapacity : m_slots.size() * 2);
+            }
+
+            return { MakeIter(Place(Slot{ key, value, 1 })), true };
+        }
+
+        void erase(TKey key)
+        {
+            Iter it = find(key);
+            if (it != end())
+            {
+                erase(it);
+            }
+        }
+
+        Iter erase(Iter iter)
+        {
+            if (iter == end())
+                return iter;
+
+            const size_t mask = m_slots.size() - 1;
+            size_t pos = static_cast<size_t>(iter.slot - m_slots.data());
+            size_t next = (pos + 1) & mask;
+            while (m_slots[next].distance > 1)
+            {
+                m_slots[pos] = m_slots[next];
+                m_slots[pos].distance -= 1;
+                pos = next;
+                next = (next + 1) & mask;
+            }
+
+            m_slots[pos].distance = 0;
+            m_size -= 1;
+
+            // 뒤로 당겨진 원소가 iter 위치에 들어왔을 수 있으므로 같은 위치부터 다시 본다.
+            Iter ret{ iter.slot, m_slots.data() + m_slots.size() };
+            ret.SkipEmpty();
+            return ret;
+        }
+
+        void clear()
+        {
+            for (auto& it : m_slots)
+            {
+                it.distance = 0;
+            }
+
+            m_size = 0;
+        }
+
+        void reserve(size_t count)
+        {
+            size_t capacity = CapacityFor(count);
+            if (capacity > m_slots.size())
+            {
+                Rehash(capacity);
+            }
+        }
+
+        void shrink_to_fit()
+        {
+            if (m_size == 0)
+            {
+                std::vector<Slot>{}.swap(m_slots);
+                m_shift = 64;
+                return;
+            }
+
+            size_t capacity = CapacityFor(m_size);
+            if (capacity < m_slots.size())
+            {
+                Rehash(capacity);
+            }
+        }
+
+        float load_factor() const
+        {
+            return m_slots.empty() ? 0.f : static_cast<float>(m_size) / static_cast<float>(m_slots.size());
+        }
+
+        // 탐색 길이는 찾는 키에 도달할 때까지 확인하는 슬롯 수이다.
+        size_t max_probe_length() const
+        {
+            uint32_t ret = 0;
+            for (auto& it : m_slots)
+            {
+                if (it.distance > ret)
+                {
+                    ret = it.distance;
+                }
+            }
+
+            return ret;
+        }
+
+        float average_probe_length() const
+        {
+            if (m_size == 0)
+                return 0.f;
+
+            uint64_t sum = 0;
+            for (auto& it : m_slots)
+            {
+                sum += it.distance;
+            }
+
+            return static_cast<float>(sum) / static_cast<float>(m_size);
+        }
+
+        Iter begin() const
+        {
+            Iter it{ m_slots.data(), m_slots.data() + m_slots.size() };
+            it.SkipEmpty();
+            return it;
+        }
+
+        Iter end() const
+        {
+            const Slot* last = m_slots.data() + m_slots.size();
+            return Iter{ last, last };
+        }
+
+    private:
+        static size_t CapacityFor(size_t count)
+        {
+            size_t capacity = minCapacity;
+            while (count * maxLoadDenominator > capacity * maxLoadNumerator)
+            {
+                capacity *= 2;
+            }
+
+            return capacity;
+        }
+
+        // 피보나치 해싱. 연속된 NodeId도 고르게 흩어진다.
+        size_t HomeOf(TKey key) const
+        {
+            return static_cast<size_t>((static_cast<uint64_t>(key) * 11400714819323198485ull) >> m_shift);
+        }
+
+        Iter MakeIter(const Slot* slot) const
+        {
+            return Iter{ slot, m_slots.data() + m_slots.size() };
+        }
+
+        const Slot* Place(Slot item)
+        {
+            const size_t mask = m_slots.size() - 1;
+            size_t pos = HomeOf(item.key);
+            const Slot* placed = nullptr;
+            while (true)
+            {
+                Slot& slot = m_slots[pos];
+                if (slot.distance == 0)
+                {
+                    slot = item;
+                    m_size += 1;
+                    return placed != nullptr ? placed : &slot;
+                }
+
+                if (slot.distance < item.distance)
+                {
+                    std::swap(slot, item);
+                    if (placed == nullptr)
+                    {
+                        placed = &slot;
+                    }
+                }
+
+                pos = (pos + 1) & mask;
+                item.distance += 1;
+            }
+        }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<Slot> old;
+            old.swap(m_slots);
+            m_slots.assign(capacity, Slot{ 0, TValue{}, 0 });
+            m_shift = 64;
+            for (size_t i = capacity; i > 1; i >>= 1)
+            {
+                m_shift -= 1;
+            }
+
+            m_size = 0;
+            for (auto& it : old)
+            {
+                if (it.distance == 0)
+                    continue;
+
+                Slot item = it;
+                item.distance = 1;
+                Place(item);
+            }
+        }
+
+        std::vector<Slot> m_slots;
+        size_t m_size;
+        uint32_t m_shift;
+    };
+}
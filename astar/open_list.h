@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace astar
+{
+    // 노드 인덱스(0 ~ n-1)를 키로 관리하는 4-ary 힙. decrease-key를 지원한다.
+    template<typename TKey>
+    class TQuadHeap
+    {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        void Reserve(size_t capacity)
+        {
+            if (m_position.size() < capacity)
+            {
+                m_position.resize(capacity, npos);
+            }
+
+            m_heap.reserve(capacity);
+        }
+
+        void Clear()
+        {
+            for (auto& it : m_heap)
+            {
+                m_position[it.index] = npos;
+            }
+
+            m_heap.clear();
+        }
+
+        bool Empty() const { return m_heap.empty(); }
+
+        size_t Size() const { return m_heap.size(); }
+
+        bool Contains(uint32_t index) const
+        {
+            return index < m_position.size() && m_position[index] != npos;
+        }
+
+        // 없으면 삽입, 있으면 키를 갱신한다.
+        void Push(uint32_t index, TKey key)
+        {
+            if (index >= m_position.size())
+            {
+                m_position.resize(static_cast<size_t>(index) + 1, npos);
+            }
+
+            uint32_t pos = m_position[index];
+            if (pos == npos)
+            {
+                pos = static_cast<uint32_t>(m_heap.size());
+                m_heap.push_back(Entry{ key, index });
+                m_position[index] = pos;
+                SiftUp(pos);
+            }
+            else if (key < m_heap[pos].key)
+            {
+                m_heap[pos].key = key;
+                SiftUp(pos);
+            }
+            else
+            {
+                m_heap[pos].key = key;
+                SiftDown(pos);
+            }
+        }
+
+        uint32_t Top() const { return m_heap.front().index; }
+
+        TKey TopKey() const { return m_heap.front().key; }
+
+        uint32_t Pop()
+        {
+            uint32_t index = m_heap.front().index;
+            RemoveAt(0);
+            return index;
+        }
+
+        void Remove(uint32_t index)
+        {
+            if (!Contains(index))
+                return;
+
+            RemoveAt(m_position[index]);
+        }
+
+    private:
+        struct Entry
+        {
+            TKey key;
+            uint32_t index;
+        };
+
+        void RemoveAt(uint32_t pos)
+        {
+            m_position[m_heap[pos].index] = npos;
+            Entry last = m_heap.back();
+            m_heap.pop_back();
+            if (pos == m_heap.size())
+                return;
+
+            bool up = last.key < m_heap[pos].key;
+            m_heap[pos] = last;
+            m_position[last.index] = pos;
+            if (up)
+            {
+                SiftUp(pos);
+            }
+            else
+            {
+                SiftDown(pos);
+            }
+        }
+
+        void SiftUp(uint32_t pos)
+        {
+            Entry item = m_heap[pos];
+            while (pos != 0)
+            {
+                uint32_t parent = (pos - 1) / 4;
+                if (!(item.key < m_heap[parent].key))
+                    break;
+
+                m_heap[pos] = m_heap[parent];
+                m_position[m_heap[pos].index] = pos;
+                pos = parent;
+            }
+
+            m_heap[pos] = item;
+            m_position[item.index] = pos;
+        }
+
+        void SiftDown(uint32_t pos)
+        {
+            Entry item = m_heap[pos];
+            const size_t count = m_heap.size();
+            while (true)
+            {
+                size_t first = static_cast<size_t>(pos) * 4 + 1;
+                if (first >= count)
+                    break;
+
+                size_t last = first + 4 < count ? first + 4 : count;
+                size_t best = first;
+                for (size_t i = first + 1; i < last; ++i)
+                {
+                    if (m_heap[i].key < m_heap[best].key)
+                    {
+                        best = i;
+                    }
+                }
+
+                if (!(m_heap[best].key < item.key))
+                    break;
+
+                m_heap[pos] = m_heap[best];
+                m_position[m_heap[pos].index] = pos;
+                pos = static_cast<uint32_t>(best);
+            }
+
+            m_heap[pos] = item;
+            m_position[item.index] = pos;
+        }
+
+        std::vector<Entry> m_heap;
+        std::vector<uint32_t> m_position;
+    };
+
+    template<typename TKey>
+    constexpr uint32_t TQuadHeap<TKey>::npos;
+
+    template<typename TKey>
+    struct RadixKeyTraits;
+
+    template<>
+    struct RadixKeyTraits<uint32_t>
+    {
+        static uint32_t ToBits(uint32_t key) { return key; }
+
+        static uint32_t FromBits(uint32_t bits) { return bits; }
+    };
+
+    // 음수가 아닌 float는 비트 패턴의 대소 관계가 값의 대소 관계와 같다.
+    template<>
+    struct RadixKeyTraits<float>
+    {
+        static uint32_t ToBits(float key)
+        {
+            if (!(key > 0.f))
+                return 0;
+
+            uint32_t bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            return bits;
+        }
+
+        static float FromBits(uint32_t bits)
+        {
+            float key;
+            std::memcpy(&key, &bits, sizeof(key));
+            return key;
+        }
+    };
+
+    // 단조 증가하는 키 전용 radix 힙.
+    // 마지막으로 꺼낸 키보다 작은 키는 그 키로 취급한다.
+    // decrease-key는 새 항목을 넣고 이전 항목을 꺼낼 때 버리는 방식으로 처리한다.
+    template<typename TKey>
+    class TRadixHeap
+    {
+    public:
+        static constexpr size_t bucketCount = 33;
+
+        TRadixHeap()
+            : m_last{ 0 }
+            , m_size{ 0 }
+        {
+
+        }
+
+        void Reserve(size_t capacity)
+        {
+            if (m_key.size() < capacity)
+            {
+                m_key.resize(capacity, 0);
+                m_inHeap.resize(capacity, 0);
+            }
+        }
+
+        void Clear()
+        {
+            for (auto& bucket : m_buckets)
+            {
+                for (auto& it : bucket)
+                {
+                    m_inHeap[it.index] = 0;
+                }
+
+                bucket.clear();
+            }
+
+            m_last = 0;
+            m_size = 0;
+        }
+
+        bool Empty() const { return m_size == 0; }
+
+        size_t Size() const { return m_size; }
+
+        bool Contains(uint32_t index) const
+        {
+            return index < m_inHeap.size() && m_inHeap[index] != 0;
+        }
+
+        void Push(uint32_t index, TKey key)
+        {
+            if (index >= m_key.size())
+            {
+                Reserve(static_cast<size_t>(index) + 1);
+            }
+
+            uint32_t bits = RadixKeyTraits<TKey>::ToBits(key);
+            if (bits < m_last)
+            {
+                bits = m_last;
+            }
+
+            if (m_inHeap[index] == 0)
+            {
+                m_inHeap[index] = 1;
+                m_size += 1;
+            }
+            else if (m_key[index] == bits)
+            {
+                return;
+            }
+
+            m_key[index] = bits;
+            m_buckets[BucketOf(bits)].push_back(Entry{ bits, index });
+        }
+
+        uint32_t Pop()
+        {
+            Entry entry = Front();
+            m_buckets[0].pop_back();
+            m_inHeap[entry.index] = 0;
+            m_size -= 1;
+            return entry.index;
+        }
+
+        uint32_t Top() { return Front().index; }
+
+        TKey TopKey() { return RadixKeyTraits<TKey>::FromBits(Front().key); }
+
+    private:
+        struct Entry
+        {
+            uint32_t key;
+            uint32_t index;
+        };
+
+        // 0번 버킷의 마지막 항목이 살아 있는 최소 항목이 되도록 정리한다.
+        const Entry& Front()
+        {
+            auto& front = m_buckets[0];
+            while (true)
+            {
+                if (front.empty())
+                {
+                    Redistribute();
+                }
+
+                if (IsLive(front.back()))
+                    return front.back();
+
+                front.pop_back();
+            }
+        }
+
+        bool IsLive(const Entry& entry) const
+        {
+            return m_inHeap[entry.index] != 0 && m_key[entry.index] == entry.key;
+        }
+
+        size_t BucketOf(uint32_t bits) const
+        {
+            uint32_t diff = bits ^ m_last;
+            size_t bucket = 0;
+            while (diff != 0)
+            {
+                diff >>= 1;
+                bucket += 1;
+            }
+
+            return bucket;
+        }
+
+        void Redistribute()
+        {
+            size_t i = 1;
+            while (true)
+            {
+                auto& bucket = m_buckets[i];
+                size_t live = 0;
+                uint32_t minKey = std::numeric_limits<uint32_t>::max();
+                for (auto& it : bucket)
+                {
+                    if (!IsLive(it))
+                        continue;
+
+                    bucket[live++] = it;
+                    if (it.key < minKey)
+                    {
+                        minKey = it.key;
+                    }
+                }
+
+                bucket.resize(live);
+                if (live == 0)
+                {
+                    i += 1;
+                    continue;
+                }
+
+                m_last = minKey;
+                for (auto& it : bucket)
+                {
+                    m_buckets[BucketOf(it.key)].push_back(it);
+                }
+
+                bucket.clear();
+                return;
+            }
+        }
+
+        std::vector<Entry> m_buckets[bucketCount];
+        std::vector<uint32_t> m_key;
+        std::vector<uint8_t> m_inHeap;
+        uint32_t m_last;
+        size_t m_size;
+    };
+
+    using QuadHeapOpenList = TQuadHeap<float>;
+    using RadixHeapOpenList = TRadixHeap<float>;
+
+    // 음수 키나 마지막으로 꺼낸 키보다 작은 키를 순서대로 꺼내지 못하는 열린 목록.
+    // 상속한 타입(예: 꺼낸 수를 세는 래퍼)도 같이 걸린다.
+    template<typename TOpenList>
+    struct IsMonotoneOpenList
+    {
+    private:
+        template<typename TKey>
+        static constexpr bool Test(const TRadixHeap<TKey>*) { return true; }
+
+        static constexpr bool Test(const void*) { return false; }
+
+    public:
+        static constexpr bool value = Test(static_cast<const TOpenList*>(nullptr));
+    };
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace astar
+{
+    // (출발, 도착) 쌍으로 찾는 LRU 경로 캐시. 찾지 못한 결과도 저장한다.
+    // 그래프 버전이 올라가면 저장된 경로를 모두 버린다. 지금보다 낮은 버전의 질의는 캐시를 거치지 않고 바로 탐색한다.
+    // 같은 쌍을 여러 스레드가 동시에 찾으면 탐색은 한 번만 하고 나머지는 그 결과를 기다린다.
+    class PathCache
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t hitCount;
+            uint64_t missCount;
+            // 진행 중인 탐색에 합류한 횟수
+            uint64_t coalescedCount;
+            uint64_t evictionCount;
+            size_t entryCount;
+            // 경로 버퍼와 항목 관리에 드는 메모리 추정치
+            size_t memoryBytes;
+
+            float HitRate() const
+            {
+                const uint64_t total = hitCount + missCount + coalescedCount;
+                return total == 0 ? 0.f : static_cast<float>(hitCount + coalescedCount) / static_cast<float>(total);
+            }
+        };
+
+        explicit PathCache(size_t capacity)
+            : m_capacity{ capacity }
+            , m_version{ 0 }
+            , m_statistics{}
+        {
+
+        }
+
+        PathCache(const PathCache&) = delete;
+        PathCache& operator=(const PathCache&) = delete;
+
+        // 캐시에 없으면 search(result)로 찾아서 저장한다. search는 bool(std::vector<size_t>*) 형태이다.
+        // search가 던진 예외는 호출자에게 그대로 나가고, 같은 탐색을 기다리던 스레드에서도 다시 던진다.
+        template<typename TSearch>
+        bool Find(size_t fromNodeId, size_t toNodeId, uint64_t version, std::vector<size_t>* result, TSearch&& search)
+        {
+            const Key key{ fromNodeId, toNodeId };
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            if (version < m_version)
+            {
+                m_statistics.missCount += 1;
+                lock.unlock();
+                return search(result);
+            }
+
+            if (version > m_version)
+            {
+                DropEntries();
+                m_version = version;
+            }
+
+            auto it = m_entries.find(key);
+            if (it != m_entries.end())
+            {
+                m_lruList.splice(m_lruList.begin(), m_lruList, it->second);
+                m_statistics.hitCount += 1;
+                const Entry& entry = *it->second;
+                result->assign(entry.path->begin(), entry.path->end());
+                return entry.found;
+            }
+
+            auto itFlight = m_inFlight.find(key);
+            if (itFlight != m_inFlight.end() && itFlight->second->version == version)
+            {
+                std::shared_ptr<InFlight> flight = itFlight->second;
+                m_statistics.coalescedCount += 1;
+                flight->finished.wait(lock, [&flight]() { return flight->done; });
+                if (flight->error != nullptr)
+                    std::rethrow_exception(flight->error);
+
+                result->assign(flight->path->begin(), flight->path->end());
+                return flight->found;
+            }
+
+            m_statistics.missCount += 1;
+            auto flight = std::make_shared<InFlight>();
+            flight->version = version;
+            m_inFlight[key] = flight;
+            lock.unlock();
+
+            bool found;
+            std::shared_ptr<const std::vector<size_t>> path;
+            try
+            {
+                found = search(result);
+                path = std::make_shared<const std::vector<size_t>>(*result);
+            }
+            catch (...)
+            {
+                lock.lock();
+                flight->error = std::current_exception();
+                FinishFlight(key, flight);
+                lock.unlock();
+                flight->finished.notify_all();
+                throw;
+            }
+
+            lock.lock();
+            flight->found = found;
+            flight->path = path;
+            FinishFlight(key, flight);
+
+            // 탐색하는 사이에 그래프가 바뀌었으면 저장하지 않는다.
+            if (version == m_version)
+            {
+                Insert(key, found, std::move(path));
+            }
+
+            lock.unlock();
+            flight->finished.notify_all();
+            return found;
+        }
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            DropEntries();
+        }
+
+        void SetCapacity(size_t capacity)
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            m_capacity = capacity;
+            Trim();
+        }
+
+        size_t GetCapacity() const
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            return m_capacity;
+        }
+
+        Statistics GetStatistics() const
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            Statistics ret = m_statistics;
+            ret.entryCount = m_entries.size();
+            return ret;
+        }
+
+        void ResetStatistics()
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            const size_t memoryBytes = m_statistics.memoryBytes;
+            m_statistics = Statistics{};
+            m_statistics.memoryBytes = memoryBytes;
+        }
+
+    private:
+        struct Key
+        {
+            size_t fromNodeId;
+            size_t toNodeId;
+
+            bool operator==(const Key& rhs) const { return fromNodeId == rhs.fromNodeId && toNodeId == rhs.toNodeId; }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                return static_cast<size_t>((static_cast<uint64_t>(key.fromNodeId) * 11400714819323198485ull) ^ static_cast<uint64_t>(key.toNodeId));
+            }
+        };
+
+        struct Entry
+        {
+            Key key;
+            bool found;
+            std::shared_ptr<const std::vector<size_t>> path;
+        };
+
+        struct InFlight
+        {
+            uint64_t version = 0;
+            bool done = false;
+            bool found = false;
+            std::shared_ptr<const std::vector<size_t>> path;
+            // search가 던진 예외. 기다리던 스레드가 다시 던진다.
+            std::exception_ptr error;
+            std::condition_variable finished;
+        };
+
+        using LruList = std::list<Entry>;
+
+        // 리스트 노드, 해시 노드, 경로 버퍼를 합친 대략적인 크기
+        static size_t EntryBytes(const Entry& entry)
+        {
+            return sizeof(Entry) + sizeof(void*) * 2
+                + sizeof(std::pair<const Key, LruList::iterator>) + sizeof(void*) * 2
+                + sizeof(std::vector<size_t>) + entry.path->capacity() * sizeof(size_t);
+        }
+
+        void Insert(const Key& key, bool found, std::shared_ptr<const std::vector<size_t>> path)
+        {
+            if (m_capacity == 0)
+                return;
+
+            auto it = m_entries.find(key);
+            if (it != m_entries.end())
+            {
+                m_statistics.memoryBytes -= EntryBytes(*it->second);
+                m_lruList.erase(it->second);
+                m_entries.erase(it);
+            }
+
+            m_lruList.push_front(Entry{ key, found, std::move(path) });
+            m_entries.emplace(key, m_lruList.begin());
+            m_statistics.memoryBytes += EntryBytes(m_lruList.front());
+            Trim();
+        }
+
+        // 잠금을 쥔 채로 부른다. 기다리는 스레드는 잠금을 푼 뒤에 깨운다.
+        void FinishFlight(const Key& key, const std::shared_ptr<InFlight>& flight)
+        {
+            flight->done = true;
+            auto it = m_inFlight.find(key);
+            if (it != m_inFlight.end() && it->second == flight)
+            {
+                m_inFlight.erase(it);
+            }
+        }
+
+        void Trim()
+        {
+            while (m_entries.size() > m_capacity)
+            {
+                const Entry& entry = m_lruList.back();
+                m_statistics.memoryBytes -= EntryBytes(entry);
+                m_statistics.evictionCount += 1;
+                m_entries.erase(entry.key);
+                m_lruList.pop_back();
+            }
+        }
+
+        void DropEntries()
+        {
+            m_entries.clear();
+            m_lruList.clear();
+            m_statistics.memoryBytes = 0;
+        }
+
+        mutable std::mutex m_mutex;
+        size_t m_capacity;
+        uint64_t m_version;
+        LruList m_lruList;
+        std::unordered_map<Key, LruList::iterator, KeyHash> m_entries;
+        std::unordered_map<Key, std::shared_ptr<InFlight>, KeyHash> m_inFlight;
+        Statistics m_statistics;
+    };
+}
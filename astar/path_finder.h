@@ -0,0 +1,1277 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+#include "anytime_planner.h"
+#include "cluster_graph.h"
+#include "contraction_hierarchy.h"
+#include "incremental_planner.h"
+#include "landmark_heuristic.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "path_cache.h"
+#include "path_query_service.h"
+#include "search_state.h"
+#include "search_task.h"
+#include "thread_pool.h"
+
+namespace astar
+{
+    template<typename T>
+    struct Ref
+    {
+        Ref(T& t) : ref{ t } {}
+
+        bool operator == (const T& rhs) const
+        {
+            return ref == rhs;
+        }
+
+        bool operator == (const Ref& rhs) const
+        {
+            return ref == rhs.ref;
+        }
+
+        bool operator != (const T& rhs) const
+        {
+            return ref != rhs;
+        }
+
+        bool operator != (const Ref& rhs) const
+        {
+            return ref != rhs.ref;
+        }
+
+        T* operator->() { return &ref; }
+
+        operator T& () const
+        {
+            return ref;
+        }
+
+        T& ref;
+    };
+
+
+    struct GenericPathFinder
+    {
+        using NodeId = size_t;
+        struct Link
+        {
+            NodeId toNodeId;
+            NodeId fromNodeId;
+        };
+
+        struct PathResult
+        {
+            bool found;
+            std::vector<NodeId> path;
+        };
+
+        GenericPathFinder()
+            : m_latestNodeId{ 0 }
+            , m_linkIndexDirty{ true }
+            , m_linkCostDirty{ true }
+            , m_graphVersion{ 0 }
+        {
+
+        }
+
+        ~GenericPathFinder()
+        {
+            for (auto it : m_linkList)
+            {
+                delete it;
+            }
+        }
+
+        NodeId AllocNodeId()
+        {
+            NodeId newNodeId = m_latestNodeId += 1;
+            AllocNodeIndex(newNodeId);
+            return newNodeId;
+        }
+
+        NodeId AllocNodeId(NodeId id)
+        {
+            if (m_nodeSet.count(id) != 0)
+                return 0;
+
+            m_latestNodeId = std::max(m_latestNodeId, id);
+            AllocNodeIndex(id);
+            return id;
+        }
+
+        Link* MakeLink(NodeId toNodeId, NodeId fromNodeId)
+        {
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            if (toIndex == invalidIndex || fromIndex == invalidIndex)
+                return nullptr;
+
+            const uint64_t key = LinkKey(fromIndex, toIndex);
+            if (m_linkTable.count(key) != 0)
+                return nullptr;
+
+            auto link = new Link{};
+            link->toNodeId = toNodeId;
+            link->fromNodeId = fromNodeId;
+            m_linkTable.insert(key, link);
+            m_linkList.push_back(link);
+            m_linkIndexDirty = true;
+            m_graphVersion += 1;
+            return link;
+        }
+
+        void FreeNode(NodeId nodeId)
+        {
+            auto itSet = m_nodeSet.find(nodeId);
+            if (itSet == m_nodeSet.end())
+                return;
+
+            // 간선 키가 노드 인덱스로 되어 있으므로 인덱스를 돌려주기 전에 지운다.
+            auto it = m_linkList.begin();
+            while (it != m_linkList.end())
+            {
+                auto link = *it;
+                if (link->toNodeId != nodeId && link->fromNodeId != nodeId)
+                {
+                    ++it;
+                    continue;
+                }
+
+                EraseLinkKey(link);
+                it = m_linkList.erase(it);
+                delete link;
+            }
+
+            FreeNodeIndex(itSet);
+        }
+
+        void RemoveLink(Link* link)
+        {
+            auto it = std::find(m_linkList.begin(), m_linkList.end(), link);
+            if (it == m_linkList.end())
+                return;
+
+            EraseLinkKey(link);
+            delete link;
+            m_linkList.erase(it);
+            m_linkIndexDirty = true;
+            m_graphVersion += 1;
+        }
+
+        // 노드 좌표처럼 FuncterG가 참조하는 값이 바뀌었을 때 호출한다.
+        void InvalidateLinkCost()
+        {
+            m_linkCostDirty = true;
+            m_graphVersion += 1;
+        }
+
+        void CollectLinkedNode(NodeId nodeId, std::vector<std::pair<NodeId, Link*>>* result)
+        {
+            result->clear();
+            const uint32_t row = FindNodeIndex(nodeId);
+            if (row == invalidIndex)
+                return;
+
+            UpdateLinkIndex();
+            const uint32_t end = m_linkIndex.End(row);
+            for (uint32_t i = m_linkIndex.Begin(row); i != end; ++i)
+            {
+                result->emplace_back(m_indexToNodeId[m_linkIndex.targets[i]], m_linkList[m_linkIndex.edges[i]]);
+            }
+        }
+
+        void ReserveNode(size_t count)
+        {
+            m_nodeSet.reserve(count);
+            m_indexToNodeId.reserve(count);
+        }
+
+        // 비어 있는 finder에 노드와 간선을 한 번에 넣는다. 바이너리 지도처럼 이미 검증된 CSR을 읽을 때 쓴다.
+        // nodeIds는 오름차순이고 0이 없어야 한다. 행 r의 간선은 nodeIds[r]에서 nodeIds[linkTargets[i]]로 간다.
+        // 간선마다 MakeLink를 부르지 않고 CSR을 그대로 간선 인덱스로 쓴다. 중복 간선은 거르지 않고 그대로 넣는다.
+        bool LoadGraph(size_t nodeCount, const uint64_t* nodeIds, const uint32_t* linkOffsets, const uint32_t* linkTargets)
+        {
+            if (!m_indexToNodeId.empty() || !m_linkList.empty())
+                return false;
+
+            for (size_t i = 0; i < nodeCount; ++i)
+            {
+                if (nodeIds[i] == 0 || (i != 0 && nodeIds[i - 1] >= nodeIds[i]))
+                    return false;
+            }
+
+            ReserveNode(nodeCount);
+            for (size_t i = 0; i < nodeCount; ++i)
+            {
+                AllocNodeId(static_cast<NodeId>(nodeIds[i]));
+            }
+
+            const size_t linkCount = linkOffsets[nodeCount];
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> destinations(linkTargets, linkTargets + linkCount);
+            sources.reserve(linkCount);
+            m_linkList.reserve(linkCount);
+            m_linkTable.reserve(linkCount);
+            for (uint32_t row = 0; row < nodeCount; ++row)
+            {
+                for (uint32_t i = linkOffsets[row]; i != linkOffsets[row + 1]; ++i)
+                {
+                    sources.push_back(row);
+                    auto link = new Link{ static_cast<NodeId>(nodeIds[linkTargets[i]]), static_cast<NodeId>(nodeIds[row]) };
+                    m_linkList.push_back(link);
+                    m_linkTable.insert(LinkKey(row, linkTargets[i]), link);
+                }
+            }
+
+            m_linkIndex.offsets.assign(linkOffsets, linkOffsets + nodeCount + 1);
+            m_linkIndex.targets = destinations;
+            m_linkIndex.edges.resize(linkCount);
+            for (uint32_t i = 0; i < linkCount; ++i)
+            {
+                m_linkIndex.edges[i] = i;
+            }
+
+            m_linkIndex.weights.assign(linkCount, 0.f);
+            m_reverseLinkIndex.Build(nodeCount, destinations, sources);
+            m_linkIndexDirty = false;
+            m_linkCostDirty = true;
+            m_graphVersion += 1;
+            return true;
+        }
+
+        // 노드 인덱스는 노드가 해제될 때까지 바뀌지 않는다. 해제된 인덱스는 재사용된다.
+        uint32_t FindNodeIndex(NodeId nodeId) const
+        {
+            auto it = m_nodeSet.find(nodeId);
+            if (it == m_nodeSet.end())
+                return invalidIndex;
+
+            return it->value;
+        }
+
+        NodeId GetNodeId(uint32_t index) const
+        {
+            return m_indexToNodeId[index];
+        }
+
+        size_t GetNodeIndexCount() const
+        {
+            return m_indexToNodeId.size();
+        }
+
+        // 노드, 간선, 간선 비용이 바뀔 때마다 증가한다. 전처리 결과나 경로 캐시가 최신인지 확인할 때 쓴다.
+        uint64_t GetGraphVersion() const
+        {
+            return m_graphVersion;
+        }
+
+        // Navigate와 NavigateBatch의 결과를 (출발, 도착) 쌍으로 capacity개까지 저장한다.
+        // 그래프 버전이 바뀌면 저장된 경로는 모두 버려진다.
+        void EnablePathCache(size_t capacity)
+        {
+            if (m_pathCache == nullptr)
+            {
+                m_pathCache = std::make_unique<PathCache>(capacity);
+            }
+            else
+            {
+                m_pathCache->SetCapacity(capacity);
+            }
+        }
+
+        void DisablePathCache()
+        {
+            m_pathCache.reset();
+        }
+
+        // 캐시를 켜지 않았으면 nullptr
+        PathCache* GetPathCache() const
+        {
+            return m_pathCache.get();
+        }
+
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    protected:
+        void AllocNodeIndex(NodeId nodeId)
+        {
+            uint32_t index;
+            if (!m_freeIndexList.empty())
+            {
+                index = m_freeIndexList.back();
+                m_freeIndexList.pop_back();
+                m_indexToNodeId[index] = nodeId;
+            }
+            else
+            {
+                index = static_cast<uint32_t>(m_indexToNodeId.size());
+                m_indexToNodeId.push_back(nodeId);
+                if (!m_linkIndexDirty)
+                {
+                    // 간선이 없는 행을 끝에 붙이기만 하면 된다.
+                    m_linkIndex.offsets.push_back(m_linkIndex.offsets.back());
+                    m_reverseLinkIndex.offsets.push_back(m_reverseLinkIndex.offsets.back());
+                }
+            }
+
+            m_nodeSet.insert(nodeId, index);
+            m_graphVersion += 1;
+        }
+
+        void FreeNodeIndex(NodeIdMap<uint32_t>::Iter it)
+        {
+            m_indexToNodeId[it->value] = 0;
+            m_freeIndexList.push_back(it->value);
+            m_nodeSet.erase(it);
+            m_linkIndexDirty = true;
+            m_graphVersion += 1;
+        }
+
+        // 노드 인덱스는 32비트이므로 방향 있는 간선 하나를 64비트 키 하나로 나타낼 수 있다.
+        static uint64_t LinkKey(uint32_t fromIndex, uint32_t toIndex)
+        {
+            return (static_cast<uint64_t>(fromIndex) << 32) | toIndex;
+        }
+
+        // LoadGraph로 넣은 중복 간선은 표에 먼저 넣은 것만 있으므로 link 자신일 때만 지운다.
+        void EraseLinkKey(Link* link)
+        {
+            const uint64_t key = LinkKey(FindNodeIndex(link->fromNodeId), FindNodeIndex(link->toNodeId));
+            Link** value = m_linkTable.get(key);
+            if (value != nullptr && *value == link)
+            {
+                m_linkTable.erase(key);
+            }
+        }
+
+        // 그래프가 바뀐 뒤 처음 질의할 때 CSR 인덱스를 다시 만든다.
+        void UpdateLinkIndex()
+        {
+            if (!m_linkIndexDirty)
+                return;
+
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> destinations;
+            sources.reserve(m_linkList.size());
+            destinations.reserve(m_linkList.size());
+            for (auto link : m_linkList)
+            {
+                sources.push_back(FindNodeIndex(link->fromNodeId));
+                destinations.push_back(FindNodeIndex(link->toNodeId));
+            }
+
+            m_linkIndex.Build(m_indexToNodeId.size(), sources, destinations);
+            m_reverseLinkIndex.Build(m_indexToNodeId.size(), destinations, sources);
+            m_linkIndexDirty = false;
+            m_linkCostDirty = true;
+        }
+
+    public:
+        size_t m_latestNodeId;
+        // NodeId -> 노드 인덱스
+        NodeIdMap<uint32_t> m_nodeSet;
+        std::vector<Link*> m_linkList;
+
+    protected:
+        // (출발 노드 인덱스, 도착 노드 인덱스) -> 간선. MakeLink가 중복 간선을 거를 때 쓴다.
+        NodeIdMap<Link*, uint64_t> m_linkTable;
+        CsrAdjacency m_linkIndex;
+        // 간선 방향을 뒤집은 인덱스. weights는 원래 간선의 비용이다.
+        CsrAdjacency m_reverseLinkIndex;
+        std::vector<NodeId> m_indexToNodeId;
+        std::vector<uint32_t> m_freeIndexList;
+        bool m_linkIndexDirty;
+        bool m_linkCostDirty;
+        uint64_t m_graphVersion;
+        std::unique_ptr<PathCache> m_pathCache;
+    };
+
+    // TSearchTrace는 컨텍스트를 넘기지 않은 질의(m_context)가 쓰는 추적기이다. SearchTrace를 넣으면 GetTrace로 통계를 볼 수 있다.
+    template<typename TFuncterG, typename TFuncterH, typename TOpenList = QuadHeapOpenList, typename TSearchTrace = NullSearchTrace>
+    class TGenericPathFinder: public GenericPathFinder
+    {
+    public:
+        template<typename ArgFuncterG, typename ArgFuncterH>
+        TGenericPathFinder(ArgFuncterG&& g, ArgFuncterH&& h)
+            : m_functerG{std::forward<ArgFuncterG>(g)}
+            , m_functerH{std::forward<ArgFuncterH>(h)}
+        {
+
+        }
+
+        bool Navigate(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, SearchMode mode = SearchMode::Unidirectional)
+        {
+            return Navigate(fromNodeId, toNodeId, result, m_context, mode);
+        }
+
+        template<typename TContextOpenList, typename TContextTrace>
+        bool Navigate(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context, SearchMode mode = SearchMode::Unidirectional)
+        {
+            UpdateLinkCost();
+            return CachedSearch(fromNodeId, toNodeId, result, context, mode);
+        }
+
+        // 여러 질의를 스레드 풀에서 나눠 처리한다. 처리하는 동안 그래프를 바꾸면 안 된다.
+        // results는 queries와 같은 크기로 맞춰지고, 이전에 쓰던 경로 버퍼는 재사용된다.
+        void NavigateBatch(std::span<const std::pair<NodeId, NodeId>> queries, std::vector<PathResult>* results, SearchMode mode = SearchMode::Unidirectional)
+        {
+            if (m_threadPool == nullptr)
+            {
+                m_threadPool = std::make_unique<ThreadPool>();
+            }
+
+            NavigateBatch(queries, results, *m_threadPool, mode);
+        }
+
+        void NavigateBatch(std::span<const std::pair<NodeId, NodeId>> queries, std::vector<PathResult>* results, ThreadPool& pool, SearchMode mode = SearchMode::Unidirectional)
+        {
+            UpdateLinkCost();
+            while (m_workerContexts.size() < pool.GetWorkerCount())
+            {
+                m_workerContexts.push_back(std::make_unique<PathQueryContext<TOpenList>>());
+            }
+
+            results->resize(queries.size());
+            pool.ParallelFor(queries.size(), [this, queries, results, mode](unsigned workerIndex, size_t index)
+                {
+                    auto& query = queries[index];
+                    auto& result = (*results)[index];
+                    result.found = CachedSearch(query.first, query.second, &result.path, *m_workerContexts[workerIndex], mode);
+                });
+        }
+
+        // 현재 그래프와 간선 비용으로 Contraction Hierarchy를 만든다.
+        // 이후 그래프나 비용이 바뀌면 NavigateHierarchy는 다시 만들 때까지 Navigate로 처리한다.
+        void BuildContractionHierarchy()
+        {
+            if (m_threadPool == nullptr)
+            {
+                m_threadPool = std::make_unique<ThreadPool>();
+            }
+
+            BuildContractionHierarchy(*m_threadPool);
+        }
+
+        void BuildContractionHierarchy(ThreadPool& pool)
+        {
+            UpdateLinkCost();
+            m_contractionHierarchy.Build(m_linkIndex, &pool);
+            m_contractionHierarchyVersion = m_graphVersion;
+        }
+
+        bool IsContractionHierarchyValid() const
+        {
+            return m_contractionHierarchy.IsBuilt() && m_contractionHierarchyVersion == m_graphVersion;
+        }
+
+        const ContractionHierarchy& GetContractionHierarchy() const
+        {
+            return m_contractionHierarchy;
+        }
+
+        // LandmarkHeuristic에 넘길 거리표를 현재 그래프와 간선 비용으로 만든다.
+        std::shared_ptr<const LandmarkTable> BuildLandmarkTable(uint32_t landmarkCount, LandmarkSelection selection = LandmarkSelection::Avoid)
+        {
+            if (m_threadPool == nullptr)
+            {
+                m_threadPool = std::make_unique<ThreadPool>();
+            }
+
+            return BuildLandmarkTable(landmarkCount, selection, *m_threadPool);
+        }
+
+        std::shared_ptr<const LandmarkTable> BuildLandmarkTable(uint32_t landmarkCount, LandmarkSelection selection, ThreadPool& pool)
+        {
+            UpdateLinkCost();
+            return LandmarkTable::Build(m_linkIndex, m_reverseLinkIndex, m_indexToNodeId, landmarkCount, selection, &pool);
+        }
+
+        // 마지막으로 m_context를 쓴 질의의 추적 결과. 경로 캐시에서 찾은 질의는 추적하지 않는다.
+        TSearchTrace& GetTrace()
+        {
+            return m_context.trace;
+        }
+
+        const TSearchTrace& GetTrace() const
+        {
+            return m_context.trace;
+        }
+
+        TFuncterH& GetFuncterH()
+        {
+            return m_functerH;
+        }
+
+        // 출발점과 도착점을 고정한 증분 탐색(LPA*)을 시작한다.
+        // 이후 InvalidateNodeLinkCost로 바뀐 노드를 알리고 Replan을 부르면 바뀐 부분만 다시 계산한다.
+        bool BeginReplan(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result)
+        {
+            UpdateLinkCost();
+            m_plannerFromNodeId = fromNodeId;
+            m_plannerToNodeId = toNodeId;
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == invalidIndex || toIndex == invalidIndex)
+            {
+                m_planner.Deactivate();
+                result->clear();
+                return false;
+            }
+
+            m_planner.Reset(m_linkIndex, m_reverseLinkIndex, fromIndex, toIndex, PlannerH());
+            m_plannerVersion = m_graphVersion;
+            return Replan(result);
+        }
+
+        void EndReplan()
+        {
+            m_planner.Deactivate();
+        }
+
+        bool IsReplanning() const
+        {
+            return m_planner.IsActive();
+        }
+
+        const IncrementalPlanner& GetPlanner() const
+        {
+            return m_planner;
+        }
+
+        bool Replan(std::vector<NodeId>* result)
+        {
+            result->clear();
+            if (!m_planner.IsActive())
+                return false;
+
+            // 간선이 추가/삭제되었거나 비용 전체가 바뀌었으면 처음부터 다시 한다.
+            if (m_plannerVersion != m_graphVersion)
+                return BeginReplan(m_plannerFromNodeId, m_plannerToNodeId, result);
+
+            if (!m_planner.ComputeShortestPath(PlannerH()))
+                return false;
+
+            // 비용이 0인 간선 때문에 상태가 어긋났으면 처음부터 다시 계산한다.
+            if (!m_planner.ExtractPath(&m_plannerPath))
+            {
+                m_planner.Reset(m_linkIndex, m_reverseLinkIndex, m_planner.GetFromIndex(), m_planner.GetToIndex(), PlannerH());
+                if (!m_planner.ComputeShortestPath(PlannerH()) || !m_planner.ExtractPath(&m_plannerPath))
+                    return Search(m_plannerFromNodeId, m_plannerToNodeId, result, m_context, SearchMode::Unidirectional);
+            }
+
+            for (auto it : m_plannerPath)
+            {
+                result->push_back(m_indexToNodeId[it]);
+            }
+
+            return true;
+        }
+
+        // ARA*로 initialWeight배 이내의 경로를 먼저 찾고, ImproveAnytime을 부를 때마다 가중치를 weightStep씩 줄여서 경로를 고친다.
+        // FuncterH가 consistent해야 보장 배율이 맞다.
+        bool BeginAnytime(NodeId fromNodeId, NodeId toNodeId, float initialWeight = 2.f, float weightStep = 0.5f)
+        {
+            UpdateLinkCost();
+            m_anytimeFromNodeId = fromNodeId;
+            m_anytimeToNodeId = toNodeId;
+            m_anytimeInitialWeight = initialWeight;
+            m_anytimeWeightStep = weightStep;
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == invalidIndex || toIndex == invalidIndex || fromIndex == toIndex)
+            {
+                m_anytimePlanner.Deactivate();
+                return false;
+            }
+
+            m_anytimePlanner.Reset(m_linkIndex, fromIndex, toIndex, initialWeight, weightStep, AnytimeH());
+            m_anytimeVersion = m_graphVersion;
+            return true;
+        }
+
+        // deadline까지 탐색을 이어 간다. 새 경로가 나오면 result와 bound(경로 비용 / 최단 경로 비용의 상한)를 채우고 true.
+        // deadline에 걸려 멈췄으면 false이고 다음 호출에서 이어서 탐색한다.
+        bool ImproveAnytime(std::chrono::steady_clock::time_point deadline, std::vector<NodeId>* result, float* bound)
+        {
+            if (!m_anytimePlanner.IsActive())
+                return false;
+
+            // 그래프가 바뀌었으면 이전 g 값을 믿을 수 없으므로 처음 가중치부터 다시 한다.
+            if (m_anytimeVersion != m_graphVersion && !BeginAnytime(m_anytimeFromNodeId, m_anytimeToNodeId, m_anytimeInitialWeight, m_anytimeWeightStep))
+                return false;
+
+            if (!m_anytimePlanner.Improve(AnytimeH(), deadline))
+                return false;
+
+            m_anytimePlanner.ExtractPath(&m_anytimePath);
+            result->clear();
+            for (auto it : m_anytimePath)
+            {
+                result->push_back(m_indexToNodeId[it]);
+            }
+
+            *bound = m_anytimePlanner.GetBound();
+            return true;
+        }
+
+        void EndAnytime()
+        {
+            m_anytimePlanner.Deactivate();
+        }
+
+        bool IsAnytimeActive() const
+        {
+            return m_anytimePlanner.IsActive();
+        }
+
+        // 최단 경로를 찾았거나 경로가 없다고 확인해서 더 고칠 것이 없다.
+        bool IsAnytimeFinished() const
+        {
+            return m_anytimePlanner.IsFinished();
+        }
+
+        const AnytimePlanner& GetAnytimePlanner() const
+        {
+            return m_anytimePlanner;
+        }
+
+        // deadline까지 경로를 찾아 고치면서 경로가 나올 때마다 onSolution(path, bound)를 부른다.
+        // onSolution이 false를 돌려주면 멈춘다. 경로를 하나라도 찾았으면 true.
+        // 끝난 뒤에도 탐색 상태가 남아 있으므로 시간이 더 나면 ImproveAnytime으로 이어서 고칠 수 있다.
+        template<typename TFunc>
+        bool NavigateAnytime(NodeId fromNodeId, NodeId toNodeId, std::chrono::steady_clock::time_point deadline, TFunc&& onSolution, float initialWeight = 2.f, float weightStep = 0.5f)
+        {
+            std::vector<NodeId> path;
+            if (fromNodeId == toNodeId)
+            {
+                if (FindNodeIndex(fromNodeId) == invalidIndex)
+                    return false;
+
+                path.push_back(fromNodeId);
+                onSolution(path, 1.f);
+                return true;
+            }
+
+            if (!BeginAnytime(fromNodeId, toNodeId, initialWeight, weightStep))
+                return false;
+
+            bool found = false;
+            float bound = 0.f;
+            while (!m_anytimePlanner.IsFinished() && std::chrono::steady_clock::now() < deadline)
+            {
+                if (!ImproveAnytime(deadline, &path, &bound))
+                {
+                    // 그래프가 바뀐 뒤 다시 시작하지 못해서 비활성이 됐으면 더 고칠 것이 없다.
+                    // 그렇지 않으면 deadline에 걸린 것이므로 조건을 다시 확인하고 끝난다.
+                    if (!m_anytimePlanner.IsActive())
+                        break;
+
+                    continue;
+                }
+
+                found = true;
+                if (!onSolution(path, bound))
+                    break;
+            }
+
+            return found;
+        }
+
+        // Navigate와 같은 A* 질의를 Step으로 나눠 진행하는 작업으로 만든다. SearchScheduler에 넣어서 프레임마다 조금씩 돌릴 수 있다.
+        // 진행하는 동안 그래프나 간선 비용이 바뀌면 다음 Step에서 처음부터 다시 탐색한다.
+        std::unique_ptr<SearchTask> CreateSearchTask(NodeId fromNodeId, NodeId toNodeId)
+        {
+            return std::make_unique<Task>(*this, fromNodeId, toNodeId);
+        }
+
+        // PathQueryService에 넘길 수 있게 간선 비용까지 계산한 그래프를 복사한다.
+        // position(NodeId, float* x, float* y)로 휴리스틱에 쓸 노드 좌표를 채운다.
+        template<typename TFunc>
+        std::shared_ptr<const GraphSnapshot> CreateGraphSnapshot(TFunc&& position)
+        {
+            UpdateLinkCost();
+            auto snapshot = std::make_shared<GraphSnapshot>();
+            snapshot->version = m_graphVersion;
+            snapshot->linkIndex = m_linkIndex;
+            snapshot->indexToNodeId = m_indexToNodeId;
+            snapshot->nodeSet = m_nodeSet;
+            snapshot->x.resize(m_indexToNodeId.size());
+            snapshot->y.resize(m_indexToNodeId.size());
+            for (size_t i = 0; i < m_indexToNodeId.size(); ++i)
+            {
+                position(m_indexToNodeId[i], &snapshot->x[i], &snapshot->y[i]);
+            }
+
+            return snapshot;
+        }
+
+        // nodeId에 붙은 간선의 비용만 FuncterG로 다시 계산한다.
+        // 노드 하나의 위치처럼 그 노드의 간선에만 영향을 주는 값이 바뀌었을 때 InvalidateLinkCost 대신 쓴다.
+        void InvalidateNodeLinkCost(NodeId nodeId)
+        {
+            const bool plannerSynced = m_planner.IsActive() && m_plannerVersion == m_graphVersion;
+            m_graphVersion += 1;
+            const uint32_t index = FindNodeIndex(nodeId);
+            if (index == invalidIndex || m_linkIndexDirty || m_linkCostDirty)
+            {
+                m_linkCostDirty = true;
+                return;
+            }
+
+            uint32_t end = m_linkIndex.End(index);
+            for (uint32_t i = m_linkIndex.Begin(index); i != end; ++i)
+            {
+                const uint32_t target = m_linkIndex.targets[i];
+                const float cost = m_functerG(nodeId, m_indexToNodeId[target], m_linkList[m_linkIndex.edges[i]]);
+                m_linkIndex.weights[i] = cost;
+                SetLinkCost(&m_reverseLinkIndex, target, m_linkIndex.edges[i], cost);
+            }
+
+            end = m_reverseLinkIndex.End(index);
+            for (uint32_t i = m_reverseLinkIndex.Begin(index); i != end; ++i)
+            {
+                const uint32_t source = m_reverseLinkIndex.targets[i];
+                const float cost = m_functerG(m_indexToNodeId[source], nodeId, m_linkList[m_reverseLinkIndex.edges[i]]);
+                m_reverseLinkIndex.weights[i] = cost;
+                SetLinkCost(&m_linkIndex, source, m_reverseLinkIndex.edges[i], cost);
+            }
+
+            // 도착점이 움직이면 휴리스틱이 전부 바뀌므로 다음 Replan에서 처음부터 다시 한다.
+            if (plannerSynced && nodeId != m_plannerToNodeId)
+            {
+                m_planner.UpdateVertex(index, PlannerH());
+                end = m_linkIndex.End(index);
+                for (uint32_t i = m_linkIndex.Begin(index); i != end; ++i)
+                {
+                    m_planner.UpdateVertex(m_linkIndex.targets[i], PlannerH());
+                }
+
+                m_plannerVersion = m_graphVersion;
+            }
+        }
+
+        bool NavigateHierarchy(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result)
+        {
+            return NavigateHierarchy(fromNodeId, toNodeId, result, m_context);
+        }
+
+        template<typename TContextOpenList, typename TContextTrace>
+        bool NavigateHierarchy(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context)
+        {
+            if (!IsContractionHierarchyValid())
+                return Navigate(fromNodeId, toNodeId, result, context);
+
+            result->clear();
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == invalidIndex || toIndex == invalidIndex)
+                return false;
+
+            if (fromIndex == toIndex)
+            {
+                result->push_back(fromNodeId);
+                return true;
+            }
+
+            return m_contractionHierarchy.Query(fromIndex, toIndex, context, [this, result](uint32_t index)
+                {
+                    result->push_back(m_indexToNodeId[index]);
+                });
+        }
+
+        // position(NodeId, float* x, float* y)로 받은 좌표를 options.clusterSize 격자로 나눠 HPA* 추상 그래프를 만든다.
+        // 이후 그래프나 비용이 바뀌면 NavigateClustered가 다음 질의 전에 추상 그래프를 다시 만든다. 스냅샷 복사, 역방향 인덱스,
+        // 경계 간선 정렬(SelectTransitions)은 고칠 때마다 O(N+E)로 전부 다시 하고, 군집 안의 Dijkstra만 바뀐 군집에 대해서 다시 돈다.
+        template<typename TFunc>
+        void BuildClusterGraph(TFunc&& position, const ClusterGraph::Options& options)
+        {
+            m_clusterPosition = std::forward<TFunc>(position);
+            m_clusterOptions = options;
+            m_clusterGraph.Clear();
+            UpdateClusterGraph();
+        }
+
+        const ClusterGraph& GetClusterGraph() const
+        {
+            return m_clusterGraph;
+        }
+
+        bool NavigateClustered(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result)
+        {
+            return NavigateClustered(fromNodeId, toNodeId, result, m_context);
+        }
+
+        template<typename TContextOpenList, typename TContextTrace>
+        bool NavigateClustered(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context)
+        {
+            if (!m_clusterPosition)
+                return Navigate(fromNodeId, toNodeId, result, context);
+
+            UpdateClusterGraph();
+            if (m_clusterGraph.Query(fromNodeId, toNodeId, context, result))
+                return true;
+
+            // 경계 간선을 줄였으면 추상 그래프로는 끊겨 보여도 실제로는 이어져 있을 수 있다.
+            if (m_clusterOptions.maxTransitionsPerPair == 0)
+                return false;
+
+            return Navigate(fromNodeId, toNodeId, result, context);
+        }
+
+    private:
+        void UpdateClusterGraph()
+        {
+            if (m_clusterGraph.IsBuilt() && m_clusterGraphVersion == m_graphVersion)
+                return;
+
+            if (m_threadPool == nullptr)
+            {
+                m_threadPool = std::make_unique<ThreadPool>();
+            }
+
+            m_clusterGraph.Build(CreateGraphSnapshot(m_clusterPosition), m_clusterOptions, m_threadPool.get());
+            m_clusterGraphVersion = m_graphVersion;
+        }
+
+        class Task : public SearchTask
+        {
+        public:
+            Task(TGenericPathFinder& finder, NodeId fromNodeId, NodeId toNodeId)
+                : m_finder{ finder }
+                , m_fromNodeId{ fromNodeId }
+                , m_toNodeId{ toNodeId }
+                , m_toIndex{ invalidIndex }
+                , m_version{ 0 }
+                , m_started{ false }
+            {
+
+            }
+
+            SearchTaskState Step(size_t maxExpansions, std::chrono::steady_clock::time_point deadline) override
+            {
+                constexpr size_t deadlineCheckInterval = 64;
+                if (m_state != SearchTaskState::Running)
+                    return m_state;
+
+                if (!m_started || m_version != m_finder.m_graphVersion)
+                {
+                    Restart();
+                    if (m_state != SearchTaskState::Running)
+                        return m_state;
+                }
+
+                auto funcH = [this](uint32_t index)
+                {
+                    return m_finder.m_functerH(m_finder.m_indexToNodeId[index], m_toNodeId);
+                };
+
+                const CsrAdjacency& linkIndex = m_finder.m_linkIndex;
+                auto& slots = m_context.slots;
+                auto& openList = m_context.openList;
+                for (size_t count = 0; count < maxExpansions; ++count)
+                {
+                    if (count != 0 && count % deadlineCheckInterval == 0 && std::chrono::steady_clock::now() >= deadline)
+                        break;
+
+                    if (openList.Empty())
+                    {
+                        m_state = SearchTaskState::NotFound;
+                        break;
+                    }
+
+                    const uint32_t selIndex = openList.Pop();
+                    m_expandedCount += 1;
+                    if (selIndex == m_toIndex)
+                    {
+                        // 끝난 뒤에 그래프가 바뀌어도 결과가 남도록 NodeId로 바꿔 둔다.
+                        for (uint32_t it = m_toIndex; it != SearchSlotTable::npos; it = slots[it].prev)
+                        {
+                            m_path.push_back(m_finder.m_indexToNodeId[it]);
+                        }
+
+                        std::reverse(m_path.begin(), m_path.end());
+                        m_state = SearchTaskState::Found;
+                        break;
+                    }
+
+                    const float selG = slots[selIndex].g;
+                    const uint32_t end = linkIndex.End(selIndex);
+                    for (uint32_t i = linkIndex.Begin(selIndex); i != end; ++i)
+                    {
+                        const uint32_t nodeIndex = linkIndex.targets[i];
+                        SearchSlot& node = slots.Touch(nodeIndex, funcH);
+                        const float g = linkIndex.weights[i] + selG;
+                        if (node.g <= g)
+                            continue;
+
+                        node.g = g;
+                        node.prev = selIndex;
+                        openList.Push(nodeIndex, g + node.h);
+                    }
+                }
+
+                return m_state;
+            }
+
+            bool GetPath(std::vector<size_t>* result) const override
+            {
+                result->assign(m_path.begin(), m_path.end());
+                return m_state == SearchTaskState::Found;
+            }
+
+        private:
+            void Restart()
+            {
+                m_finder.UpdateLinkCost();
+                m_started = true;
+                m_version = m_finder.m_graphVersion;
+                m_expandedCount = 0;
+                const uint32_t fromIndex = m_finder.FindNodeIndex(m_fromNodeId);
+                m_toIndex = m_finder.FindNodeIndex(m_toNodeId);
+                if (fromIndex == invalidIndex || m_toIndex == invalidIndex)
+                {
+                    m_state = SearchTaskState::NotFound;
+                    return;
+                }
+
+                if (fromIndex == m_toIndex)
+                {
+                    m_path.assign(1, m_fromNodeId);
+                    m_state = SearchTaskState::Found;
+                    return;
+                }
+
+                auto funcH = [this](uint32_t index)
+                {
+                    return m_finder.m_functerH(m_finder.m_indexToNodeId[index], m_toNodeId);
+                };
+
+                const size_t nodeCount = m_finder.m_indexToNodeId.size();
+                m_context.slots.BeginQuery(nodeCount);
+                m_context.openList.Clear();
+                m_context.openList.Reserve(nodeCount);
+                SearchSlot& from = m_context.slots.Touch(fromIndex, funcH);
+                from.g = 0.f;
+                m_context.openList.Push(fromIndex, from.h);
+            }
+
+            TGenericPathFinder& m_finder;
+            NodeId m_fromNodeId;
+            NodeId m_toNodeId;
+            uint32_t m_toIndex;
+            uint64_t m_version;
+            bool m_started;
+            PathQueryContext<TOpenList> m_context;
+            std::vector<NodeId> m_path;
+        };
+
+        auto AnytimeH() const
+        {
+            return [this](uint32_t index)
+            {
+                return m_functerH(m_indexToNodeId[index], m_anytimeToNodeId);
+            };
+        }
+
+        auto PlannerH() const
+        {
+            return [this](uint32_t index)
+            {
+                return m_functerH(m_indexToNodeId[index], m_plannerToNodeId);
+            };
+        }
+
+        static void SetLinkCost(CsrAdjacency* linkIndex, uint32_t row, uint32_t edge, float cost)
+        {
+            const uint32_t end = linkIndex->End(row);
+            for (uint32_t i = linkIndex->Begin(row); i != end; ++i)
+            {
+                if (linkIndex->edges[i] == edge)
+                {
+                    linkIndex->weights[i] = cost;
+                    return;
+                }
+            }
+        }
+
+        template<typename TContextOpenList, typename TContextTrace>
+        bool CachedSearch(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context, SearchMode mode) const
+        {
+            if (m_pathCache == nullptr)
+                return Search(fromNodeId, toNodeId, result, context, mode);
+
+            return m_pathCache->Find(fromNodeId, toNodeId, m_graphVersion, result, [&](std::vector<NodeId>* path)
+                {
+                    return Search(fromNodeId, toNodeId, path, context, mode);
+                });
+        }
+
+        // 그래프를 읽기만 하므로 컨텍스트가 다르면 여러 스레드에서 동시에 불러도 된다.
+        template<typename TContextOpenList, typename TContextTrace>
+        bool Search(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context, SearchMode mode) const
+        {
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == invalidIndex || toIndex == invalidIndex)
+                return false;
+
+            auto& trace = context.trace;
+            if (fromIndex == toIndex)
+            {
+                trace.BeginQuery(fromIndex, toIndex);
+                trace.OnExpand(fromIndex);
+                result->assign(1, fromNodeId);
+                return trace.EndQuery(true);
+            }
+
+            // 평균 포텐셜 키는 음수가 될 수 있어서 radix 힙으로는 순서대로 꺼내지 못한다.
+            if constexpr (!IsMonotoneOpenList<TContextOpenList>::value)
+            {
+                if (mode == SearchMode::Bidirectional)
+                    return SearchBidirectional(fromNodeId, toNodeId, result, context);
+            }
+
+            auto funcH = [this, toNodeId, &trace](uint32_t index)
+            {
+                trace.OnHeuristic(1);
+                return m_functerH(m_indexToNodeId[index], toNodeId);
+            };
+
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            trace.BeginQuery(fromIndex, toIndex);
+            slots.BeginQuery(m_indexToNodeId.size());
+            SearchSlot& from = slots.Touch(fromIndex, funcH);
+            from.g = 0.f;
+            openList.Clear();
+            openList.Reserve(m_indexToNodeId.size());
+            openList.Push(fromIndex, from.h);
+            do {
+                if (openList.Empty())
+                    return trace.EndQuery(false);
+
+                const uint32_t selIndex = openList.Pop();
+                trace.OnExpand(selIndex);
+                if (selIndex == toIndex)
+                    break;
+
+                const float selG = slots[selIndex].g;
+                const uint32_t end = m_linkIndex.End(selIndex);
+                for (uint32_t i = m_linkIndex.Begin(selIndex); i != end; ++i)
+                {
+                    const uint32_t nodeIndex = m_linkIndex.targets[i];
+                    SearchSlot& node = slots.Touch(nodeIndex, funcH);
+                    if (node.prev == selIndex)
+                        continue;
+
+                    float g = m_linkIndex.weights[i] + selG;
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    // 이미 열린 목록에 있으면 키만 갱신된다.
+                    openList.Push(nodeIndex, g + node.h);
+                    trace.OnRelax(nodeIndex, openList.Size());
+                }
+            } while (true);
+
+            result->clear();
+            {
+                uint32_t it = toIndex;
+                while (it != SearchSlotTable::npos)
+                {
+                    result->push_back(m_indexToNodeId[it]);
+                    it = slots[it].prev;
+                }
+
+                std::reverse(result->begin(), result->end());
+            }
+
+            return trace.EndQuery(true);
+        }
+
+        // 두 방향 모두 평균 포텐셜 pf(v) = (h(v, to) - h(from, v)) / 2 를 쓴다(역방향은 -pf).
+        // 두 포텐셜이 서로 상쇄되므로 양쪽 열린 목록의 최소 키 합이 지금까지 찾은
+        // 최단 경로 비용 이상이 되면 더 짧은 경로는 없다.
+        template<typename TContextOpenList, typename TContextTrace>
+        bool SearchBidirectional(NodeId fromNodeId, NodeId toNodeId, std::vector<NodeId>* result, PathQueryContext<TContextOpenList, TContextTrace>& context) const
+        {
+            static_assert(!IsMonotoneOpenList<TContextOpenList>::value, "the average potential produces negative keys");
+            const uint32_t fromIndex = FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = FindNodeIndex(toNodeId);
+            if (fromIndex == invalidIndex || toIndex == invalidIndex)
+                return false;
+
+            auto& trace = context.trace;
+            auto potential = [this, fromNodeId, toNodeId, &trace](uint32_t index)
+            {
+                trace.OnHeuristic(2);
+                const NodeId nodeId = m_indexToNodeId[index];
+                return (m_functerH(nodeId, toNodeId) - m_functerH(fromNodeId, nodeId)) * 0.5f;
+            };
+
+            auto funcForwardH = [&potential](uint32_t index) { return potential(index); };
+            auto funcBackwardH = [&potential](uint32_t index) { return -potential(index); };
+
+            auto& forwardSlots = context.slots;
+            auto& forwardOpenList = context.openList;
+            auto& backwardSlots = context.backwardSlots;
+            auto& backwardOpenList = context.backwardOpenList;
+            const size_t nodeCount = m_indexToNodeId.size();
+            trace.BeginQuery(fromIndex, toIndex);
+            forwardSlots.BeginQuery(nodeCount);
+            backwardSlots.BeginQuery(nodeCount);
+            forwardOpenList.Clear();
+            forwardOpenList.Reserve(nodeCount);
+            backwardOpenList.Clear();
+            backwardOpenList.Reserve(nodeCount);
+
+            SearchSlot& from = forwardSlots.Touch(fromIndex, funcForwardH);
+            from.g = 0.f;
+            forwardOpenList.Push(fromIndex, from.h);
+            SearchSlot& to = backwardSlots.Touch(toIndex, funcBackwardH);
+            to.g = 0.f;
+            backwardOpenList.Push(toIndex, to.h);
+
+            float bestCost = std::numeric_limits<float>::max();
+            uint32_t meetIndex = SearchSlotTable::npos;
+            while (!forwardOpenList.Empty() && !backwardOpenList.Empty())
+            {
+                if (forwardOpenList.TopKey() + backwardOpenList.TopKey() >= bestCost)
+                    break;
+
+                // 열린 목록이 작은 쪽을 먼저 넓힌다.
+                const bool forward = forwardOpenList.Size() <= backwardOpenList.Size();
+                const CsrAdjacency& linkIndex = forward ? m_linkIndex : m_reverseLinkIndex;
+                SearchSlotTable& slots = forward ? forwardSlots : backwardSlots;
+                SearchSlotTable& otherSlots = forward ? backwardSlots : forwardSlots;
+                const uint32_t selIndex = forward ? forwardOpenList.Pop() : backwardOpenList.Pop();
+                trace.OnExpand(selIndex);
+                const float selG = slots[selIndex].g;
+                const uint32_t end = linkIndex.End(selIndex);
+                for (uint32_t i = linkIndex.Begin(selIndex); i != end; ++i)
+                {
+                    const uint32_t nodeIndex = linkIndex.targets[i];
+                    SearchSlot& node = forward ? slots.Touch(nodeIndex, funcForwardH) : slots.Touch(nodeIndex, funcBackwardH);
+                    float g = linkIndex.weights[i] + selG;
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    if (forward)
+                    {
+                        forwardOpenList.Push(nodeIndex, g + node.h);
+                    }
+                    else
+                    {
+                        backwardOpenList.Push(nodeIndex, g + node.h);
+                    }
+
+                    trace.OnRelax(nodeIndex, forwardOpenList.Size() + backwardOpenList.Size());
+                    if (otherSlots.IsTouched(nodeIndex) && g + otherSlots[nodeIndex].g < bestCost)
+                    {
+                        bestCost = g + otherSlots[nodeIndex].g;
+                        meetIndex = nodeIndex;
+                    }
+                }
+            }
+
+            if (meetIndex == SearchSlotTable::npos)
+                return trace.EndQuery(false);
+
+            result->clear();
+            uint32_t it = meetIndex;
+            while (it != SearchSlotTable::npos)
+            {
+                result->push_back(m_indexToNodeId[it]);
+                it = forwardSlots[it].prev;
+            }
+
+            std::reverse(result->begin(), result->end());
+            it = backwardSlots[meetIndex].prev;
+            while (it != SearchSlotTable::npos)
+            {
+                result->push_back(m_indexToNodeId[it]);
+                it = backwardSlots[it].prev;
+            }
+
+            return trace.EndQuery(true);
+        }
+
+    public:
+        // 캐시된 간선 비용을 FuncterG로 다시 계산한다.
+        void UpdateLinkCost()
+        {
+            UpdateLinkIndex();
+            if (!m_linkCostDirty)
+                return;
+
+            const uint32_t rowCount = static_cast<uint32_t>(m_linkIndex.RowCount());
+            m_linkCostScratch.resize(m_linkIndex.EdgeCount());
+            for (uint32_t row = 0; row < rowCount; ++row)
+            {
+                const NodeId srcNodeId = m_indexToNodeId[row];
+                const uint32_t end = m_linkIndex.End(row);
+                for (uint32_t i = m_linkIndex.Begin(row); i != end; ++i)
+                {
+                    const NodeId dstNodeId = m_indexToNodeId[m_linkIndex.targets[i]];
+                    m_linkIndex.weights[i] = m_functerG(srcNodeId, dstNodeId, m_linkList[m_linkIndex.edges[i]]);
+                    m_linkCostScratch[m_linkIndex.edges[i]] = m_linkIndex.weights[i];
+                }
+            }
+
+            for (size_t i = 0; i < m_reverseLinkIndex.EdgeCount(); ++i)
+            {
+                m_reverseLinkIndex.weights[i] = m_linkCostScratch[m_reverseLinkIndex.edges[i]];
+            }
+
+            m_linkCostDirty = false;
+        }
+
+    private:
+        TFuncterG m_functerG;
+        TFuncterH m_functerH;
+        PathQueryContext<TOpenList, TSearchTrace> m_context;
+        std::unique_ptr<ThreadPool> m_threadPool;
+        std::vector<std::unique_ptr<PathQueryContext<TOpenList>>> m_workerContexts;
+        ContractionHierarchy m_contractionHierarchy;
+        uint64_t m_contractionHierarchyVersion = 0;
+        IncrementalPlanner m_planner;
+        uint64_t m_plannerVersion = 0;
+        NodeId m_plannerFromNodeId = 0;
+        NodeId m_plannerToNodeId = 0;
+        std::vector<uint32_t> m_plannerPath;
+        AnytimePlanner m_anytimePlanner;
+        uint64_t m_anytimeVersion = 0;
+        NodeId m_anytimeFromNodeId = 0;
+        NodeId m_anytimeToNodeId = 0;
+        float m_anytimeInitialWeight = 2.f;
+        float m_anytimeWeightStep = 0.5f;
+        std::vector<uint32_t> m_anytimePath;
+        ClusterGraph m_clusterGraph;
+        ClusterGraph::Options m_clusterOptions{ 1.f, 0 };
+        uint64_t m_clusterGraphVersion = 0;
+        std::function<void(NodeId, float*, float*)> m_clusterPosition;
+        // 원래 간선 순서로 정렬한 비용. 역방향 인덱스에 비용을 옮길 때 쓴다.
+        std::vector<float> m_linkCostScratch;
+    };
+
+    template<typename G, typename H>
+    TGenericPathFinder<G, H> CreateGenericPathFinder(G&& g, H&& h)
+    {
+        return TGenericPathFinder<G, H>{std::forward<G>(g), std::forward<H>(h)};
+    }
+}
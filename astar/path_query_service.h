@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "search_state.h"
+#include "search_trace.h"
+
+namespace astar
+{
+    // 다른 스레드에서 읽을 수 있게 그래프를 통째로 복사해 둔 것. 만든 뒤에는 바꾸지 않는다.
+    // 휴리스틱은 x/y 좌표의 직선 거리이므로 간선 비용이 양 끝의 직선 거리보다 작으면 최단 경로를 보장하지 않는다.
+    struct GraphSnapshot
+    {
+        using NodeId = size_t;
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+        uint32_t FindNodeIndex(NodeId nodeId) const
+        {
+            auto it = nodeSet.find(nodeId);
+            if (it == nodeSet.end())
+                return invalidIndex;
+
+            return it->value;
+        }
+
+        float Distance(uint32_t a, uint32_t b) const
+        {
+            const float dx = x[a] - x[b];
+            const float dy = y[a] - y[b];
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        // 만들 때의 GetGraphVersion. 결과가 지금 그래프와 맞는지 확인할 때 쓴다.
+        uint64_t version;
+        CsrAdjacency linkIndex;
+        std::vector<NodeId> indexToNodeId;
+        NodeIdMap<uint32_t> nodeSet;
+        std::vector<float> x;
+        std::vector<float> y;
+    };
+
+    // 복사해도 같은 상태를 가리킨다. 질의를 넣은 쪽이 들고 있다가 필요 없어지면 Cancel한다.
+    class CancellationToken
+    {
+    public:
+        CancellationToken()
+            : m_cancelled{ std::make_shared<std::atomic<bool>>(false) }
+        {
+
+        }
+
+        void Cancel() const
+        {
+            m_cancelled->store(true, std::memory_order_relaxed);
+        }
+
+        bool IsCancelled() const
+        {
+            return m_cancelled->load(std::memory_order_relaxed);
+        }
+
+        bool IsSame(const CancellationToken& rhs) const
+        {
+            return m_cancelled == rhs.m_cancelled;
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> m_cancelled;
+    };
+
+    enum class PathQueryStatus
+    {
+        Found,
+        NotFound,
+        Cancelled,
+    };
+
+    struct PathQueryResult
+    {
+        PathQueryStatus status;
+        // 질의에 쓴 스냅샷의 버전
+        uint64_t version;
+        size_t fromNodeId;
+        size_t toNodeId;
+        // 출발점부터 도착점까지의 NodeId
+        std::vector<size_t> path;
+        float cost;
+        size_t expandedCount;
+        // Submit에서 recordTrace를 켠 질의만 채운다. 확장한 순서대로의 NodeId와 끝났을 때 열린 목록에 남은 NodeId
+        std::vector<size_t> explored;
+        std::vector<size_t> frontier;
+        SearchTrace::Statistics statistics;
+    };
+
+    // 작업자 스레드에서 GraphSnapshot 위의 A* 질의를 처리한다.
+    // 완료 콜백은 작업자 스레드에서 불리므로 UI에 넘길 때는 wxEvtHandler::CallAfter 같은 것으로 옮겨야 한다.
+    // 취소한 질의는 콜백을 부르지 않는다. 다만 취소와 완료가 겹치면 불릴 수 있으니 받는 쪽에서도 최신 질의인지 확인한다.
+    class PathQueryService
+    {
+    public:
+        using NodeId = size_t;
+        using Callback = std::function<void(PathQueryResult&&)>;
+
+        explicit PathQueryService(unsigned workerCount = 1)
+            : m_exit{ false }
+        {
+            workerCount = std::max(1u, workerCount);
+            for (unsigned i = 0; i < workerCount; ++i)
+            {
+                m_threads.emplace_back([this]() { WorkerMain(); });
+            }
+        }
+
+        PathQueryService(const PathQueryService&) = delete;
+        PathQueryService& operator=(const PathQueryService&) = delete;
+
+        // 기다리는 질의와 진행 중인 질의를 모두 취소하고 작업자가 끝날 때까지 기다린다.
+        ~PathQueryService()
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_exit = true;
+                for (auto& it : m_queue)
+                {
+                    it.token.Cancel();
+                }
+
+                for (auto& it : m_running)
+                {
+                    it.Cancel();
+                }
+            }
+
+            m_wakeUp.notify_all();
+            for (auto& it : m_threads)
+            {
+                it.join();
+            }
+        }
+
+        unsigned GetWorkerCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+        // recordTrace를 켜면 작업자가 탐색 영역을 남겨서 결과의 explored, frontier, statistics에 담는다.
+        CancellationToken Submit(std::shared_ptr<const GraphSnapshot> snapshot, NodeId fromNodeId, NodeId toNodeId, Callback onFinished, bool recordTrace = false)
+        {
+            CancellationToken token;
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_queue.push_back(Query{ std::move(snapshot), fromNodeId, toNodeId, token, std::move(onFinished), recordTrace });
+            }
+
+            m_wakeUp.notify_one();
+            return token;
+        }
+
+        void CancelAll()
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            for (auto& it : m_queue)
+            {
+                it.token.Cancel();
+            }
+
+            m_queue.clear();
+            for (auto& it : m_running)
+            {
+                it.Cancel();
+            }
+        }
+
+        // 아직 작업자가 꺼내지 않은 질의 수. 취소했지만 아직 꺼내지 않은 질의도 센다.
+        size_t GetPendingCount() const
+        {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            return m_queue.size();
+        }
+
+        // 작업자가 쓰는 탐색. 취소 토큰은 256번 꺼낼 때마다 확인한다.
+        template<typename TOpenList, typename TTrace>
+        static PathQueryStatus Search(const GraphSnapshot& snapshot, NodeId fromNodeId, NodeId toNodeId, const CancellationToken& token, PathQueryContext<TOpenList, TTrace>& context, PathQueryResult* result)
+        {
+            constexpr uint32_t cancelCheckInterval = 256;
+            result->path.clear();
+            result->cost = 0.f;
+            result->expandedCount = 0;
+            const uint32_t fromIndex = snapshot.FindNodeIndex(fromNodeId);
+            const uint32_t toIndex = snapshot.FindNodeIndex(toNodeId);
+            if (fromIndex == GraphSnapshot::invalidIndex || toIndex == GraphSnapshot::invalidIndex)
+                return PathQueryStatus::NotFound;
+
+            if (fromIndex == toIndex)
+            {
+                result->path.push_back(fromNodeId);
+                return PathQueryStatus::Found;
+            }
+
+            auto& trace = context.trace;
+            auto funcH = [&snapshot, toIndex, &trace](uint32_t index)
+            {
+                trace.OnHeuristic(1);
+                return snapshot.Distance(index, toIndex);
+            };
+
+            const CsrAdjacency& linkIndex = snapshot.linkIndex;
+            const size_t nodeCount = snapshot.indexToNodeId.size();
+            auto& slots = context.slots;
+            auto& openList = context.openList;
+            trace.BeginQuery(fromIndex, toIndex);
+            slots.BeginQuery(nodeCount);
+            SearchSlot& from = slots.Touch(fromIndex, funcH);
+            from.g = 0.f;
+            openList.Clear();
+            openList.Reserve(nodeCount);
+            openList.Push(fromIndex, from.h);
+            uint32_t count = 0;
+            while (true)
+            {
+                if (++count == cancelCheckInterval)
+                {
+                    count = 0;
+                    if (token.IsCancelled())
+                        return PathQueryStatus::Cancelled;
+                }
+
+                if (openList.Empty())
+                {
+                    trace.EndQuery(false);
+                    return PathQueryStatus::NotFound;
+                }
+
+                const uint32_t selIndex = openList.Pop();
+                result->expandedCount += 1;
+                trace.OnExpand(selIndex);
+                if (selIndex == toIndex)
+                    break;
+
+                const float selG = slots[selIndex].g;
+                const uint32_t end = linkIndex.End(selIndex);
+                for (uint32_t i = linkIndex.Begin(selIndex); i != end; ++i)
+                {
+                    const uint32_t nodeIndex = linkIndex.targets[i];
+                    SearchSlot& node = slots.Touch(nodeIndex, funcH);
+                    const float g = linkIndex.weights[i] + selG;
+                    if (node.g <= g)
+                        continue;
+
+                    node.g = g;
+                    node.prev = selIndex;
+                    openList.Push(nodeIndex, g + node.h);
+                    trace.OnRelax(nodeIndex, openList.Size());
+                }
+            }
+
+            trace.EndQuery(true);
+            result->cost = slots[toIndex].g;
+            for (uint32_t it = toIndex; it != SearchSlotTable::npos; it = slots[it].prev)
+            {
+                result->path.push_back(snapshot.indexToNodeId[it]);
+            }
+
+            std::reverse(result->path.begin(), result->path.end());
+            return PathQueryStatus::Found;
+        }
+
+    private:
+        struct Query
+        {
+            std::shared_ptr<const GraphSnapshot> snapshot;
+            NodeId fromNodeId;
+            NodeId toNodeId;
+            CancellationToken token;
+            Callback onFinished;
+            bool recordTrace;
+        };
+
+        void WorkerMain()
+        {
+            PathQueryContext<QuadHeapOpenList> context;
+            PathQueryContext<QuadHeapOpenList, SearchTrace> tracedContext;
+            tracedContext.trace.SetRecordOrder(true);
+            while (true)
+            {
+                Query query;
+                {
+                    std::unique_lock<std::mutex> lock{ m_mutex };
+                    m_wakeUp.wait(lock, [this]() { return m_exit || !m_queue.empty(); });
+                    if (m_exit)
+                        return;
+
+                    query = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    if (query.token.IsCancelled())
+                        continue;
+
+                    m_running.push_back(query.token);
+                }
+
+                PathQueryResult result{};
+                result.version = query.snapshot->version;
+                result.fromNodeId = query.fromNodeId;
+                result.toNodeId = query.toNodeId;
+                if (query.recordTrace)
+                {
+                    result.status = Search(*query.snapshot, query.fromNodeId, query.toNodeId, query.token, tracedContext, &result);
+                    CopyTrace(*query.snapshot, tracedContext.trace, &result);
+                }
+                else
+                {
+                    result.status = Search(*query.snapshot, query.fromNodeId, query.toNodeId, query.token, context, &result);
+                }
+                {
+                    std::lock_guard<std::mutex> guard{ m_mutex };
+                    m_running.erase(std::find_if(m_running.begin(), m_running.end(), [&query](const CancellationToken& it) { return it.IsSame(query.token); }));
+                }
+
+                if (result.status != PathQueryStatus::Cancelled && !query.token.IsCancelled() && query.onFinished)
+                {
+                    query.onFinished(std::move(result));
+                }
+            }
+        }
+
+        // 취소했거나 출발점과 도착점이 같으면 추적기가 쓰이지 않았으므로 비워 둔다.
+        static void CopyTrace(const GraphSnapshot& snapshot, const SearchTrace& trace, PathQueryResult* result)
+        {
+            if (result->status == PathQueryStatus::Cancelled || result->expandedCount == 0)
+                return;
+
+            for (auto index : trace.GetExpansionOrder())
+            {
+                result->explored.push_back(snapshot.indexToNodeId[index]);
+            }
+
+            for (auto index : trace.GetFrontier())
+            {
+                result->frontier.push_back(snapshot.indexToNodeId[index]);
+            }
+
+            result->statistics = trace.GetStatistics();
+        }
+
+        std::vector<std::thread> m_threads;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::deque<Query> m_queue;
+        // 작업자가 지금 처리 중인 질의. CancelAll과 소멸자가 취소할 수 있게 남겨 둔다.
+        std::vector<CancellationToken> m_running;
+        bool m_exit;
+    };
+}
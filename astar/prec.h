@@ -7,10 +7,16 @@
 #include <list>
 #include <limits>
 #include <map>
+#include <unordered_map>
 #include <array>
+#include <memory>
+#include <span>
 #include <wx/wx.h>
 #include <wx/xml/xml.h>
 #include <wx/artprov.h>
 #include <wx/file.h>
 #include <wx/wfstream.h>
+#include <wx/progdlg.h>
+#include <wx/dcbuffer.h>
+#include <wx/stopwatch.h>
 #include <DirectXMath.h>
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "open_list.h"
+#include "search_trace.h"
+
+namespace astar
+{
+    struct SearchSlot
+    {
+        float g;
+        float h;
+        uint32_t prev;
+        uint32_t generation;
+    };
+
+    // 노드 인덱스별 탐색 상태. 질의마다 세대 번호를 올려서 전체를 초기화하지 않는다.
+    // 슬롯은 처음 접근할 때 초기화되고 h도 그때 한 번만 계산한다.
+    class SearchSlotTable
+    {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        SearchSlotTable()
+            : m_generation{ 0 }
+        {
+
+        }
+
+        void Reserve(size_t slotCount)
+        {
+            if (m_slots.size() < slotCount)
+            {
+                m_slots.resize(slotCount, SearchSlot{ 0.f, 0.f, npos, 0 });
+            }
+        }
+
+        void BeginQuery(size_t slotCount)
+        {
+            Reserve(slotCount);
+            m_generation += 1;
+            if (m_generation == 0)
+            {
+                for (auto& it : m_slots)
+                {
+                    it.generation = 0;
+                }
+
+                m_generation = 1;
+            }
+        }
+
+        bool IsTouched(uint32_t index) const
+        {
+            return m_slots[index].generation == m_generation;
+        }
+
+        template<typename TFuncH>
+        SearchSlot& Touch(uint32_t index, TFuncH&& funcH)
+        {
+            SearchSlot& slot = m_slots[index];
+            if (slot.generation != m_generation)
+            {
+                slot.generation = m_generation;
+                slot.g = std::numeric_limits<float>::max();
+                slot.prev = npos;
+                slot.h = funcH(index);
+            }
+
+            return slot;
+        }
+
+        SearchSlot& operator[](uint32_t index) { return m_slots[index]; }
+
+        const SearchSlot& operator[](uint32_t index) const { return m_slots[index]; }
+
+        size_t Size() const { return m_slots.size(); }
+
+    private:
+        std::vector<SearchSlot> m_slots;
+        uint32_t m_generation;
+    };
+
+    enum class SearchMode
+    {
+        Unidirectional,
+        // 출발점과 도착점 양쪽에서 동시에 탐색한다.
+        // 키가 음수가 될 수 있으므로 radix 힙(IsMonotoneOpenList) 컨텍스트에서는 단방향으로 찾는다.
+        Bidirectional,
+    };
+
+    // Navigate가 쓰는 임시 버퍼를 모아 둔 객체. 호출자가 소유하고 질의마다 재사용하면
+    // 버퍼가 충분히 커진 뒤로는 질의 중에 힙 할당이 일어나지 않는다.
+    // 한 번에 하나의 질의에서만 쓸 수 있다.
+    // TTrace에 SearchTrace를 넣으면 질의마다 탐색 통계를 남긴다. 기본값 NullSearchTrace는 비용이 없다.
+    template<typename TOpenList = QuadHeapOpenList, typename TTrace = NullSearchTrace>
+    struct PathQueryContext
+    {
+        // 노드가 nodeCount개 이하인 그래프에서는 이후 질의가 버퍼를 늘리지 않도록 미리 잡아 둔다.
+        void Reserve(size_t nodeCount)
+        {
+            slots.Reserve(nodeCount);
+            openList.Reserve(nodeCount);
+            backwardSlots.Reserve(nodeCount);
+            backwardOpenList.Reserve(nodeCount);
+            neighbors.reserve(nodeCount);
+            neighborH.reserve(nodeCount);
+            neighborCost.reserve(nodeCount);
+        }
+
+        SearchSlotTable slots;
+        TOpenList openList;
+        // 양방향 탐색의 역방향 상태
+        SearchSlotTable backwardSlots;
+        TOpenList backwardOpenList;
+        std::vector<uint32_t> neighbors;
+        // neighbors와 같은 순서의 휴리스틱 값과 간선 길이
+        std::vector<float> neighborH;
+        std::vector<float> neighborCost;
+        TTrace trace;
+    };
+}
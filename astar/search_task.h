@@ -0,0 +1,157 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace astar
+{
+    enum class SearchTaskState
+    {
+        Running,
+        Found,
+        NotFound,
+    };
+
+    // 조금씩 나눠서 진행하는 길찾기 질의. Step 사이에 열린 목록과 g 값을 그대로 들고 있다.
+    // 만든 엔진보다 오래 살면 안 된다.
+    class SearchTask
+    {
+    public:
+        SearchTask()
+            : m_state{ SearchTaskState::Running }
+            , m_expandedCount{ 0 }
+        {
+
+        }
+
+        virtual ~SearchTask() = default;
+
+        // 노드를 maxExpansions개 꺼내거나 deadline이 지나면 멈춘다. 이미 끝났으면 아무것도 하지 않는다.
+        virtual SearchTaskState Step(size_t maxExpansions, std::chrono::steady_clock::time_point deadline) = 0;
+
+        // Found일 때 출발점부터 도착점까지의 NodeId
+        virtual bool GetPath(std::vector<size_t>* result) const = 0;
+
+        SearchTaskState GetState() const { return m_state; }
+
+        bool IsFinished() const { return m_state != SearchTaskState::Running; }
+
+        size_t GetExpandedCount() const { return m_expandedCount; }
+
+    protected:
+        SearchTaskState m_state;
+        size_t m_expandedCount;
+    };
+
+    // 여러 SearchTask를 정해진 프레임 예산 안에서 돌아가며 진행시킨다.
+    // 작업마다 sliceExpansions개씩 번갈아 진행하고, 다음 프레임은 이번에 멈춘 작업 다음부터 시작한다.
+    class SearchScheduler
+    {
+    public:
+        using TaskId = uint64_t;
+        using Callback = std::function<void(SearchTask&)>;
+
+        SearchScheduler()
+            : m_nextTaskId{ 1 }
+            , m_cursor{ 0 }
+        {
+
+        }
+
+        // 작업이 끝나면 RunFrame 안에서 onFinished를 부르고 작업을 지운다.
+        TaskId Add(std::unique_ptr<SearchTask> task, Callback onFinished)
+        {
+            const TaskId id = m_nextTaskId++;
+            m_entries.push_back(Entry{ id, std::move(task), std::move(onFinished) });
+            return id;
+        }
+
+        bool Cancel(TaskId id)
+        {
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                if (m_entries[i].id != id)
+                    continue;
+
+                Remove(i);
+                return true;
+            }
+
+            return false;
+        }
+
+        void Clear()
+        {
+            m_entries.clear();
+            m_cursor = 0;
+        }
+
+        bool Empty() const { return m_entries.empty(); }
+
+        size_t GetPendingCount() const { return m_entries.size(); }
+
+        // budget을 다 쓰거나 모든 작업이 끝날 때까지 진행하고, 이번에 끝난 작업 수를 돌려준다.
+        // 시간은 Step 안에서 64번 꺼낼 때마다 확인하므로 예산을 그만큼 넘을 수 있고, 작업의 첫 Step은 노드 수만큼 슬롯을 잡는다.
+        size_t RunFrame(std::chrono::microseconds budget, size_t sliceExpansions = 256)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + budget;
+            size_t finishedCount = 0;
+            while (!m_entries.empty())
+            {
+                if (m_cursor >= m_entries.size())
+                {
+                    m_cursor = 0;
+                }
+
+                Entry& entry = m_entries[m_cursor];
+                if (entry.task->Step(sliceExpansions, deadline) != SearchTaskState::Running)
+                {
+                    // 콜백이 Add/Cancel을 부를 수 있으므로 목록에서 먼저 뺀다.
+                    Entry finished = std::move(entry);
+                    Remove(m_cursor);
+                    finishedCount += 1;
+                    if (finished.onFinished)
+                    {
+                        finished.onFinished(*finished.task);
+                    }
+                }
+                else
+                {
+                    m_cursor += 1;
+                }
+
+                if (std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+
+            return finishedCount;
+        }
+
+    private:
+        struct Entry
+        {
+            TaskId id;
+            std::unique_ptr<SearchTask> task;
+            Callback onFinished;
+        };
+
+        // 순서를 지켜서 지운다. 지운 자리가 커서 앞이면 커서도 당긴다.
+        void Remove(size_t index)
+        {
+            m_entries.erase(m_entries.begin() + index);
+            if (index < m_cursor)
+            {
+                m_cursor -= 1;
+            }
+        }
+
+        std::vector<Entry> m_entries;
+        TaskId m_nextTaskId;
+        size_t m_cursor;
+    };
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace astar
+{
+    // PathQueryContext의 기본 추적기. 모든 함수가 비어 있어서 인라인되면 코드가 남지 않는다.
+    struct NullSearchTrace
+    {
+        void BeginQuery(uint32_t, uint32_t) {}
+
+        bool EndQuery(bool found) { return found; }
+
+        void OnExpand(uint32_t) {}
+
+        void OnRelax(uint32_t, size_t) {}
+
+        void OnHeuristic(size_t) {}
+    };
+
+    // 질의 하나의 탐색 통계를 모으고, 켜 두면 확장 순서와 마지막 열린 목록(frontier)도 남긴다.
+    // 노드 번호는 엔진의 노드 인덱스이다(Map은 노드 핸들, TGenericPathFinder는 GetNodeId로 바꾼다).
+    class SearchTrace
+    {
+    public:
+        struct Statistics
+        {
+            // 열린 목록에서 꺼낸 노드 수
+            uint64_t expandedCount;
+            // g가 줄어서 열린 목록에 넣거나 키를 갱신한 횟수
+            uint64_t relaxedCount;
+            uint64_t heuristicCount;
+            size_t peakOpenListSize;
+            double elapsedSeconds;
+            bool found;
+        };
+
+        SearchTrace()
+            : m_statistics{}
+            , m_recordOrder{ false }
+        {
+
+        }
+
+        void SetRecordOrder(bool record) { m_recordOrder = record; }
+
+        bool IsRecordingOrder() const { return m_recordOrder; }
+
+        const Statistics& GetStatistics() const { return m_statistics; }
+
+        const std::vector<uint32_t>& GetExpansionOrder() const { return m_expansionOrder; }
+
+        // 질의가 끝났을 때 열린 목록에 남아 있던 노드. 인덱스 순으로 정렬되어 있다.
+        const std::vector<uint32_t>& GetFrontier() const { return m_frontier; }
+
+        void BeginQuery(uint32_t fromIndex, uint32_t)
+        {
+            m_statistics = Statistics{};
+            m_expansionOrder.clear();
+            m_reached.clear();
+            m_frontier.clear();
+            if (m_recordOrder)
+            {
+                m_reached.push_back(fromIndex);
+            }
+
+            m_startTime = std::chrono::steady_clock::now();
+        }
+
+        bool EndQuery(bool found)
+        {
+            m_statistics.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+            m_statistics.found = found;
+            if (m_recordOrder)
+            {
+                CollectFrontier();
+            }
+
+            return found;
+        }
+
+        void OnExpand(uint32_t index)
+        {
+            m_statistics.expandedCount += 1;
+            if (m_recordOrder)
+            {
+                m_expansionOrder.push_back(index);
+            }
+        }
+
+        void OnRelax(uint32_t index, size_t openListSize)
+        {
+            m_statistics.relaxedCount += 1;
+            if (m_statistics.peakOpenListSize < openListSize)
+            {
+                m_statistics.peakOpenListSize = openListSize;
+            }
+
+            if (m_recordOrder)
+            {
+                m_reached.push_back(index);
+            }
+        }
+
+        void OnHeuristic(size_t count)
+        {
+            m_statistics.heuristicCount += count;
+        }
+
+    private:
+        // 한 번이라도 열린 목록에 들어간 노드 중 꺼내지 않은 노드가 frontier이다.
+        void CollectFrontier()
+        {
+            uint32_t maxIndex = 0;
+            for (auto it : m_reached)
+            {
+                maxIndex = maxIndex < it ? it : maxIndex;
+            }
+
+            m_mark.assign(static_cast<size_t>(maxIndex) + 1, 0);
+            for (auto it : m_reached)
+            {
+                m_mark[it] = 1;
+            }
+
+            for (auto it : m_expansionOrder)
+            {
+                if (it <= maxIndex)
+                {
+                    m_mark[it] = 0;
+                }
+            }
+
+            for (uint32_t i = 0; i <= maxIndex && !m_reached.empty(); ++i)
+            {
+                if (m_mark[i] != 0)
+                {
+                    m_frontier.push_back(i);
+                }
+            }
+        }
+
+        Statistics m_statistics;
+        bool m_recordOrder;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::vector<uint32_t> m_expansionOrder;
+        std::vector<uint32_t> m_reached;
+        std::vector<uint32_t> m_frontier;
+        std::vector<uint8_t> m_mark;
+    };
+}
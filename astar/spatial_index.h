@@ -0,0 +1,407 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "node_id_set.h"
+
+namespace astar
+{
+    // 노드를 균일 격자 칸에 나눠 담는 공간 색인.
+    // 칸은 노드가 있는 곳에만 만들고 해시로 찾으므로 좌표 범위가 넓어도 메모리는 노드 수에 비례한다.
+    // 반경 검색, 가장 가까운 노드, k-최근접 검색을 주변 칸만 보고 처리한다.
+    template<typename TKey = size_t>
+    class SpatialGrid
+    {
+    public:
+        static constexpr TKey npos = std::numeric_limits<TKey>::max();
+
+        // cellSize는 보통 검색 반경과 비슷하게 잡는다.
+        explicit SpatialGrid(float cellSize = 64.f)
+            : m_cellSize{ cellSize }
+            , m_inverseCellSize{ 1.f / cellSize }
+            , m_size{ 0 }
+        {
+            ResetBounds();
+        }
+
+        size_t Size() const { return m_size; }
+
+        bool Empty() const { return m_size == 0; }
+
+        float GetCellSize() const { return m_cellSize; }
+
+        bool Contains(TKey id) const { return m_locations.count(id) != 0; }
+
+        void Clear()
+        {
+            m_buckets.clear();
+            m_freeBuckets.clear();
+            m_cells.clear();
+            m_locations.clear();
+            m_size = 0;
+            ResetBounds();
+        }
+
+        void Reserve(size_t count)
+        {
+            m_locations.reserve(count);
+        }
+
+        // 이미 있는 id면 위치만 바꾼다.
+        void Insert(TKey id, float x, float y)
+        {
+            if (Contains(id))
+            {
+                Move(id, x, y);
+                return;
+            }
+
+            Add(id, x, y);
+        }
+
+        bool Move(TKey id, float x, float y)
+        {
+            Location* location = m_locations.get(id);
+            if (location == nullptr)
+                return false;
+
+            Bucket& bucket = m_buckets[location->bucket];
+            if (bucket.cellX == CellOf(x) && bucket.cellY == CellOf(y))
+            {
+                bucket.entries[location->slot].x = x;
+                bucket.entries[location->slot].y = y;
+                return true;
+            }
+
+            Erase(id, *location);
+            Add(id, x, y);
+            return true;
+        }
+
+        bool Remove(TKey id)
+        {
+            Location* location = m_locations.get(id);
+            if (location == nullptr)
+                return false;
+
+            Erase(id, *location);
+            return true;
+        }
+
+        // 중심에서 radius 미만인 노드를 모두 담는다. 순서는 정해져 있지 않다.
+        void QueryRadius(float x, float y, float radius, std::vector<TKey>* result) const
+        {
+            result->clear();
+            const float radius2 = radius * radius;
+            ForEachBucketInBox(CellOf(x - radius), CellOf(y - radius), CellOf(x + radius), CellOf(y + radius), [&](const Bucket& bucket)
+                {
+                    for (auto& it : bucket.entries)
+                    {
+                        if (Distance2(it, x, y) < radius2)
+                        {
+                            result->push_back(it.id);
+                        }
+                    }
+                });
+        }
+
+        // [x0, x1] x [y0, y1] 상자 안의 노드. 화면에 보이는 노드만 그릴 때 쓴다. 순서는 정해져 있지 않다.
+        void QueryBox(float x0, float y0, float x1, float y1, std::vector<TKey>* result) const
+        {
+            result->clear();
+            ForEachBucketInBox(CellOf(x0), CellOf(y0), CellOf(x1), CellOf(y1), [&](const Bucket& bucket)
+                {
+                    for (auto& it : bucket.entries)
+                    {
+                        if (it.x >= x0 && it.x <= x1 && it.y >= y0 && it.y <= y1)
+                        {
+                            result->push_back(it.id);
+                        }
+                    }
+                });
+        }
+
+        // maxDistance 미만에서 가장 가까운 노드. 거리가 같으면 id가 큰 노드를 고른다. 없으면 npos
+        TKey FindNearest(float x, float y, float maxDistance = std::numeric_limits<float>::infinity()) const
+        {
+            return FindNearest(x, y, [](TKey) { return true; }, maxDistance);
+        }
+
+        // pred(id)가 true인 노드 중에서 찾는다. 도달할 수 있는 노드로 스냅할 때 쓴다.
+        template<typename TPred>
+        TKey FindNearest(float x, float y, TPred&& pred, float maxDistance = std::numeric_limits<float>::infinity()) const
+        {
+            TKey best = npos;
+            float bestDistance2 = maxDistance * maxDistance;
+            VisitRings(x, y, [&](const Bucket& bucket)
+                {
+                    for (auto& it : bucket.entries)
+                    {
+                        const float distance2 = Distance2(it, x, y);
+                        if (distance2 > bestDistance2 || (distance2 == bestDistance2 && (best == npos || it.id < best)))
+                            continue;
+
+                        if (!pred(it.id))
+                            continue;
+
+                        best = it.id;
+                        bestDistance2 = distance2;
+                    }
+                }, [&](float ringDistance)
+                {
+                    return ringDistance * ringDistance > bestDistance2;
+                });
+
+            return best;
+        }
+
+        // 가까운 순서로 최대 k개. (거리, id)를 담는다.
+        void FindKNearest(float x, float y, size_t k, std::vector<std::pair<float, TKey>>* result, float maxDistance = std::numeric_limits<float>::infinity()) const
+        {
+            result->clear();
+            if (k == 0)
+                return;
+
+            // result를 거리 제곱 기준 최대 힙으로 쓴다.
+            const float maxDistance2 = maxDistance * maxDistance;
+            VisitRings(x, y, [&](const Bucket& bucket)
+                {
+                    for (auto& it : bucket.entries)
+                    {
+                        const float distance2 = Distance2(it, x, y);
+                        if (distance2 >= maxDistance2)
+                            continue;
+
+                        if (result->size() == k)
+                        {
+                            if (distance2 >= result->front().first)
+                                continue;
+
+                            std::pop_heap(result->begin(), result->end());
+                            result->pop_back();
+                        }
+
+                        result->emplace_back(distance2, it.id);
+                        std::push_heap(result->begin(), result->end());
+                    }
+                }, [&](float ringDistance)
+                {
+                    const float ringDistance2 = ringDistance * ringDistance;
+                    return ringDistance2 >= maxDistance2 || (result->size() == k && ringDistance2 >= result->front().first);
+                });
+
+            std::sort_heap(result->begin(), result->end());
+            for (auto& it : *result)
+            {
+                it.first = std::sqrt(it.first);
+            }
+        }
+
+        size_t GetMemoryUsage() const
+        {
+            size_t ret = m_buckets.capacity() * sizeof(Bucket) + m_cells.capacity() * sizeof(typename NodeIdMap<uint32_t, uint64_t>::Slot)
+                + m_locations.capacity() * sizeof(typename NodeIdMap<Location, TKey>::Slot);
+            for (auto& it : m_buckets)
+            {
+                ret += it.entries.capacity() * sizeof(Entry);
+            }
+
+            return ret;
+        }
+
+    private:
+        struct Entry
+        {
+            float x;
+            float y;
+            TKey id;
+        };
+
+        struct Bucket
+        {
+            int32_t cellX;
+            int32_t cellY;
+            std::vector<Entry> entries;
+        };
+
+        struct Location
+        {
+            uint32_t bucket;
+            uint32_t slot;
+        };
+
+        static float Distance2(const Entry& entry, float x, float y)
+        {
+            const float dx = entry.x - x;
+            const float dy = entry.y - y;
+            return dx * dx + dy * dy;
+        }
+
+        static uint64_t CellKey(int32_t cellX, int32_t cellY)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) | static_cast<uint32_t>(cellY);
+        }
+
+        int32_t CellOf(float value) const
+        {
+            // 너무 먼 좌표는 가장자리 칸으로 모은다.
+            const float cell = std::floor(value * m_inverseCellSize);
+            return static_cast<int32_t>(std::clamp(cell, -1073741824.f, 1073741824.f));
+        }
+
+        void ResetBounds()
+        {
+            m_minCellX = std::numeric_limits<int32_t>::max();
+            m_minCellY = std::numeric_limits<int32_t>::max();
+            m_maxCellX = std::numeric_limits<int32_t>::min();
+            m_maxCellY = std::numeric_limits<int32_t>::min();
+        }
+
+        void Add(TKey id, float x, float y)
+        {
+            const int32_t cellX = CellOf(x);
+            const int32_t cellY = CellOf(y);
+            const uint64_t key = CellKey(cellX, cellY);
+            uint32_t bucketIndex;
+            if (uint32_t* found = m_cells.get(key))
+            {
+                bucketIndex = *found;
+            }
+            else
+            {
+                if (!m_freeBuckets.empty())
+                {
+                    bucketIndex = m_freeBuckets.back();
+                    m_freeBuckets.pop_back();
+                }
+                else
+                {
+                    bucketIndex = static_cast<uint32_t>(m_buckets.size());
+                    m_buckets.emplace_back();
+                }
+
+                m_buckets[bucketIndex].cellX = cellX;
+                m_buckets[bucketIndex].cellY = cellY;
+                m_cells.insert(key, bucketIndex);
+                // 범위는 줄이지 않는다. 링 탐색을 멈추는 기준으로만 쓴다.
+                m_minCellX = std::min(m_minCellX, cellX);
+                m_minCellY = std::min(m_minCellY, cellY);
+                m_maxCellX = std::max(m_maxCellX, cellX);
+                m_maxCellY = std::max(m_maxCellY, cellY);
+            }
+
+            auto& entries = m_buckets[bucketIndex].entries;
+            m_locations.insert(id, Location{ bucketIndex, static_cast<uint32_t>(entries.size()) });
+            entries.push_back(Entry{ x, y, id });
+            m_size += 1;
+        }
+
+        // 칸의 마지막 항목을 지운 자리로 옮긴다. 빈 칸은 다시 쓴다.
+        void Erase(TKey id, Location location)
+        {
+            Bucket& bucket = m_buckets[location.bucket];
+            if (location.slot + 1 != bucket.entries.size())
+            {
+                bucket.entries[location.slot] = bucket.entries.back();
+                m_locations.get(bucket.entries[location.slot].id)->slot = location.slot;
+            }
+
+            bucket.entries.pop_back();
+            m_locations.erase(id);
+            m_size -= 1;
+            if (bucket.entries.empty())
+            {
+                m_cells.erase(CellKey(bucket.cellX, bucket.cellY));
+                m_freeBuckets.push_back(location.bucket);
+            }
+        }
+
+        // 칸 좌표 상자 안의 칸을 모두 방문한다. 상자가 만든 칸 수보다 넓으면 칸 목록을 훑는다.
+        template<typename TFunc>
+        void ForEachBucketInBox(int64_t x0, int64_t y0, int64_t x1, int64_t y1, TFunc&& func) const
+        {
+            x0 = std::max<int64_t>(x0, m_minCellX);
+            y0 = std::max<int64_t>(y0, m_minCellY);
+            x1 = std::min<int64_t>(x1, m_maxCellX);
+            y1 = std::min<int64_t>(y1, m_maxCellY);
+            if (x0 > x1 || y0 > y1)
+                return;
+
+            if (static_cast<uint64_t>(x1 - x0 + 1) * static_cast<uint64_t>(y1 - y0 + 1) > m_cells.size())
+            {
+                for (auto& it : m_buckets)
+                {
+                    if (!it.entries.empty() && it.cellX >= x0 && it.cellX <= x1 && it.cellY >= y0 && it.cellY <= y1)
+                    {
+                        func(it);
+                    }
+                }
+
+                return;
+            }
+
+            for (int64_t cellY = y0; cellY <= y1; ++cellY)
+            {
+                for (int64_t cellX = x0; cellX <= x1; ++cellX)
+                {
+                    auto it = m_cells.find(CellKey(static_cast<int32_t>(cellX), static_cast<int32_t>(cellY)));
+                    if (it != m_cells.end())
+                    {
+                        func(m_buckets[it->value]);
+                    }
+                }
+            }
+        }
+
+        // 중심 칸에서 체비쇼프 거리 r인 칸들을 r = 0, 1, 2, ... 순서로 방문한다.
+        // stop(d)는 링 r의 칸까지의 최소 거리 d를 받아 탐색을 멈출지 정한다.
+        template<typename TFunc, typename TStop>
+        void VisitRings(float x, float y, TFunc&& func, TStop&& stop) const
+        {
+            if (m_size == 0)
+                return;
+
+            const int64_t centerX = CellOf(x);
+            const int64_t centerY = CellOf(y);
+            // 점에서 중심 칸 네 변까지의 거리 중 가장 짧은 것
+            const float offsetX = x - static_cast<float>(centerX) * m_cellSize;
+            const float offsetY = y - static_cast<float>(centerY) * m_cellSize;
+            const float inner = std::max(0.f, std::min({ offsetX, m_cellSize - offsetX, offsetY, m_cellSize - offsetY }));
+            const int64_t maxRing = std::max({ centerX - m_minCellX, m_maxCellX - centerX, centerY - m_minCellY, m_maxCellY - centerY });
+            for (int64_t r = 0; r <= maxRing; ++r)
+            {
+                if (r != 0 && stop(inner + static_cast<float>(r - 1) * m_cellSize))
+                    return;
+
+                if (r == 0)
+                {
+                    ForEachBucketInBox(centerX, centerY, centerX, centerY, func);
+                    continue;
+                }
+
+                // 위아래 줄과 양옆 기둥
+                ForEachBucketInBox(centerX - r, centerY - r, centerX + r, centerY - r, func);
+                ForEachBucketInBox(centerX - r, centerY + r, centerX + r, centerY + r, func);
+                ForEachBucketInBox(centerX - r, centerY - r + 1, centerX - r, centerY + r - 1, func);
+                ForEachBucketInBox(centerX + r, centerY - r + 1, centerX + r, centerY + r - 1, func);
+            }
+        }
+
+        float m_cellSize;
+        float m_inverseCellSize;
+        std::vector<Bucket> m_buckets;
+        std::vector<uint32_t> m_freeBuckets;
+        NodeIdMap<uint32_t, uint64_t> m_cells;
+        NodeIdMap<Location, TKey> m_locations;
+        size_t m_size;
+        int32_t m_minCellX;
+        int32_t m_minCellY;
+        int32_t m_maxCellX;
+        int32_t m_maxCellY;
+    };
+}
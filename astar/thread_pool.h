@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace astar
+{
+    // ParallelFor 전용 스레드 풀. 호출한 스레드도 0번 작업자로 참여한다.
+    // 작업 범위를 작업자 수만큼 나눠 주고, 자기 몫을 끝낸 작업자는 다른 작업자의 남은 몫을 훔쳐 온다.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(unsigned workerCount = std::thread::hardware_concurrency())
+            : m_workerCount{ std::max(1u, workerCount) }
+            , m_job{ nullptr }
+            , m_jobContext{ nullptr }
+            , m_grain{ 1 }
+            , m_jobGeneration{ 0 }
+            , m_runningCount{ 0 }
+            , m_exit{ false }
+        {
+            m_ranges = std::make_unique<Range[]>(m_workerCount);
+            for (unsigned i = 1; i < m_workerCount; ++i)
+            {
+                m_threads.emplace_back([this, i]() { WorkerMain(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_exit = true;
+            }
+
+            m_wakeUp.notify_all();
+            for (auto& it : m_threads)
+            {
+                it.join();
+            }
+        }
+
+        unsigned GetWorkerCount() const { return m_workerCount; }
+
+        // [0, count)의 각 index에 대해 func(workerIndex, index)를 한 번씩 호출하고 모두 끝나면 돌아온다.
+        // 동시에 여러 스레드에서 호출하면 안 된다.
+        template<typename TFunc>
+        void ParallelFor(size_t count, TFunc&& func, size_t grain = 1)
+        {
+            if (count == 0)
+                return;
+
+            m_grain = std::max<size_t>(1, grain);
+            const size_t chunk = (count + m_workerCount - 1) / m_workerCount;
+            for (unsigned i = 0; i < m_workerCount; ++i)
+            {
+                size_t begin = std::min(count, chunk * i);
+                m_ranges[i].next.store(begin, std::memory_order_relaxed);
+                m_ranges[i].end = std::min(count, begin + chunk);
+            }
+
+            using Func = typename std::remove_reference<TFunc>::type;
+            m_jobContext = const_cast<void*>(static_cast<const void*>(&func));
+            m_job = [](void* context, unsigned workerIndex, size_t index)
+            {
+                (*static_cast<Func*>(context))(workerIndex, index);
+            };
+
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_runningCount = m_workerCount - 1;
+                m_jobGeneration += 1;
+            }
+
+            m_wakeUp.notify_all();
+            RunJob(0);
+
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            m_done.wait(lock, [this]() { return m_runningCount == 0; });
+            m_job = nullptr;
+            m_jobContext = nullptr;
+        }
+
+    private:
+        struct alignas(64) Range
+        {
+            std::atomic<size_t> next;
+            size_t end;
+        };
+
+        bool Claim(Range& range, size_t* begin, size_t* end)
+        {
+            if (range.next.load(std::memory_order_relaxed) >= range.end)
+                return false;
+
+            size_t first = range.next.fetch_add(m_grain, std::memory_order_relaxed);
+            if (first >= range.end)
+                return false;
+
+            *begin = first;
+            *end = std::min(range.end, first + m_grain);
+            return true;
+        }
+
+        void RunJob(unsigned workerIndex)
+        {
+            size_t begin;
+            size_t end;
+            for (unsigned i = 0; i < m_workerCount; ++i)
+            {
+                // 자기 몫부터 처리하고 이웃 순서로 훔친다.
+                Range& range = m_ranges[(workerIndex + i) % m_workerCount];
+                while (Claim(range, &begin, &end))
+                {
+                    for (size_t index = begin; index < end; ++index)
+                    {
+                        m_job(m_jobContext, workerIndex, index);
+                    }
+                }
+            }
+        }
+
+        void WorkerMain(unsigned workerIndex)
+        {
+            uint64_t generation = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock{ m_mutex };
+                    m_wakeUp.wait(lock, [this, generation]() { return m_exit || m_jobGeneration != generation; });
+                    if (m_exit)
+                        return;
+
+                    generation = m_jobGeneration;
+                }
+
+                RunJob(workerIndex);
+
+                bool last;
+                {
+                    std::lock_guard<std::mutex> guard{ m_mutex };
+                    m_runningCount -= 1;
+                    last = m_runningCount == 0;
+                }
+
+                if (last)
+                {
+                    m_done.notify_one();
+                }
+            }
+        }
+
+        const unsigned m_workerCount;
+        std::unique_ptr<Range[]> m_ranges;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::condition_variable m_done;
+        void (*m_job)(void*, unsigned, size_t);
+        void* m_jobContext;
+        size_t m_grain;
+        uint64_t m_jobGeneration;
+        unsigned m_runningCount;
+        bool m_exit;
+    };
+}
@@ -0,0 +1,716 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "binary_map.h"
+#include "thread_pool.h"
+
+namespace astar
+{
+    enum class XmlMapErrorKind
+    {
+        // 태그가 닫히지 않았거나 속성 형식이 맞지 않는다.
+        BadSyntax,
+        MissingAttribute,
+        // 속성 값이 숫자가 아니다.
+        BadAttribute,
+        DuplicateNode,
+        // 간선이 없는 노드를 가리킨다.
+        UnknownNode,
+        // 루트 요소가 <map>이 아니다.
+        NotMapFile,
+        ReadFailed,
+    };
+
+    struct XmlMapError
+    {
+        XmlMapErrorKind kind;
+        // 레코드가 시작하는 바이트 위치와 줄 번호(1부터). 위치와 상관없는 오류면 줄 번호는 0이다.
+        uint64_t offset;
+        uint64_t line;
+        // DuplicateNode/UnknownNode에서 문제가 된 노드 ID
+        uint64_t nodeId;
+    };
+
+    // <map> 파일을 DOM 없이 한 번에 훑으면서 <node>와 <link>를 싱크로 넘긴다.
+    // 잘못된 레코드는 OnError로 알리고 건너뛴다. 싱크는 다음 멤버를 가진다.
+    //   void OnNode(uint64_t id, float x, float y);
+    //   void OnLink(uint64_t fromNodeId, uint64_t toNodeId);
+    //   void OnError(const XmlMapError& error);
+    //   bool OnProgress(uint64_t readBytes, uint64_t totalBytes); // false면 중단
+    // 싱크는 항상 Read를 호출한 스레드에서 파일 순서대로 불린다.
+    class XmlMapReader
+    {
+    public:
+        explicit XmlMapReader(size_t bufferSize = 1 << 20, size_t chunkSize = 4 << 20)
+            : m_bufferSize{ std::max<size_t>(bufferSize, 4096) }
+            , m_chunkSize{ std::max<size_t>(chunkSize, 4096) }
+        {
+
+        }
+
+        // 한 스레드로 앞에서부터 읽는다. 버퍼 하나만 쓰므로 파일 크기와 상관없이 메모리가 일정하다.
+        template<typename TSink>
+        bool Read(const std::filesystem::path& path, TSink& sink)
+        {
+#if defined(_WIN32)
+            FILE* file = _wfopen(path.c_str(), L"rb");
+#else
+            FILE* file = std::fopen(path.c_str(), "rb");
+#endif
+            if (file == nullptr)
+            {
+                sink.OnError(XmlMapError{ XmlMapErrorKind::ReadFailed, 0, 0, 0 });
+                return false;
+            }
+
+            std::error_code error;
+            const uint64_t totalBytes = std::filesystem::file_size(path, error);
+            std::vector<char> buffer(m_bufferSize);
+            size_t filled = 0;
+            uint64_t bufferOffset = 0;
+            uint64_t line = 1;
+            State state{};
+            bool cancelled = false;
+            while (true)
+            {
+                // 태그 하나가 버퍼보다 길면 버퍼를 늘린다.
+                if (filled == buffer.size())
+                {
+                    buffer.resize(buffer.size() * 2);
+                }
+
+                const size_t requested = buffer.size() - filled;
+                const size_t readBytes = std::fread(buffer.data() + filled, 1, requested, file);
+                if (std::ferror(file))
+                {
+                    state.failed = true;
+                    sink.OnError(XmlMapError{ XmlMapErrorKind::ReadFailed, bufferOffset + filled, 0, 0 });
+                    break;
+                }
+
+                filled += readBytes;
+                const bool atEnd = readBytes < requested;
+                Parser<TSink> parser{ sink, state, buffer.data(), bufferOffset, line };
+                const char* rest = parser.Run(buffer.data(), buffer.data() + filled, buffer.data() + filled, atEnd);
+                if (state.failed)
+                    break;
+
+                const size_t consumed = static_cast<size_t>(rest - buffer.data());
+                line += static_cast<uint64_t>(std::count(static_cast<const char*>(buffer.data()), rest, '\n'));
+                bufferOffset += consumed;
+                std::memmove(buffer.data(), rest, filled - consumed);
+                filled -= consumed;
+                if (!sink.OnProgress(bufferOffset, totalBytes))
+                {
+                    cancelled = true;
+                    break;
+                }
+
+                if (atEnd)
+                    break;
+            }
+
+            std::fclose(file);
+            return Finish(sink, state, cancelled);
+        }
+
+        // 파일을 매핑해서 청크 단위로 여러 스레드가 나눠 읽는다.
+        // 한 번에 작업자 수의 두 배만큼 청크를 읽고 그 결과를 싱크로 넘긴 뒤 다음 청크로 넘어간다.
+        // 청크는 경계 뒤의 첫 '<'부터 읽는다. 앞 청크의 마지막 태그(주석 등)가 경계를 넘었으면 그 청크만 이어서 다시 읽는다.
+        template<typename TSink>
+        bool Read(const std::filesystem::path& path, TSink& sink, ThreadPool& pool)
+        {
+            MappedFile file;
+            if (!file.Open(path))
+            {
+                sink.OnError(XmlMapError{ XmlMapErrorKind::ReadFailed, 0, 0, 0 });
+                return false;
+            }
+
+            return ReadBuffer(reinterpret_cast<const char*>(file.Data()), file.Size(), sink, pool);
+        }
+
+        template<typename TSink>
+        bool ReadBuffer(const char* data, size_t size, TSink& sink, ThreadPool& pool)
+        {
+            const size_t chunkCount = (size + m_chunkSize - 1) / m_chunkSize;
+            const size_t waveSize = static_cast<size_t>(pool.GetWorkerCount()) * 2;
+            std::vector<ChunkResult> chunks(std::min(chunkCount, waveSize));
+            State rootState{};
+            uint64_t line = 1;
+            size_t next = 0;
+            bool cancelled = false;
+            for (size_t wave = 0; wave < chunkCount && !cancelled && !rootState.failed; wave += waveSize)
+            {
+                const size_t count = std::min(waveSize, chunkCount - wave);
+                pool.ParallelFor(count, [&](unsigned, size_t index)
+                    {
+                        const size_t chunk = wave + index;
+                        ParseChunk(data, size, chunk, chunk == 0 ? &rootState : nullptr, &chunks[index]);
+                    });
+
+                for (size_t i = 0; i < count && !rootState.failed; ++i)
+                {
+                    ChunkResult& chunk = chunks[i];
+                    if (chunk.begin != next)
+                    {
+                        ParseChunk(data, size, wave + i, nullptr, &chunk, next);
+                    }
+
+                    next = chunk.next;
+                    for (auto& it : chunk.nodes)
+                    {
+                        sink.OnNode(it.id, it.x, it.y);
+                    }
+
+                    for (auto& it : chunk.links)
+                    {
+                        sink.OnLink(it.first, it.second);
+                    }
+
+                    for (auto it : chunk.errors)
+                    {
+                        it.line += line;
+                        sink.OnError(it);
+                    }
+
+                    line += chunk.newlineCount;
+                }
+
+                if (rootState.failed)
+                {
+                    sink.OnError(rootState.error);
+                    break;
+                }
+
+                const uint64_t readBytes = std::min<uint64_t>(size, static_cast<uint64_t>(wave + count) * m_chunkSize);
+                if (!sink.OnProgress(readBytes, size))
+                {
+                    cancelled = true;
+                }
+            }
+
+            if (chunkCount == 0)
+            {
+                rootState.failed = true;
+                sink.OnError(XmlMapError{ XmlMapErrorKind::NotMapFile, 0, 1, 0 });
+            }
+
+            return !rootState.failed && !cancelled;
+        }
+
+    private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct State
+        {
+            bool rootSeen;
+            bool failed;
+            XmlMapError error;
+        };
+
+        struct NodeRecord
+        {
+            uint64_t id;
+            float x;
+            float y;
+        };
+
+        struct ChunkResult
+        {
+            std::vector<NodeRecord> nodes;
+            std::vector<std::pair<uint64_t, uint64_t>> links;
+            // line은 청크 시작 기준(0부터)이다.
+            std::vector<XmlMapError> errors;
+            uint64_t newlineCount;
+            // 읽기 시작한 위치와 끝난 위치. 끝난 위치는 다음 청크가 시작해야 할 태그이다.
+            size_t begin;
+            size_t next;
+
+            void OnNode(uint64_t id, float x, float y) { nodes.push_back(NodeRecord{ id, x, y }); }
+
+            void OnLink(uint64_t from, uint64_t to) { links.emplace_back(from, to); }
+
+            void OnError(const XmlMapError& error) { errors.push_back(error); }
+        };
+
+        template<typename TSink>
+        static bool Finish(TSink& sink, State& state, bool cancelled)
+        {
+            if (state.failed)
+            {
+                if (state.error.kind == XmlMapErrorKind::NotMapFile)
+                {
+                    sink.OnError(state.error);
+                }
+
+                return false;
+            }
+
+            if (!state.rootSeen)
+            {
+                sink.OnError(XmlMapError{ XmlMapErrorKind::NotMapFile, 0, 1, 0 });
+                return false;
+            }
+
+            return !cancelled;
+        }
+
+        // chunk번째 청크 안에서 시작하는 태그만 읽는다. 첫 청크는 루트 요소도 확인한다.
+        // from을 주면 경계 뒤의 첫 '<' 대신 그 위치부터 읽는다.
+        void ParseChunk(const char* data, size_t size, size_t chunk, State* rootState, ChunkResult* result, size_t from = npos) const
+        {
+            result->nodes.clear();
+            result->links.clear();
+            result->errors.clear();
+            const char* rawBegin = data + chunk * m_chunkSize;
+            const char* limit = data + std::min(size, (chunk + 1) * m_chunkSize);
+            const char* end = data + size;
+            result->newlineCount = static_cast<uint64_t>(std::count(rawBegin, limit, '\n'));
+            State localState{ true, false, {} };
+            State& state = rootState != nullptr ? *rootState : localState;
+            const char* begin = rawBegin;
+            if (from != npos)
+            {
+                begin = data + from;
+            }
+            else if (chunk != 0)
+            {
+                begin = static_cast<const char*>(std::memchr(rawBegin, '<', static_cast<size_t>(end - rawBegin)));
+                if (begin == nullptr)
+                {
+                    begin = end;
+                }
+            }
+
+            result->begin = static_cast<size_t>(begin - data);
+            result->next = result->begin;
+            if (begin >= limit)
+                return;
+
+            Parser<ChunkResult> parser{ *result, state, rawBegin, static_cast<uint64_t>(rawBegin - data), 0 };
+            result->next = static_cast<size_t>(parser.Run(begin, limit, end, true) - data);
+        }
+
+        template<typename TSink>
+        class Parser
+        {
+        public:
+            // base는 offset/line이 가리키는 위치이다. 오류의 줄 번호는 거기서부터 센다.
+            Parser(TSink& sink, State& state, const char* base, uint64_t baseOffset, uint64_t baseLine)
+                : m_sink{ sink }
+                , m_state{ state }
+                , m_base{ base }
+                , m_baseOffset{ baseOffset }
+                , m_lineCursor{ base }
+                , m_line{ baseLine }
+            {
+
+            }
+
+            // limit 전에 시작하는 태그를 모두 읽는다. atEnd가 아니면 end에서 잘린 태그의 시작 위치를 돌려준다.
+            const char* Run(const char* p, const char* limit, const char* end, bool atEnd)
+            {
+                while (true)
+                {
+                    p = static_cast<const char*>(std::memchr(p, '<', static_cast<size_t>(end - p)));
+                    if (p == nullptr)
+                        return end;
+
+                    if (p >= limit)
+                        return p;
+
+                    const char* tagStart = p;
+                    const char* close;
+                    size_t closeLength = 1;
+                    if (!atEnd && end - p < 4)
+                        return tagStart;
+
+                    if (StartsWith(p, end, "<?"))
+                    {
+                        close = Find(p + 2, end, "?>");
+                        closeLength = 2;
+                    }
+                    else if (StartsWith(p, end, "<!--"))
+                    {
+                        close = Find(p + 4, end, "-->");
+                        closeLength = 3;
+                    }
+                    else
+                    {
+                        close = static_cast<const char*>(std::memchr(p + 1, '>', static_cast<size_t>(end - p - 1)));
+                    }
+
+                    if (close == nullptr)
+                    {
+                        if (!atEnd)
+                            return tagStart;
+
+                        Error(XmlMapErrorKind::BadSyntax, tagStart);
+                        return end;
+                    }
+
+                    if (p[1] != '?' && p[1] != '!' && p[1] != '/')
+                    {
+                        Element(tagStart, close);
+                        if (m_state.failed)
+                            return close + 1;
+                    }
+
+                    p = close + closeLength;
+                }
+            }
+
+        private:
+            static bool IsSpace(char c)
+            {
+                return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+            }
+
+            static bool StartsWith(const char* p, const char* end, const char* prefix)
+            {
+                const size_t length = std::strlen(prefix);
+                return static_cast<size_t>(end - p) >= length && std::memcmp(p, prefix, length) == 0;
+            }
+
+            static const char* Find(const char* p, const char* end, const char* pattern)
+            {
+                const size_t length = std::strlen(pattern);
+                while (static_cast<size_t>(end - p) >= length)
+                {
+                    p = static_cast<const char*>(std::memchr(p, pattern[0], static_cast<size_t>(end - p) - length + 1));
+                    if (p == nullptr)
+                        return nullptr;
+
+                    if (std::memcmp(p, pattern, length) == 0)
+                        return p;
+
+                    ++p;
+                }
+
+                return nullptr;
+            }
+
+            static bool Equals(const char* begin, const char* end, const char* name)
+            {
+                const size_t length = std::strlen(name);
+                return static_cast<size_t>(end - begin) == length && std::memcmp(begin, name, length) == 0;
+            }
+
+            template<typename TValue>
+            static bool ParseNumber(const char* begin, const char* end, TValue* value)
+            {
+                while (begin != end && IsSpace(*begin))
+                {
+                    ++begin;
+                }
+
+                while (begin != end && IsSpace(end[-1]))
+                {
+                    --end;
+                }
+
+                if (begin != end && *begin == '+')
+                {
+                    ++begin;
+                }
+
+                auto result = std::from_chars(begin, end, *value);
+                return begin != end && result.ec == std::errc{} && result.ptr == end;
+            }
+
+            void Error(XmlMapErrorKind kind, const char* at)
+            {
+                m_line += static_cast<uint64_t>(std::count(m_lineCursor, at, '\n'));
+                m_lineCursor = at;
+                m_sink.OnError(XmlMapError{ kind, m_baseOffset + static_cast<uint64_t>(at - m_base), m_line, 0 });
+            }
+
+            // [tagStart, close)는 '<'부터 '>' 앞까지이다.
+            void Element(const char* tagStart, const char* close)
+            {
+                const char* nameBegin = tagStart + 1;
+                const char* p = nameBegin;
+                while (p != close && !IsSpace(*p) && *p != '/')
+                {
+                    ++p;
+                }
+
+                const char* nameEnd = p;
+                if (!m_state.rootSeen)
+                {
+                    if (!Equals(nameBegin, nameEnd, "map"))
+                    {
+                        m_line += static_cast<uint64_t>(std::count(m_lineCursor, tagStart, '\n'));
+                        m_lineCursor = tagStart;
+                        m_state.failed = true;
+                        m_state.error = XmlMapError{ XmlMapErrorKind::NotMapFile, m_baseOffset + static_cast<uint64_t>(tagStart - m_base), m_line, 0 };
+                        return;
+                    }
+
+                    m_state.rootSeen = true;
+                    return;
+                }
+
+                const bool isNode = Equals(nameBegin, nameEnd, "node");
+                if (!isNode && !Equals(nameBegin, nameEnd, "link"))
+                    return;
+
+                // node: id, x, y / link: from, to
+                const char* names[3] = { "id", "x", "y" };
+                if (!isNode)
+                {
+                    names[0] = "from";
+                    names[1] = "to";
+                    names[2] = nullptr;
+                }
+
+                const char* values[3][2] = {};
+                while (true)
+                {
+                    while (p != close && IsSpace(*p))
+                    {
+                        ++p;
+                    }
+
+                    if (p == close || *p == '/')
+                        break;
+
+                    const char* attrBegin = p;
+                    while (p != close && !IsSpace(*p) && *p != '=' && *p != '/')
+                    {
+                        ++p;
+                    }
+
+                    const char* attrEnd = p;
+                    while (p != close && IsSpace(*p))
+                    {
+                        ++p;
+                    }
+
+                    if (p == close || *p != '=')
+                    {
+                        Error(XmlMapErrorKind::BadSyntax, tagStart);
+                        return;
+                    }
+
+                    ++p;
+                    while (p != close && IsSpace(*p))
+                    {
+                        ++p;
+                    }
+
+                    if (p == close || (*p != '"' && *p != '\''))
+                    {
+                        Error(XmlMapErrorKind::BadSyntax, tagStart);
+                        return;
+                    }
+
+                    const char quote = *p++;
+                    const char* valueBegin = p;
+                    p = static_cast<const char*>(std::memchr(p, quote, static_cast<size_t>(close - p)));
+                    if (p == nullptr)
+                    {
+                        Error(XmlMapErrorKind::BadSyntax, tagStart);
+                        return;
+                    }
+
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        if (names[i] != nullptr && Equals(attrBegin, attrEnd, names[i]))
+                        {
+                            values[i][0] = valueBegin;
+                            values[i][1] = p;
+                        }
+                    }
+
+                    ++p;
+                }
+
+                const int valueCount = isNode ? 3 : 2;
+                for (int i = 0; i < valueCount; ++i)
+                {
+                    if (values[i][0] == nullptr)
+                    {
+                        Error(XmlMapErrorKind::MissingAttribute, tagStart);
+                        return;
+                    }
+                }
+
+                uint64_t first;
+                if (!ParseNumber(values[0][0], values[0][1], &first))
+                {
+                    Error(XmlMapErrorKind::BadAttribute, tagStart);
+                    return;
+                }
+
+                if (isNode)
+                {
+                    float x;
+                    float y;
+                    if (first == 0 || !ParseNumber(values[1][0], values[1][1], &x) || !ParseNumber(values[2][0], values[2][1], &y))
+                    {
+                        Error(XmlMapErrorKind::BadAttribute, tagStart);
+                        return;
+                    }
+
+                    m_sink.OnNode(first, x, y);
+                }
+                else
+                {
+                    uint64_t second;
+                    if (!ParseNumber(values[1][0], values[1][1], &second))
+                    {
+                        Error(XmlMapErrorKind::BadAttribute, tagStart);
+                        return;
+                    }
+
+                    m_sink.OnLink(first, second);
+                }
+            }
+
+            TSink& m_sink;
+            State& m_state;
+            const char* m_base;
+            uint64_t m_baseOffset;
+            const char* m_lineCursor;
+            uint64_t m_line;
+        };
+
+        size_t m_bufferSize;
+        size_t m_chunkSize;
+    };
+
+    // XmlMapReader의 레코드를 BinaryMapData로 모은다.
+    // Finish에서 중복 노드와 없는 노드를 가리키는 간선을 오류로 알리고 뺀 뒤 CSR을 만든다.
+    class XmlMapCollector
+    {
+    public:
+        explicit XmlMapCollector(BinaryMapData* data, size_t maxStoredErrors = 64)
+            : m_data{ data }
+            , m_maxStoredErrors{ maxStoredErrors }
+            , m_errorCount{ 0 }
+        {
+
+        }
+
+        // 진행률 콜백. false를 돌려주면 읽기를 멈춘다.
+        void SetProgressCallback(std::function<bool(uint64_t, uint64_t)> callback)
+        {
+            m_progress = std::move(callback);
+        }
+
+        void OnNode(uint64_t id, float x, float y)
+        {
+            m_data->nodeIds.push_back(id);
+            m_data->x.push_back(x);
+            m_data->y.push_back(y);
+        }
+
+        void OnLink(uint64_t fromNodeId, uint64_t toNodeId)
+        {
+            m_links.emplace_back(fromNodeId, toNodeId);
+        }
+
+        void OnError(const XmlMapError& error)
+        {
+            m_errorCount += 1;
+            if (m_errors.size() < m_maxStoredErrors)
+            {
+                m_errors.push_back(error);
+            }
+        }
+
+        bool OnProgress(uint64_t readBytes, uint64_t totalBytes)
+        {
+            return !m_progress || m_progress(readBytes, totalBytes);
+        }
+
+        bool Finish()
+        {
+            // 같은 ID가 여러 번 나오면 처음 것만 남긴다.
+            const size_t nodeCount = m_data->nodeIds.size();
+            std::vector<std::pair<uint64_t, uint32_t>> order(nodeCount);
+            for (uint32_t i = 0; i < nodeCount; ++i)
+            {
+                order[i] = { m_data->nodeIds[i], i };
+            }
+
+            std::sort(order.begin(), order.end());
+            std::vector<uint8_t> keep(nodeCount, 1);
+            std::vector<uint64_t> ids;
+            ids.reserve(nodeCount);
+            for (size_t i = 0; i < nodeCount; ++i)
+            {
+                if (i != 0 && order[i].first == order[i - 1].first)
+                {
+                    keep[order[i].second] = 0;
+                    OnError(XmlMapError{ XmlMapErrorKind::DuplicateNode, 0, 0, order[i].first });
+                    continue;
+                }
+
+                ids.push_back(order[i].first);
+            }
+
+            if (ids.size() != nodeCount)
+            {
+                size_t count = 0;
+                for (size_t i = 0; i < nodeCount; ++i)
+                {
+                    if (keep[i] == 0)
+                        continue;
+
+                    m_data->nodeIds[count] = m_data->nodeIds[i];
+                    m_data->x[count] = m_data->x[i];
+                    m_data->y[count] = m_data->y[i];
+                    count += 1;
+                }
+
+                m_data->nodeIds.resize(count);
+                m_data->x.resize(count);
+                m_data->y.resize(count);
+            }
+
+            auto isKnown = [&ids](uint64_t nodeId) { return std::binary_search(ids.begin(), ids.end(), nodeId); };
+            size_t linkCount = 0;
+            for (auto& it : m_links)
+            {
+                if (!isKnown(it.first) || !isKnown(it.second))
+                {
+                    OnError(XmlMapError{ XmlMapErrorKind::UnknownNode, 0, 0, isKnown(it.first) ? it.second : it.first });
+                    continue;
+                }
+
+                m_links[linkCount++] = it;
+            }
+
+            m_links.resize(linkCount);
+            const bool built = m_data->BuildLinks(m_links);
+            std::vector<std::pair<uint64_t, uint64_t>>{}.swap(m_links);
+            return built;
+        }
+
+        uint64_t GetErrorCount() const { return m_errorCount; }
+
+        // 앞에서부터 maxStoredErrors개까지만 남긴다.
+        const std::vector<XmlMapError>& GetErrors() const { return m_errors; }
+
+    private:
+        BinaryMapData* m_data;
+        std::vector<std::pair<uint64_t, uint64_t>> m_links;
+        std::vector<XmlMapError> m_errors;
+        size_t m_maxStoredErrors;
+        uint64_t m_errorCount;
+        std::function<bool(uint64_t, uint64_t)> m_progress;
+    };
+}
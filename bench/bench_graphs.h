@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "grid_map.h"
+#include "spatial_index.h"
+
+namespace astar::bench
+{
+    // 벤치마크용 무방향 그래프. 노드 ID는 인덱스 + 1이고 간선 비용은 두 노드 사이의 유클리드 거리이다.
+    struct BenchGraph
+    {
+        std::string name;
+        std::vector<float> x;
+        std::vector<float> y;
+        // 인덱스 쌍. 같은 쌍은 한 번만 들어 있다.
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        // 가장 큰 연결 요소의 노드. 질의 양 끝은 여기서 고른다.
+        std::vector<uint32_t> queryNodes;
+        // 격자 그래프일 때만 있다. 노드 인덱스는 GridMap::ToNodeId - 1과 같다.
+        std::unique_ptr<GridMap> grid;
+
+        size_t NodeCount() const { return x.size(); }
+
+        float Length(uint32_t a, uint32_t b) const
+        {
+            const float dx = x[a] - x[b];
+            const float dy = y[a] - y[b];
+            return std::sqrt(dx * dx + dy * dy);
+        }
+    };
+
+    // 표준 분포 클래스는 구현마다 결과가 달라서 쓰지 않는다. mt19937_64의 출력만 쓰면 어느 플랫폼에서나 같은 그래프가 나온다.
+    class BenchRandom
+    {
+    public:
+        explicit BenchRandom(uint64_t seed)
+            : m_engine{ seed }
+        {
+
+        }
+
+        // [0, 1)
+        float NextFloat()
+        {
+            return static_cast<float>(m_engine() >> 40) * (1.f / 16777216.f);
+        }
+
+        uint32_t NextIndex(uint32_t count)
+        {
+            return static_cast<uint32_t>(m_engine() % count);
+        }
+
+    private:
+        std::mt19937_64 m_engine;
+    };
+
+    inline void FinishGraph(BenchGraph* graph)
+    {
+        for (auto& it : graph->edges)
+        {
+            if (it.first > it.second)
+            {
+                std::swap(it.first, it.second);
+            }
+        }
+
+        std::sort(graph->edges.begin(), graph->edges.end());
+        graph->edges.erase(std::unique(graph->edges.begin(), graph->edges.end()), graph->edges.end());
+        graph->edges.erase(std::remove_if(graph->edges.begin(), graph->edges.end(), [](auto& it) { return it.first == it.second; }), graph->edges.end());
+
+        // union-find로 가장 큰 연결 요소를 찾는다.
+        const uint32_t nodeCount = static_cast<uint32_t>(graph->NodeCount());
+        std::vector<uint32_t> parent(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            parent[i] = i;
+        }
+
+        auto find = [&parent](uint32_t node)
+        {
+            while (parent[node] != node)
+            {
+                parent[node] = parent[parent[node]];
+                node = parent[node];
+            }
+
+            return node;
+        };
+
+        for (auto& it : graph->edges)
+        {
+            parent[find(it.first)] = find(it.second);
+        }
+
+        std::vector<uint32_t> size(nodeCount, 0);
+        uint32_t largest = 0;
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            const uint32_t root = find(i);
+            size[root] += 1;
+            if (size[root] > size[largest])
+            {
+                largest = root;
+            }
+        }
+
+        graph->queryNodes.clear();
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            if (find(i) == largest)
+            {
+                graph->queryNodes.push_back(i);
+            }
+        }
+    }
+
+    // 정사각형 안에 고르게 흩은 점을 각자 가장 가까운 k개와 잇는다.
+    inline BenchGraph MakeRandomGraph(uint32_t nodeCount, uint32_t degree, uint64_t seed)
+    {
+        BenchGraph graph;
+        graph.name = "random";
+        BenchRandom random{ seed };
+        const float side = std::sqrt(static_cast<float>(nodeCount)) * 10.f;
+        SpatialGrid<uint32_t> index{ 20.f };
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            graph.x.push_back(random.NextFloat() * side);
+            graph.y.push_back(random.NextFloat() * side);
+            index.Insert(i, graph.x[i], graph.y[i]);
+        }
+
+        std::vector<std::pair<float, uint32_t>> nearest;
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            index.FindKNearest(graph.x[i], graph.y[i], degree + 1, &nearest);
+            for (auto& it : nearest)
+            {
+                graph.edges.emplace_back(i, it.second);
+            }
+        }
+
+        FinishGraph(&graph);
+        return graph;
+    }
+
+    // 8방향 격자. 칸의 일부를 무작위 점과 벽 조각으로 막는다.
+    inline BenchGraph MakeGridGraph(uint32_t side, uint64_t seed)
+    {
+        BenchGraph graph;
+        graph.name = "grid";
+        BenchRandom random{ seed };
+        graph.grid = std::make_unique<GridMap>(side, side);
+        GridMap& grid = *graph.grid;
+        for (uint32_t y = 0; y < side; ++y)
+        {
+            for (uint32_t x = 0; x < side; ++x)
+            {
+                if (random.NextFloat() < 0.15f)
+                {
+                    grid.SetBlocked(x, y, true);
+                }
+            }
+        }
+
+        const uint32_t wallCount = side / 4;
+        for (uint32_t i = 0; i < wallCount; ++i)
+        {
+            const uint32_t x = random.NextIndex(side);
+            const uint32_t y = random.NextIndex(side);
+            const uint32_t length = side / 8 + random.NextIndex(side / 4 + 1);
+            const bool horizontal = random.NextIndex(2) == 0;
+            for (uint32_t k = 0; k < length; ++k)
+            {
+                const uint32_t wx = horizontal ? x + k : x;
+                const uint32_t wy = horizontal ? y : y + k;
+                if (wx < side && wy < side)
+                {
+                    grid.SetBlocked(wx, wy, true);
+                }
+            }
+        }
+
+        for (uint32_t y = 0; y < side; ++y)
+        {
+            for (uint32_t x = 0; x < side; ++x)
+            {
+                graph.x.push_back(static_cast<float>(x));
+                graph.y.push_back(static_cast<float>(y));
+            }
+        }
+
+        grid.ForEachMove([&graph](GridMap::NodeId from, GridMap::NodeId to, float)
+            {
+                graph.edges.emplace_back(static_cast<uint32_t>(from - 1), static_cast<uint32_t>(to - 1));
+            });
+
+        FinishGraph(&graph);
+        return graph;
+    }
+
+    // 흔들린 격자 모양의 골목길에 몇 줄마다 멀리 뻗는 큰길을 더한 도로망.
+    inline BenchGraph MakeRoadGraph(uint32_t side, uint64_t seed)
+    {
+        constexpr float spacing = 10.f;
+        constexpr uint32_t highwayStride = 8;
+        BenchGraph graph;
+        graph.name = "road";
+        BenchRandom random{ seed };
+        for (uint32_t j = 0; j < side; ++j)
+        {
+            for (uint32_t i = 0; i < side; ++i)
+            {
+                graph.x.push_back(i * spacing + (random.NextFloat() - 0.5f) * spacing * 0.6f);
+                graph.y.push_back(j * spacing + (random.NextFloat() - 0.5f) * spacing * 0.6f);
+            }
+        }
+
+        auto index = [side](uint32_t i, uint32_t j) { return j * side + i; };
+        for (uint32_t j = 0; j < side; ++j)
+        {
+            for (uint32_t i = 0; i < side; ++i)
+            {
+                if (i + 1 < side && random.NextFloat() < 0.85f)
+                {
+                    graph.edges.emplace_back(index(i, j), index(i + 1, j));
+                }
+
+                if (j + 1 < side && random.NextFloat() < 0.85f)
+                {
+                    graph.edges.emplace_back(index(i, j), index(i, j + 1));
+                }
+
+                if (j % highwayStride == 0 && i + highwayStride < side && i % highwayStride == 0)
+                {
+                    graph.edges.emplace_back(index(i, j), index(i + highwayStride, j));
+                }
+
+                if (i % highwayStride == 0 && j + highwayStride < side && j % highwayStride == 0)
+                {
+                    graph.edges.emplace_back(index(i, j), index(i, j + highwayStride));
+                }
+            }
+        }
+
+        FinishGraph(&graph);
+        return graph;
+    }
+}
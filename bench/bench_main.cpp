@@ -0,0 +1,1412 @@
+// GUI 없이 길찾기 엔진의 성능을 재는 벤치마크.
+// 같은 시드면 같은 그래프와 같은 질의를 만들므로 결과 파일끼리 비교해서 회귀를 찾을 수 있다.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "bench_graphs.h"
+#include "binary_map.h"
+#include "grid_map.h"
+#include "landmark_heuristic.h"
+#include "map.h"
+#include "node_id_set.h"
+#include "open_list.h"
+#include "path_finder.h"
+#include "path_query_service.h"
+#include "search_state.h"
+#include "search_task.h"
+#include "search_trace.h"
+#include "spatial_index.h"
+#include "thread_pool.h"
+#include "xml_map_reader.h"
+
+namespace
+{
+    using namespace astar;
+    using namespace astar::bench;
+    using Clock = std::chrono::steady_clock;
+
+    // 전역 operator new가 불린 횟수. alloc 묶음이 질의 전후의 차이를 본다.
+    std::atomic<uint64_t> allocationCount{ 0 };
+
+    // 꺼낸 노드 수를 세는 열린 목록. 확장한 노드 수는 엔진마다 Pop 횟수와 같다.
+    template<typename TBase>
+    struct CountingOpenList : TBase
+    {
+        uint32_t Pop()
+        {
+            popCount += 1;
+            return TBase::Pop();
+        }
+
+        uint64_t popCount = 0;
+    };
+
+    using CountingQuadHeap = CountingOpenList<QuadHeapOpenList>;
+    using CountingRadixHeap = CountingOpenList<RadixHeapOpenList>;
+
+    struct Options
+    {
+        uint64_t seed = 1;
+        uint32_t queryCount = 1000;
+        float scale = 1.f;
+        std::string outputPath = "bench_results.json";
+        std::vector<std::string> graphs;
+        std::vector<std::string> engines;
+        std::vector<std::string> suites;
+    };
+
+    struct Record
+    {
+        std::string suite;
+        std::string graph;
+        std::string engine;
+        std::vector<std::pair<std::string, double>> metrics;
+    };
+
+    bool Selected(const std::vector<std::string>& filter, const std::string& name)
+    {
+        return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+    }
+
+    std::vector<std::string> SplitList(const char* text)
+    {
+        std::vector<std::string> result;
+        std::string item;
+        for (const char* it = text; ; ++it)
+        {
+            if (*it == ',' || *it == '\0')
+            {
+                if (!item.empty())
+                {
+                    result.push_back(item);
+                }
+
+                item.clear();
+                if (*it == '\0')
+                    break;
+
+                continue;
+            }
+
+            item.push_back(*it);
+        }
+
+        return result;
+    }
+
+    double ElapsedMs(Clock::time_point begin)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    double Percentile(std::vector<double> values, double ratio)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(ratio * (values.size() - 1) + 0.5));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    // 엔진 하나를 같은 질의 목록으로 잰다.
+    // query(from, to)는 노드 인덱스 경로를 path에 채우고 찾았는지 돌려준다. 경로 비용은 시간 밖에서 계산한다.
+    template<typename TQuery>
+    Record Measure(const BenchGraph& graph, const char* engine, const std::vector<std::pair<uint32_t, uint32_t>>& queries, double prepareMs, const uint64_t* popCount, TQuery&& query)
+    {
+        std::vector<uint32_t> path;
+        // 캐시와 버퍼를 데우는 질의. 재지 않는다.
+        const size_t warmupCount = std::min<size_t>(queries.size(), 32);
+        for (size_t i = 0; i < warmupCount; ++i)
+        {
+            query(queries[i].first, queries[i].second, &path);
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(queries.size());
+        uint64_t expanded = 0;
+        uint32_t found = 0;
+        double costSum = 0.0;
+        double totalUs = 0.0;
+        for (auto& it : queries)
+        {
+            const uint64_t popBefore = popCount != nullptr ? *popCount : 0;
+            const auto begin = Clock::now();
+            const bool success = query(it.first, it.second, &path);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+            latencies.push_back(us);
+            totalUs += us;
+            if (popCount != nullptr)
+            {
+                expanded += *popCount - popBefore;
+            }
+
+            if (!success)
+                continue;
+
+            found += 1;
+            for (size_t i = 1; i < path.size(); ++i)
+            {
+                costSum += graph.Length(path[i - 1], path[i]);
+            }
+        }
+
+        const double count = static_cast<double>(std::max<size_t>(queries.size(), 1));
+        Record record{ "query", graph.name, engine, {} };
+        record.metrics = {
+            { "nodes", static_cast<double>(graph.NodeCount()) },
+            { "links", static_cast<double>(graph.edges.size()) },
+            { "queries", static_cast<double>(queries.size()) },
+            { "found", static_cast<double>(found) },
+            { "prepare_ms", prepareMs },
+            { "expanded_mean", static_cast<double>(expanded) / count },
+            { "mean_us", totalUs / count },
+            { "p50_us", Percentile(latencies, 0.50) },
+            { "p99_us", Percentile(latencies, 0.99) },
+            { "qps", totalUs > 0.0 ? count * 1e6 / totalUs : 0.0 },
+            { "cost_sum", costSum },
+        };
+        return record;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> MakeQueries(const BenchGraph& graph, uint32_t count, uint64_t seed)
+    {
+        BenchRandom random{ seed };
+        std::vector<std::pair<uint32_t, uint32_t>> queries;
+        const uint32_t candidateCount = static_cast<uint32_t>(graph.queryNodes.size());
+        if (candidateCount < 2)
+            return queries;
+
+        while (queries.size() < count)
+        {
+            const uint32_t from = graph.queryNodes[random.NextIndex(candidateCount)];
+            const uint32_t to = graph.queryNodes[random.NextIndex(candidateCount)];
+            if (from != to)
+            {
+                queries.emplace_back(from, to);
+            }
+        }
+
+        return queries;
+    }
+
+    // 무방향 그래프를 양방향 간선으로 바꾼 CSR. NodeId는 인덱스 + 1이다.
+    BinaryMapData MakeBinaryMapData(const BenchGraph& graph)
+    {
+        BinaryMapData data;
+        const size_t nodeCount = graph.NodeCount();
+        data.nodeIds.resize(nodeCount);
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            data.nodeIds[i] = i + 1;
+        }
+
+        data.x = graph.x;
+        data.y = graph.y;
+        std::vector<std::pair<uint64_t, uint64_t>> links;
+        links.reserve(graph.edges.size() * 2);
+        for (auto& it : graph.edges)
+        {
+            links.emplace_back(it.first + 1ull, it.second + 1ull);
+            links.emplace_back(it.second + 1ull, it.first + 1ull);
+        }
+
+        data.BuildLinks(links);
+        return data;
+    }
+
+    struct LinkCost
+    {
+        float operator()(size_t src, size_t dst, const GenericPathFinder::Link*) const
+        {
+            return graph->Length(static_cast<uint32_t>(src - 1), static_cast<uint32_t>(dst - 1));
+        }
+
+        const BenchGraph* graph;
+    };
+
+    struct EuclideanH
+    {
+        float operator()(size_t src, size_t dst) const
+        {
+            return graph->Length(static_cast<uint32_t>(src - 1), static_cast<uint32_t>(dst - 1));
+        }
+
+        const BenchGraph* graph;
+    };
+
+    // 한 변에 노드가 12개쯤 들어가는 군집 크기
+    float ClusterSize(const BenchGraph& graph)
+    {
+        const auto [minX, maxX] = std::minmax_element(graph.x.begin(), graph.x.end());
+        const auto [minY, maxY] = std::minmax_element(graph.y.begin(), graph.y.end());
+        const float area = std::max(1.f, (*maxX - *minX) * (*maxY - *minY));
+        return 12.f * std::sqrt(area / static_cast<float>(graph.NodeCount()));
+    }
+
+    void ToIndexPath(const std::vector<size_t>& nodeIds, std::vector<uint32_t>* path)
+    {
+        path->clear();
+        for (auto it : nodeIds)
+        {
+            path->push_back(static_cast<uint32_t>(it - 1));
+        }
+    }
+
+    void RunQueryEngines(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        const auto queries = MakeQueries(graph, options.queryCount, options.seed * 7919 + 17);
+        const BinaryMapData data = MakeBinaryMapData(graph);
+        std::vector<size_t> nodeIds;
+
+        if (Selected(options.engines, "map") || Selected(options.engines, "map_radix"))
+        {
+            auto begin = Clock::now();
+            Map map;
+            map.Reserve(graph.NodeCount(), graph.edges.size());
+            for (size_t i = 0; i < graph.NodeCount(); ++i)
+            {
+                map.AddNode(graph.x[i], graph.y[i]);
+            }
+
+            for (auto& it : graph.edges)
+            {
+                map.MakeLink(it.first, it.second);
+            }
+
+            const double prepareMs = ElapsedMs(begin);
+            std::vector<Map::NodeHandle> handles;
+            if (Selected(options.engines, "map"))
+            {
+                PathQueryContext<CountingQuadHeap> context;
+                records->push_back(Measure(graph, "map", queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        return map.Navigate(from, to, path, context);
+                    }));
+            }
+
+            if (Selected(options.engines, "map_radix"))
+            {
+                PathQueryContext<CountingRadixHeap> context;
+                records->push_back(Measure(graph, "map_radix", queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        return map.Navigate(from, to, path, context);
+                    }));
+            }
+        }
+
+        auto loadFinder = [&](auto& finder)
+        {
+            finder.LoadGraph(data.nodeIds.size(), data.nodeIds.data(), data.linkOffsets.data(), data.linkTargets.data());
+        };
+
+        if (Selected(options.engines, "generic") || Selected(options.engines, "generic_traced") || Selected(options.engines, "generic_anytime") || Selected(options.engines, "generic_task") || Selected(options.engines, "generic_async") || Selected(options.engines, "generic_bidirectional") || Selected(options.engines, "generic_bidirectional_radix") || Selected(options.engines, "contraction_hierarchy") || Selected(options.engines, "hpa") || Selected(options.engines, "hpa_exact"))
+        {
+            auto begin = Clock::now();
+            TGenericPathFinder<LinkCost, EuclideanH> finder{ LinkCost{ &graph }, EuclideanH{ &graph } };
+            loadFinder(finder);
+            // 첫 질의에서 일어나는 간선 색인과 비용 계산까지 준비 시간에 넣는다.
+            finder.Navigate(1, 1, &nodeIds);
+            const double prepareMs = ElapsedMs(begin);
+            PathQueryContext<CountingQuadHeap> context;
+            if (Selected(options.engines, "generic"))
+            {
+                records->push_back(Measure(graph, "generic", queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.Navigate(from + 1, to + 1, &nodeIds, context);
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    }));
+            }
+
+            if (Selected(options.engines, "generic_traced"))
+            {
+                // 통계를 모으는 비용을 generic과 비교한다.
+                PathQueryContext<CountingQuadHeap, SearchTrace> tracedContext;
+                records->push_back(Measure(graph, "generic_traced", queries, prepareMs, &tracedContext.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.Navigate(from + 1, to + 1, &nodeIds, tracedContext);
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    }));
+            }
+
+            if (Selected(options.engines, "generic_anytime"))
+            {
+                // 1.2배 이내로 보장되는 첫 경로까지의 시간. cost_sum을 generic과 비교하면 실제 손해를 알 수 있다.
+                uint64_t popCount = 0;
+                records->push_back(Measure(graph, "generic_anytime", queries, prepareMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.NavigateAnytime(from + 1, to + 1, Clock::time_point::max(), [&](const std::vector<size_t>& solution, float)
+                            {
+                                ToIndexPath(solution, path);
+                                return false;
+                            }, 1.2f, 0.2f);
+                        popCount += finder.GetAnytimePlanner().GetExpandedCount();
+                        return found;
+                    }));
+            }
+
+            if (Selected(options.engines, "generic_task"))
+            {
+                // 256개씩 끊어서 진행할 때 드는 비용을 generic과 비교한다. 프레임 예산은 두지 않는다.
+                uint64_t popCount = 0;
+                SearchScheduler scheduler;
+                records->push_back(Measure(graph, "generic_task", queries, prepareMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        bool found = false;
+                        scheduler.Add(finder.CreateSearchTask(from + 1, to + 1), [&](SearchTask& task)
+                            {
+                                found = task.GetPath(&nodeIds);
+                                popCount += task.GetExpandedCount();
+                            });
+
+                        while (!scheduler.Empty())
+                        {
+                            scheduler.RunFrame(std::chrono::hours{ 1 });
+                        }
+
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    }));
+            }
+
+            if (Selected(options.engines, "generic_async"))
+            {
+                // 작업자 스레드에 넘기고 결과를 기다리는 왕복 비용을 generic과 비교한다. 스냅샷은 준비 시간에 넣는다.
+                begin = Clock::now();
+                auto snapshot = finder.CreateGraphSnapshot([&graph](size_t nodeId, float* x, float* y)
+                    {
+                        *x = graph.x[nodeId - 1];
+                        *y = graph.y[nodeId - 1];
+                    });
+                const double snapshotMs = ElapsedMs(begin);
+                uint64_t popCount = 0;
+                PathQueryService service;
+                std::mutex mutex;
+                std::condition_variable done;
+                records->push_back(Measure(graph, "generic_async", queries, prepareMs + snapshotMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        bool finished = false;
+                        PathQueryResult result;
+                        service.Submit(snapshot, from + 1, to + 1, [&](PathQueryResult&& it)
+                            {
+                                std::lock_guard<std::mutex> guard{ mutex };
+                                result = std::move(it);
+                                finished = true;
+                                done.notify_one();
+                            });
+
+                        std::unique_lock<std::mutex> lock{ mutex };
+                        done.wait(lock, [&finished]() { return finished; });
+                        popCount += result.expandedCount;
+                        ToIndexPath(result.path, path);
+                        return result.status == PathQueryStatus::Found;
+                    }));
+            }
+
+            if (Selected(options.engines, "generic_bidirectional"))
+            {
+                // 양방향 탐색은 역방향 열린 목록도 쓰므로 두 목록의 합을 센다.
+                uint64_t popCount = 0;
+                records->push_back(Measure(graph, "generic_bidirectional", queries, prepareMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.Navigate(from + 1, to + 1, &nodeIds, context, SearchMode::Bidirectional);
+                        popCount = context.openList.popCount + context.backwardOpenList.popCount;
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    }));
+            }
+
+            // radix 힙은 음수 키를 받지 못하므로 양방향을 요청해도 단방향으로 찾는다. cost_sum이 generic과 같아야 한다.
+            if (Selected(options.engines, "generic_bidirectional_radix"))
+            {
+                PathQueryContext<CountingRadixHeap> radixContext;
+                uint64_t popCount = 0;
+                records->push_back(Measure(graph, "generic_bidirectional_radix", queries, prepareMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.Navigate(from + 1, to + 1, &nodeIds, radixContext, SearchMode::Bidirectional);
+                        popCount = radixContext.openList.popCount + radixContext.backwardOpenList.popCount;
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    }));
+            }
+
+            if (Selected(options.engines, "contraction_hierarchy"))
+            {
+                begin = Clock::now();
+                finder.BuildContractionHierarchy();
+                const double buildMs = ElapsedMs(begin);
+                uint64_t popCount = 0;
+                Record record = Measure(graph, "contraction_hierarchy", queries, prepareMs + buildMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.NavigateHierarchy(from + 1, to + 1, &nodeIds, context);
+                        popCount = context.openList.popCount + context.backwardOpenList.popCount;
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    });
+                const auto& statistics = finder.GetContractionHierarchy().GetStatistics();
+                record.metrics.emplace_back("shortcut_count", static_cast<double>(statistics.shortcutCount));
+                record.metrics.emplace_back("contract_ms", statistics.preprocessSeconds * 1000.0);
+                records->push_back(std::move(record));
+            }
+
+            // hpa_exact는 경계 간선을 모두 남겨서 최단 경로를 찾고, hpa는 군집 쌍마다 4개만 남긴다.
+            // cost_sum을 generic과 비교하면 경로 손해를, mean_us를 비교하면 속도 차이를 알 수 있다.
+            const std::pair<const char*, uint32_t> clusterEngines[]{ { "hpa_exact", 0 }, { "hpa", 4 } };
+            for (auto& engine : clusterEngines)
+            {
+                if (!Selected(options.engines, engine.first))
+                    continue;
+
+                begin = Clock::now();
+                finder.BuildClusterGraph([&graph](size_t nodeId, float* x, float* y)
+                    {
+                        *x = graph.x[nodeId - 1];
+                        *y = graph.y[nodeId - 1];
+                    }, ClusterGraph::Options{ ClusterSize(graph), engine.second });
+                const double buildMs = ElapsedMs(begin);
+                PathQueryContext<CountingQuadHeap> clusterContext;
+                uint64_t popCount = 0;
+                Record record = Measure(graph, engine.first, queries, prepareMs + buildMs, &popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = finder.NavigateClustered(from + 1, to + 1, &nodeIds, clusterContext);
+                        popCount = clusterContext.openList.popCount + clusterContext.backwardOpenList.popCount;
+                        ToIndexPath(nodeIds, path);
+                        return found;
+                    });
+                const auto& statistics = finder.GetClusterGraph().GetStatistics();
+                record.metrics.emplace_back("cluster_count", static_cast<double>(statistics.clusterCount));
+                record.metrics.emplace_back("entrance_count", static_cast<double>(statistics.entranceCount));
+                record.metrics.emplace_back("intra_edge_count", static_cast<double>(statistics.intraEdgeCount));
+                record.metrics.emplace_back("transition_count", static_cast<double>(statistics.transitionCount));
+                records->push_back(std::move(record));
+            }
+        }
+
+        if (Selected(options.engines, "generic_alt"))
+        {
+            auto begin = Clock::now();
+            TGenericPathFinder<LinkCost, LandmarkHeuristic> finder{ LinkCost{ &graph }, LandmarkHeuristic{} };
+            loadFinder(finder);
+            finder.GetFuncterH().SetTable(finder.BuildLandmarkTable(16, LandmarkSelection::Avoid));
+            const double prepareMs = ElapsedMs(begin);
+            PathQueryContext<CountingQuadHeap> context;
+            records->push_back(Measure(graph, "generic_alt", queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                {
+                    const bool found = finder.Navigate(from + 1, to + 1, &nodeIds, context);
+                    ToIndexPath(nodeIds, path);
+                    return found;
+                }));
+        }
+
+        if (Selected(options.engines, "binary_map_view"))
+        {
+            const auto filePath = std::filesystem::temp_directory_path() / ("astar_bench_" + graph.name + ".amap");
+            {
+                auto begin = Clock::now();
+                BinaryMapView view;
+                if (WriteBinaryMap(filePath, data) == BinaryMapError::None && view.Open(filePath) == BinaryMapError::None)
+                {
+                    const double prepareMs = ElapsedMs(begin);
+                    PathQueryContext<CountingQuadHeap> context;
+                    records->push_back(Measure(graph, "binary_map_view", queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                        {
+                            const bool found = view.Navigate(from + 1, to + 1, &nodeIds, context);
+                            ToIndexPath(nodeIds, path);
+                            return found;
+                        }));
+                }
+                else
+                {
+                    std::fprintf(stderr, "binary_map_view: cannot write %s\n", filePath.string().c_str());
+                }
+            }
+
+            std::error_code error;
+            std::filesystem::remove(filePath, error);
+        }
+
+        if (graph.grid != nullptr && (Selected(options.engines, "jps") || Selected(options.engines, "jps_plus")))
+        {
+            for (const bool useTable : { false, true })
+            {
+                const char* engine = useTable ? "jps_plus" : "jps";
+                if (!Selected(options.engines, engine))
+                    continue;
+
+                auto begin = Clock::now();
+                JumpPointSearch search{ *graph.grid };
+                if (useTable)
+                {
+                    search.BuildJumpTable();
+                }
+
+                const double prepareMs = ElapsedMs(begin);
+                PathQueryContext<CountingQuadHeap> context;
+                std::vector<GridMap::NodeId> cells;
+                Record record = Measure(graph, engine, queries, prepareMs, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                    {
+                        const bool found = search.Navigate(from + 1, to + 1, &cells, context);
+                        ToIndexPath(cells, path);
+                        return found;
+                    });
+                // 비트 격자와 점프 표를 합친 크기
+                record.metrics.emplace_back("memory_bytes", static_cast<double>(graph.grid->GetMemoryUsage() + search.GetMemoryUsage()));
+                records->push_back(std::move(record));
+            }
+        }
+    }
+
+    // NavigateBatch를 작업자 1개부터 하드웨어 스레드 수까지 늘려 가며 잰다. speedup은 작업자 1개일 때의 qps와 비교한 값이다.
+    void RunBatch(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        const auto indexQueries = MakeQueries(graph, options.queryCount, options.seed * 7919 + 17);
+        std::vector<std::pair<size_t, size_t>> queries;
+        queries.reserve(indexQueries.size());
+        for (auto& it : indexQueries)
+        {
+            queries.emplace_back(it.first + 1, it.second + 1);
+        }
+
+        const BinaryMapData data = MakeBinaryMapData(graph);
+        TGenericPathFinder<LinkCost, EuclideanH> finder{ LinkCost{ &graph }, EuclideanH{ &graph } };
+        finder.LoadGraph(data.nodeIds.size(), data.nodeIds.data(), data.linkOffsets.data(), data.linkTargets.data());
+        std::vector<GenericPathFinder::PathResult> results;
+        const unsigned maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+        double baseQps = 0.0;
+        for (unsigned workers = 1; workers <= maxWorkers; ++workers)
+        {
+            ThreadPool pool{ workers };
+            // 작업자마다 컨텍스트와 경로 버퍼를 데운다.
+            finder.NavigateBatch(queries, &results, pool);
+            const auto begin = Clock::now();
+            finder.NavigateBatch(queries, &results, pool);
+            const double ms = ElapsedMs(begin);
+
+            uint32_t found = 0;
+            double costSum = 0.0;
+            for (auto& result : results)
+            {
+                if (!result.found)
+                    continue;
+
+                found += 1;
+                for (size_t i = 1; i < result.path.size(); ++i)
+                {
+                    costSum += graph.Length(static_cast<uint32_t>(result.path[i - 1] - 1), static_cast<uint32_t>(result.path[i] - 1));
+                }
+            }
+
+            const double qps = ms > 0.0 ? queries.size() * 1000.0 / ms : 0.0;
+            if (workers == 1)
+            {
+                baseQps = qps;
+            }
+
+            records->push_back(Record{ "batch", graph.name, "navigate_batch_" + std::to_string(workers), {
+                { "workers", static_cast<double>(workers) },
+                { "queries", static_cast<double>(queries.size()) },
+                { "found", static_cast<double>(found) },
+                { "ms", ms },
+                { "qps", qps },
+                { "speedup", baseQps > 0.0 ? qps / baseQps : 0.0 },
+                { "cost_sum", costSum },
+            } });
+        }
+    }
+
+    // CoordinateStore의 거리 계산을 SetSimdLevel로 경로마다 고정해서 잰다.
+    // kernel_*은 간선 길이와 휴리스틱 계산만, map_*은 그 경로를 쓰는 Map::Navigate 전체를 잰다.
+    // mismatches는 스칼라 경로와 비트가 다른 결과 수이고 0이어야 한다.
+    void RunSimd(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        Map map;
+        map.Reserve(graph.NodeCount(), graph.edges.size());
+        for (size_t i = 0; i < graph.NodeCount(); ++i)
+        {
+            map.AddNode(graph.x[i], graph.y[i]);
+        }
+
+        std::vector<uint32_t> linkFrom;
+        std::vector<uint32_t> linkTo;
+        for (auto& it : graph.edges)
+        {
+            map.MakeLink(it.first, it.second);
+            linkFrom.push_back(it.first);
+            linkTo.push_back(it.second);
+        }
+
+        CoordinateStore& coordinates = map.GetCoordinateStore();
+        const SimdLevel bestLevel = coordinates.GetSimdLevel();
+        const std::pair<SimdLevel, const char*> levels[]{ { SimdLevel::Scalar, "scalar" }, { SimdLevel::Sse, "sse" }, { SimdLevel::Avx2, "avx2" } };
+        const size_t distanceCount = linkFrom.size() * 2;
+        const int repeat = std::max(1, static_cast<int>((4u << 20) / std::max<size_t>(distanceCount, 1)));
+        std::vector<float> lengths(linkFrom.size());
+        std::vector<float> heuristics(linkFrom.size());
+        std::vector<float> scalarLengths;
+        std::vector<float> scalarHeuristics;
+        double scalarNs = 0.0;
+        const auto queries = MakeQueries(graph, options.queryCount, options.seed * 7919 + 17);
+        for (auto& level : levels)
+        {
+            if (!coordinates.SetSimdLevel(level.first))
+                continue;
+
+            const auto begin = Clock::now();
+            for (int i = 0; i < repeat; ++i)
+            {
+                coordinates.Distances(linkFrom.data(), linkTo.data(), linkFrom.size(), lengths.data());
+                coordinates.Distances(linkTo.data(), linkTo.size(), graph.x[0], graph.y[0], heuristics.data());
+            }
+
+            const double ns = ElapsedMs(begin) * 1e6 / (static_cast<double>(distanceCount) * repeat);
+            if (level.first == SimdLevel::Scalar)
+            {
+                scalarLengths = lengths;
+                scalarHeuristics = heuristics;
+                scalarNs = ns;
+            }
+
+            size_t mismatches = 0;
+            for (size_t i = 0; i < linkFrom.size(); ++i)
+            {
+                mismatches += std::memcmp(&lengths[i], &scalarLengths[i], sizeof(float)) != 0 ? 1 : 0;
+                mismatches += std::memcmp(&heuristics[i], &scalarHeuristics[i], sizeof(float)) != 0 ? 1 : 0;
+            }
+
+            records->push_back(Record{ "simd", graph.name, std::string{ "kernel_" } + level.second, {
+                { "distances", static_cast<double>(distanceCount) },
+                { "ns_per_distance", ns },
+                { "speedup", ns > 0.0 ? scalarNs / ns : 0.0 },
+                { "mismatches", static_cast<double>(mismatches) },
+            } });
+
+            PathQueryContext<CountingQuadHeap> context;
+            Record record = Measure(graph, (std::string{ "map_" } + level.second).c_str(), queries, 0.0, &context.openList.popCount, [&](uint32_t from, uint32_t to, std::vector<uint32_t>* path)
+                {
+                    return map.Navigate(from, to, path, context);
+                });
+            record.suite = "simd";
+            records->push_back(std::move(record));
+        }
+
+        coordinates.SetSimdLevel(bestLevel);
+    }
+
+    // Map의 편집 연산을 잰다. 그래프 크기와 상관없이 핸들이 가까운 노드끼리 서로 다른 간선 100k개를 만들고 모든 노드를 한 번씩 옮긴다.
+    // make_link_ns로 중복 검사가 간선 해시로 O(1)인지, set_position_ns로 공간 색인 갱신 비용을 본다.
+    // generic은 같은 간선을 GenericPathFinder::MakeLink로 양방향 모두 만들고, 같은 간선을 한 번 더 넣어서 모두 거절되는지 본다.
+    void RunMapBuild(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        constexpr size_t linkCount = 100000;
+        constexpr uint32_t linkSpan = 64;
+        const uint32_t nodeCount = static_cast<uint32_t>(graph.NodeCount());
+        BenchRandom random{ options.seed * 17 + 3 };
+        std::vector<std::pair<uint32_t, uint32_t>> links;
+        links.reserve(linkCount);
+        NodeIdMap<uint8_t, uint64_t> seen;
+        const size_t maxLinkCount = static_cast<size_t>(nodeCount) * std::min(linkSpan, nodeCount - 1) / 2;
+        while (links.size() < std::min(linkCount, maxLinkCount))
+        {
+            const uint32_t a = random.NextIndex(nodeCount);
+            const uint32_t b = (a + 1 + random.NextIndex(std::min(linkSpan, nodeCount - 1))) % nodeCount;
+            const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            if (seen.insert(key, 0).second)
+            {
+                links.emplace_back(a, b);
+            }
+        }
+
+        std::vector<std::pair<float, float>> moves(nodeCount);
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            moves[i] = { graph.x[i] + random.NextFloat() - 0.5f, graph.y[i] + random.NextFloat() - 0.5f };
+        }
+
+        Map map;
+        auto begin = Clock::now();
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            map.AddNode(graph.x[i], graph.y[i]);
+        }
+
+        const double addNodeMs = ElapsedMs(begin);
+        size_t created = 0;
+        begin = Clock::now();
+        for (auto& it : links)
+        {
+            created += map.MakeLink(it.first, it.second) != Map::npos ? 1 : 0;
+        }
+
+        const double makeLinkMs = ElapsedMs(begin);
+        begin = Clock::now();
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            map.SetPosition(i, moves[i].first, moves[i].second);
+        }
+
+        const double setPositionMs = ElapsedMs(begin);
+        begin = Clock::now();
+        map.UpdateLength();
+        const double updateLengthMs = ElapsedMs(begin);
+        records->push_back(Record{ "map_build", graph.name, "map", {
+            { "nodes", static_cast<double>(nodeCount) },
+            { "links", static_cast<double>(created) },
+            { "add_node_ms", addNodeMs },
+            { "add_node_ns", addNodeMs * 1e6 / std::max<size_t>(nodeCount, 1) },
+            { "make_link_ms", makeLinkMs },
+            { "make_link_ns", makeLinkMs * 1e6 / std::max<size_t>(links.size(), 1) },
+            { "set_position_ms", setPositionMs },
+            { "set_position_ns", setPositionMs * 1e6 / std::max<size_t>(nodeCount, 1) },
+            { "update_length_ms", updateLengthMs },
+        } });
+
+        GenericPathFinder finder;
+        finder.ReserveNode(nodeCount);
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            finder.AllocNodeId();
+        }
+
+        created = 0;
+        begin = Clock::now();
+        for (auto& it : links)
+        {
+            created += finder.MakeLink(it.second + 1, it.first + 1) != nullptr ? 1 : 0;
+            created += finder.MakeLink(it.first + 1, it.second + 1) != nullptr ? 1 : 0;
+        }
+
+        const double genericMakeLinkMs = ElapsedMs(begin);
+        size_t duplicates = 0;
+        begin = Clock::now();
+        for (auto& it : links)
+        {
+            duplicates += finder.MakeLink(it.second + 1, it.first + 1) == nullptr ? 1 : 0;
+        }
+
+        const double duplicateMs = ElapsedMs(begin);
+        records->push_back(Record{ "map_build", graph.name, "generic", {
+            { "nodes", static_cast<double>(nodeCount) },
+            { "links", static_cast<double>(created) },
+            { "make_link_ms", genericMakeLinkMs },
+            { "make_link_ns", genericMakeLinkMs * 1e6 / std::max<size_t>(links.size() * 2, 1) },
+            { "duplicates_rejected", static_cast<double>(duplicates) },
+            { "duplicate_ns", duplicateMs * 1e6 / std::max<size_t>(links.size(), 1) },
+        } });
+    }
+
+    // XML 스트리밍/병렬 읽기와 바이너리 지도 열기 시간을 비교한다.
+    void RunLoaders(const BenchGraph& graph, std::vector<Record>* records)
+    {
+        const auto directory = std::filesystem::temp_directory_path();
+        const auto xmlPath = directory / ("astar_bench_" + graph.name + ".xml");
+        const auto binaryPath = directory / ("astar_bench_" + graph.name + ".amap");
+        {
+            std::ofstream file{ xmlPath, std::ios::binary };
+            file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map>\n";
+            char line[128];
+            for (size_t i = 0; i < graph.NodeCount(); ++i)
+            {
+                std::snprintf(line, sizeof(line), "  <node id=\"%zu\" x=\"%.3f\" y=\"%.3f\"/>\n", i + 1, graph.x[i], graph.y[i]);
+                file << line;
+            }
+
+            for (auto& it : graph.edges)
+            {
+                std::snprintf(line, sizeof(line), "  <link from=\"%u\" to=\"%u\"/>\n  <link from=\"%u\" to=\"%u\"/>\n", it.first + 1, it.second + 1, it.second + 1, it.first + 1);
+                file << line;
+            }
+
+            file << "</map>\n";
+        }
+
+        WriteBinaryMap(binaryPath, MakeBinaryMapData(graph));
+        std::error_code error;
+        const double xmlBytes = static_cast<double>(std::filesystem::file_size(xmlPath, error));
+        const double binaryBytes = static_cast<double>(std::filesystem::file_size(binaryPath, error));
+
+        auto record = [&](const char* engine, double ms, double bytes, double nodes)
+        {
+            records->push_back(Record{ "load", graph.name, engine, {
+                { "ms", ms },
+                { "bytes", bytes },
+                { "mb_per_s", ms > 0.0 ? bytes / (1 << 20) / (ms / 1000.0) : 0.0 },
+                { "nodes", nodes },
+            } });
+        };
+
+        {
+            BinaryMapData data;
+            XmlMapCollector collector{ &data };
+            auto begin = Clock::now();
+            XmlMapReader{}.Read(xmlPath, collector);
+            collector.Finish();
+            record("xml_stream", ElapsedMs(begin), xmlBytes, static_cast<double>(data.nodeIds.size()));
+        }
+
+        {
+            ThreadPool pool;
+            BinaryMapData data;
+            XmlMapCollector collector{ &data };
+            auto begin = Clock::now();
+            XmlMapReader{}.Read(xmlPath, collector, pool);
+            collector.Finish();
+            record("xml_parallel", ElapsedMs(begin), xmlBytes, static_cast<double>(data.nodeIds.size()));
+        }
+
+        for (const bool verify : { true, false })
+        {
+            BinaryMapView view;
+            auto begin = Clock::now();
+            const bool opened = view.Open(binaryPath, verify) == BinaryMapError::None;
+            record(verify ? "binary_open_verified" : "binary_open", ElapsedMs(begin), binaryBytes, opened ? static_cast<double>(graph.NodeCount()) : 0.0);
+        }
+
+        std::filesystem::remove(xmlPath, error);
+        std::filesystem::remove(binaryPath, error);
+    }
+
+    // 클릭 판정에 쓰는 최근접 검색을 공간 색인과 전체 순회로 비교한다.
+    void RunSpatial(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        SpatialGrid<uint32_t> index;
+        auto begin = Clock::now();
+        for (uint32_t i = 0; i < graph.NodeCount(); ++i)
+        {
+            index.Insert(i, graph.x[i], graph.y[i]);
+        }
+
+        const double buildMs = ElapsedMs(begin);
+        float maxX = 0.f;
+        float maxY = 0.f;
+        for (size_t i = 0; i < graph.NodeCount(); ++i)
+        {
+            maxX = std::max(maxX, graph.x[i]);
+            maxY = std::max(maxY, graph.y[i]);
+        }
+
+        BenchRandom random{ options.seed * 31 + 5 };
+        std::vector<std::pair<float, float>> points(options.queryCount);
+        for (auto& it : points)
+        {
+            it = { random.NextFloat() * maxX, random.NextFloat() * maxY };
+        }
+
+        auto measure = [&](const char* engine, double prepareMs, auto&& find)
+        {
+            uint64_t checksum = 0;
+            begin = Clock::now();
+            for (auto& it : points)
+            {
+                checksum += find(it.first, it.second);
+            }
+
+            const double ms = ElapsedMs(begin);
+            const double count = static_cast<double>(std::max<size_t>(points.size(), 1));
+            records->push_back(Record{ "spatial", graph.name, engine, {
+                { "prepare_ms", prepareMs },
+                { "mean_us", ms * 1000.0 / count },
+                { "qps", ms > 0.0 ? count * 1000.0 / ms : 0.0 },
+                { "checksum", static_cast<double>(checksum) },
+            } });
+        };
+
+        measure("nearest_grid", buildMs, [&](float x, float y)
+            {
+                return static_cast<uint64_t>(index.FindNearest(x, y));
+            });
+
+        measure("nearest_linear", 0.0, [&](float x, float y)
+            {
+                uint32_t nearest = 0;
+                float nearestDistance = std::numeric_limits<float>::infinity();
+                for (uint32_t i = 0; i < graph.NodeCount(); ++i)
+                {
+                    const float dx = graph.x[i] - x;
+                    const float dy = graph.y[i] - y;
+                    const float distance = dx * dx + dy * dy;
+                    if (distance < nearestDistance || (distance == nearestDistance && i > nearest))
+                    {
+                        nearest = i;
+                        nearestDistance = distance;
+                    }
+                }
+
+                return static_cast<uint64_t>(nearest);
+            });
+    }
+
+    // NodeId -> 인덱스 표를 NodeIdMap과 std::unordered_map으로 비교한다.
+    // sequential은 벤치마크 그래프처럼 1부터 이어지는 NodeId이고, sparse는 XML 지도처럼 띄엄띄엄한 NodeId이다.
+    // 조회 4번에 1번은 없는 키를 찾는다.
+    void RunHash(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        constexpr size_t lookupCount = 1 << 20;
+        const size_t nodeCount = graph.NodeCount();
+        BenchRandom random{ options.seed * 131 + 7 };
+        for (const bool sparse : { false, true })
+        {
+            std::vector<uint64_t> keys(nodeCount);
+            std::vector<uint64_t> missKeys(nodeCount);
+            for (size_t i = 0; i < nodeCount; ++i)
+            {
+                keys[i] = sparse ? (static_cast<uint64_t>(random.NextIndex(1u << 30)) << 20 | i) : i + 1;
+                missKeys[i] = sparse ? (static_cast<uint64_t>(random.NextIndex(1u << 30)) << 20 | (i + nodeCount)) : nodeCount + i + 1;
+            }
+
+            std::vector<uint64_t> lookups(lookupCount);
+            for (size_t i = 0; i < lookupCount; ++i)
+            {
+                const uint32_t index = random.NextIndex(static_cast<uint32_t>(nodeCount));
+                lookups[i] = i % 4 == 3 ? missKeys[index] : keys[index];
+            }
+
+            auto measure = [&](std::string engine, auto& table, auto&& insert, auto&& find)
+            {
+                auto begin = Clock::now();
+                for (size_t i = 0; i < nodeCount; ++i)
+                {
+                    insert(table, keys[i], static_cast<uint32_t>(i));
+                }
+
+                const double buildMs = ElapsedMs(begin);
+                uint64_t checksum = 0;
+                begin = Clock::now();
+                for (auto key : lookups)
+                {
+                    checksum += find(table, key);
+                }
+
+                const double ms = ElapsedMs(begin);
+                return Record{ "hash", graph.name, std::move(engine), {
+                    { "keys", static_cast<double>(nodeCount) },
+                    { "build_ms", buildMs },
+                    { "lookup_ns", ms * 1e6 / lookupCount },
+                    { "lookups_per_s", ms > 0.0 ? lookupCount * 1000.0 / ms : 0.0 },
+                    { "checksum", static_cast<double>(checksum) },
+                } };
+            };
+
+            const std::string suffix = sparse ? "_sparse" : "";
+            NodeIdMap<uint32_t, uint64_t> nodeIdMap;
+            nodeIdMap.reserve(nodeCount);
+            Record record = measure("node_id_map" + suffix, nodeIdMap, [](auto& table, uint64_t key, uint32_t value) { table.insert(key, value); }, [](const auto& table, uint64_t key) -> uint64_t
+                {
+                    auto it = table.find(key);
+                    return it != table.end() ? it->value : 0;
+                });
+            record.metrics.emplace_back("load_factor", nodeIdMap.load_factor());
+            record.metrics.emplace_back("probe_mean", nodeIdMap.average_probe_length());
+            record.metrics.emplace_back("probe_max", static_cast<double>(nodeIdMap.max_probe_length()));
+            records->push_back(std::move(record));
+
+            std::unordered_map<uint64_t, uint32_t> unorderedMap;
+            unorderedMap.reserve(nodeCount);
+            record = measure("unordered_map" + suffix, unorderedMap, [](auto& table, uint64_t key, uint32_t value) { table.emplace(key, value); }, [](const auto& table, uint64_t key) -> uint64_t
+                {
+                    auto it = table.find(key);
+                    return it != table.end() ? it->second : 0;
+                });
+            record.metrics.emplace_back("load_factor", unorderedMap.load_factor());
+            records->push_back(std::move(record));
+        }
+    }
+
+    // PathQueryContext를 데운 뒤에는 질의 중에 힙 할당이 없어야 한다. 엔진마다 질의 전체에서 할당 횟수를 센다.
+    // 결과 벡터도 노드 수만큼 미리 잡아 두므로 0이 아니면 컨텍스트나 엔진이 질의마다 할당하는 것이다.
+    void RunAllocations(const Options& options, const BenchGraph& graph, std::vector<Record>* records)
+    {
+        const auto queries = MakeQueries(graph, options.queryCount, options.seed * 7919 + 17);
+        const size_t nodeCount = graph.NodeCount();
+        std::vector<uint32_t> path;
+        std::vector<size_t> nodeIds;
+        path.reserve(nodeCount);
+        nodeIds.reserve(nodeCount);
+        auto measure = [&](const char* engine, auto&& query)
+        {
+            const size_t warmupCount = std::min<size_t>(queries.size(), 32);
+            for (size_t i = 0; i < warmupCount; ++i)
+            {
+                query(queries[i].first, queries[i].second);
+            }
+
+            uint32_t found = 0;
+            const uint64_t before = allocationCount.load(std::memory_order_relaxed);
+            for (auto& it : queries)
+            {
+                found += query(it.first, it.second) ? 1 : 0;
+            }
+
+            const uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - before;
+            records->push_back(Record{ "alloc", graph.name, engine, {
+                { "queries", static_cast<double>(queries.size()) },
+                { "found", static_cast<double>(found) },
+                { "allocations", static_cast<double>(allocations) },
+            } });
+        };
+
+        if (Selected(options.engines, "map"))
+        {
+            Map map;
+            map.Reserve(nodeCount, graph.edges.size());
+            for (size_t i = 0; i < nodeCount; ++i)
+            {
+                map.AddNode(graph.x[i], graph.y[i]);
+            }
+
+            for (auto& it : graph.edges)
+            {
+                map.MakeLink(it.first, it.second);
+            }
+
+            PathQueryContext<> context;
+            context.Reserve(nodeCount);
+            measure("map", [&](uint32_t from, uint32_t to)
+                {
+                    return map.Navigate(from, to, &path, context);
+                });
+        }
+
+        const BinaryMapData data = MakeBinaryMapData(graph);
+        if (Selected(options.engines, "generic") || Selected(options.engines, "generic_bidirectional") || Selected(options.engines, "contraction_hierarchy"))
+        {
+            TGenericPathFinder<LinkCost, EuclideanH> finder{ LinkCost{ &graph }, EuclideanH{ &graph } };
+            finder.LoadGraph(data.nodeIds.size(), data.nodeIds.data(), data.linkOffsets.data(), data.linkTargets.data());
+            PathQueryContext<> context;
+            context.Reserve(nodeCount);
+            if (Selected(options.engines, "generic"))
+            {
+                measure("generic", [&](uint32_t from, uint32_t to)
+                    {
+                        return finder.Navigate(from + 1, to + 1, &nodeIds, context);
+                    });
+            }
+
+            if (Selected(options.engines, "generic_bidirectional"))
+            {
+                measure("generic_bidirectional", [&](uint32_t from, uint32_t to)
+                    {
+                        return finder.Navigate(from + 1, to + 1, &nodeIds, context, SearchMode::Bidirectional);
+                    });
+            }
+
+            if (Selected(options.engines, "contraction_hierarchy"))
+            {
+                finder.BuildContractionHierarchy();
+                measure("contraction_hierarchy", [&](uint32_t from, uint32_t to)
+                    {
+                        return finder.NavigateHierarchy(from + 1, to + 1, &nodeIds, context);
+                    });
+            }
+        }
+
+        if (Selected(options.engines, "binary_map_view"))
+        {
+            const auto filePath = std::filesystem::temp_directory_path() / ("astar_bench_alloc_" + graph.name + ".amap");
+            {
+                BinaryMapView view;
+                if (WriteBinaryMap(filePath, data) == BinaryMapError::None && view.Open(filePath) == BinaryMapError::None)
+                {
+                    PathQueryContext<> context;
+                    context.Reserve(nodeCount);
+                    measure("binary_map_view", [&](uint32_t from, uint32_t to)
+                        {
+                            return view.Navigate(from + 1, to + 1, &nodeIds, context);
+                        });
+                }
+            }
+
+            std::error_code error;
+            std::filesystem::remove(filePath, error);
+        }
+
+        if (graph.grid != nullptr && Selected(options.engines, "jps"))
+        {
+            JumpPointSearch search{ *graph.grid };
+            PathQueryContext<> context;
+            context.Reserve(nodeCount);
+            std::vector<GridMap::NodeId> cells;
+            cells.reserve(nodeCount);
+            measure("jps", [&](uint32_t from, uint32_t to)
+                {
+                    return search.Navigate(from + 1, to + 1, &cells, context);
+                });
+        }
+    }
+
+    void PrintRecords(const std::vector<Record>& records)
+    {
+        for (auto& record : records)
+        {
+            std::printf("%-8s %-8s %-24s", record.suite.c_str(), record.graph.c_str(), record.engine.c_str());
+            for (auto& it : record.metrics)
+            {
+                std::printf(" %s=%.6g", it.first.c_str(), it.second);
+            }
+
+            std::printf("\n");
+        }
+    }
+
+    void WriteJsonString(std::ofstream& file, const std::string& text)
+    {
+        file << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                file << '\\';
+            }
+
+            file << c;
+        }
+
+        file << '"';
+    }
+
+    bool WriteJson(const Options& options, const std::vector<Record>& records)
+    {
+        std::ofstream file{ options.outputPath, std::ios::binary };
+        if (!file)
+            return false;
+
+        char number[64];
+        file << "{\n  \"schema\": 1,\n  \"seed\": " << options.seed << ",\n  \"queries\": " << options.queryCount;
+        std::snprintf(number, sizeof(number), "%.6g", options.scale);
+        file << ",\n  \"scale\": " << number << ",\n  \"compiler\": ";
+#if defined(__VERSION__)
+        WriteJsonString(file, __VERSION__);
+#else
+        WriteJsonString(file, "unknown");
+#endif
+        file << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            auto& record = records[i];
+            file << "    { \"suite\": ";
+            WriteJsonString(file, record.suite);
+            file << ", \"graph\": ";
+            WriteJsonString(file, record.graph);
+            file << ", \"engine\": ";
+            WriteJsonString(file, record.engine);
+            for (auto& it : record.metrics)
+            {
+                std::snprintf(number, sizeof(number), "%.9g", std::isfinite(it.second) ? it.second : 0.0);
+                file << ", ";
+                WriteJsonString(file, it.first);
+                file << ": " << number;
+            }
+
+            file << (i + 1 < records.size() ? " },\n" : " }\n");
+        }
+
+        file << "  ]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+    void PrintUsage()
+    {
+        std::printf(
+            "usage: astar_bench [options]\n"
+            "  --seed N          graph and query seed (default 1)\n"
+            "  --queries N       queries per engine (default 1000)\n"
+            "  --scale F         graph size multiplier (default 1)\n"
+            "  --quick           same as --scale 0.1 --queries 200\n"
+            "  --graphs a,b      random,grid,road\n"
+            "  --engines a,b     map,map_radix,generic,generic_traced,generic_anytime,generic_task,generic_async,\n"
+            "                    generic_bidirectional,generic_bidirectional_radix,generic_alt,contraction_hierarchy,\n"
+            "                    hpa,hpa_exact,binary_map_view,jps,jps_plus\n"
+            "  --suites a,b      query,batch,simd,map_build,load,spatial,hash,alloc\n"
+            "  --out PATH        JSON result file (default bench_results.json)\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, Options* options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (std::strcmp(arg, "--quick") == 0)
+            {
+                options->scale = 0.1f;
+                options->queryCount = 200;
+                continue;
+            }
+
+            if (std::strcmp(arg, "--help") == 0 || value == nullptr)
+                return false;
+
+            if (std::strcmp(arg, "--seed") == 0)
+                options->seed = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(arg, "--queries") == 0)
+                options->queryCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (std::strcmp(arg, "--scale") == 0)
+                options->scale = std::strtof(value, nullptr);
+            else if (std::strcmp(arg, "--graphs") == 0)
+                options->graphs = SplitList(value);
+            else if (std::strcmp(arg, "--engines") == 0)
+                options->engines = SplitList(value);
+            else if (std::strcmp(arg, "--suites") == 0)
+                options->suites = SplitList(value);
+            else if (std::strcmp(arg, "--out") == 0)
+                options->outputPath = value;
+            else
+                return false;
+
+            i += 1;
+        }
+
+        return options->scale > 0.f;
+    }
+}
+
+// 배열과 nothrow 판은 표준 구현이 이 함수를 부르므로 따로 바꾸지 않는다.
+// GCC는 인라인된 delete의 free를 new와 짝이 안 맞는다고 경고하지만 여기서는 new도 malloc을 쓴다.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const float side = std::sqrt(options.scale);
+    std::vector<std::function<BenchGraph()>> generators;
+    if (Selected(options.graphs, "random"))
+    {
+        generators.push_back([&]() { return MakeRandomGraph(std::max(16u, static_cast<uint32_t>(50000 * options.scale)), 4, options.seed); });
+    }
+
+    if (Selected(options.graphs, "grid"))
+    {
+        generators.push_back([&]() { return MakeGridGraph(std::max(8u, static_cast<uint32_t>(256 * side)), options.seed + 1); });
+    }
+
+    if (Selected(options.graphs, "road"))
+    {
+        generators.push_back([&]() { return MakeRoadGraph(std::max(8u, static_cast<uint32_t>(224 * side)), options.seed + 2); });
+    }
+
+    std::vector<Record> records;
+    for (auto& generator : generators)
+    {
+        const auto begin = Clock::now();
+        const BenchGraph graph = generator();
+        std::printf("graph %s: %zu nodes, %zu links, %zu reachable, generated in %.1f ms\n",
+            graph.name.c_str(), graph.NodeCount(), graph.edges.size(), graph.queryNodes.size(), ElapsedMs(begin));
+
+        const size_t first = records.size();
+        if (Selected(options.suites, "query"))
+        {
+            RunQueryEngines(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "batch"))
+        {
+            RunBatch(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "simd"))
+        {
+            RunSimd(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "map_build"))
+        {
+            RunMapBuild(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "load"))
+        {
+            RunLoaders(graph, &records);
+        }
+
+        if (Selected(options.suites, "spatial"))
+        {
+            RunSpatial(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "hash"))
+        {
+            RunHash(options, graph, &records);
+        }
+
+        if (Selected(options.suites, "alloc"))
+        {
+            RunAllocations(options, graph, &records);
+        }
+
+        PrintRecords({ records.begin() + first, records.end() });
+    }
+
+    if (!WriteJson(options, records))
+    {
+        std::fprintf(stderr, "cannot write %s\n", options.outputPath.c_str());
+        return 1;
+    }
+
+    std::printf("wrote %zu results to %s\n", records.size(), options.outputPath.c_str());
+    // 데운 뒤에도 할당한 엔진이 있으면 실패로 끝낸다.
+    bool allocated = false;
+    for (auto& record : records)
+    {
+        if (record.suite != "alloc")
+            continue;
+
+        for (auto& it : record.metrics)
+        {
+            if (it.first == "allocations" && it.second != 0.0)
+            {
+                std::fprintf(stderr, "%s %s: %.0f allocations after warm-up\n", record.graph.c_str(), record.engine.c_str(), it.second);
+                allocated = true;
+            }
+        }
+    }
+
+    return allocated ? 1 : 0;
+}